@@ -3,7 +3,9 @@
 // eclang
 #include "vectors.hpp"
 // std
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 namespace eclang {
@@ -46,6 +48,12 @@ namespace eclang {
             VEC3D,  // -> (vec3d) // a vector of three double
             VEC4D   // -> (vec4d) // a vector of four doubles
         };
+
+        /**
+            Returns the size in bytes of a value of the type specified.
+            Strings don't have a fixed size so 0 is returned for STRING and STR_MD
+        */
+        size_t sizeOf(Type type);
     }
 
     /**
@@ -54,7 +62,8 @@ namespace eclang {
         type and, optionally, the value.
 
         This class is used in the Class and Object classes.
-        In "Class" it's used to define a language, so only the name and type are used.
+        In "Class" it's used to define a language: the name and type are used and, if
+        it has one, the value is the default value of the attribute (see Class::getDefault()).
         In "Object" it's used to describe the data in a file, so the value is also used
     */
     class Attribute {
@@ -93,14 +102,25 @@ namespace eclang {
         Attribute(std::string name, vec4d value);
 
         /**
-            Destructor. The way data is stored is sussy so we do
-            need a destructor
+            Copy constructor. Strings are allocated so they have to be copied
+        */
+        Attribute(const Attribute& other);
+        Attribute& operator=(const Attribute& other);
+        /**
+            Move constructor. Takes the string (if any) from the other attribute
+        */
+        Attribute(Attribute&& other) noexcept;
+        Attribute& operator=(Attribute&& other) noexcept;
+
+        /**
+            Destructor. Numbers and vectors are stored inside the Attribute, only
+            strings are allocated and have to be deleted
         */
         ~Attribute();
 
         // Get Name
         // --------
-        std::string getName();
+        const std::string& getName();
 
         // Get Type
         // --------
@@ -108,6 +128,16 @@ namespace eclang {
 
         // Get Value
         // ---------
+        /**
+            Returns a pointer to the value stored in this attribute or nullptr if
+            there is no value. For strings this points to an std::string.
+        */
+        const void* getRawValue();
+        /**
+            Returns true if the other attribute has the same type and value. Numbers
+            and vectors are compared byte by byte
+        */
+        bool hasSameValue(Attribute& other);
         // Int
         int8_t getInt8();
         int16_t getInt16();
@@ -143,7 +173,30 @@ namespace eclang {
         type::Type type;
 
         // Value
-        const void* bytesValue = nullptr; // IMPORTANT: DELETE!
-        uint8_t sizeofValue = 0; // if this is more than 0, delete bytesValue in destructor
+        // Numbers and vectors are copied into `value` (the biggest type is vec4d, 32 bytes)
+        // so that creating and deleting attributes doesn't allocate anything.
+        // Strings are allocated and stored in `stringValue`
+        alignas(8) uint8_t value[sizeof(vec4d)] = {};
+        bool hasValue = false;
+        std::string* stringValue = nullptr; // IMPORTANT: DELETE!
+
+        /**
+            Copies a number or vector into `value`
+        */
+        template<class T>
+        void storeValue(const T& v) {
+            static_assert(sizeof(T) <= sizeof(value), "Value doesn't fit in an Attribute");
+            std::memcpy(value, &v, sizeof(T));
+            hasValue = true;
+        }
+        /**
+            Reads a number or vector from `value`
+        */
+        template<class T>
+        T readValue() {
+            T v;
+            std::memcpy(&v, value, sizeof(T));
+            return v;
+        }
     };
 }
\ No newline at end of file
@@ -5,9 +5,25 @@
 
 // std
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
+
 namespace eclang {
+    /**
+        The attributes of a Class with their default values, shared with the Objects
+        of the class (see Class::_getDefaults()). They never move or change: registering
+        classes or languages moves the Class but not them, and registering an attribute
+        with a default value gives the Class new ones.
+    */
+    struct ClassDefaults {
+        // Names of the attributes, in the order of their IDs
+        std::vector<std::string> names;
+        // The attributes. The ones with a default value have it
+        std::vector<Attribute> attributes;
+    };
+
     /**
         A class in EcLang.
         Classes in EcLang are structures with a specific name
@@ -30,7 +46,9 @@ namespace eclang {
         Class(std::string name, std::vector<Attribute> attributes);
         
         /**
-            Takes an Attribute object and registers it into the Class
+            Takes an Attribute object and registers it into the Class.
+            If the attribute has a value, it's the default value of the attribute
+            (for example `registerAttribute(Attribute("scale", 1.0f))`, see getDefault())
         */
         void registerAttribute(Attribute attribute);
         /**
@@ -42,11 +60,11 @@ namespace eclang {
         /**
             Returns the name of the Class
         */
-        std::string getName();
+        const std::string& getName();
         /**
             Returns the names of all registered attributes
         */
-        std::vector<std::string> getAttributes();
+        const std::vector<std::string>& getAttributes();
         /**
             Returns true if the ID corresponds to a registered attribute.
         */
@@ -54,33 +72,60 @@ namespace eclang {
         /**
             Returns true if the attribute name corresponds to a registered attribute
         */
-        bool attributeExists(std::string attribute);
+        bool attributeExists(std::string_view attribute);
         /**
             Takes the ID of an attribute as its input and returns
             the name of the attribute
         */
-        std::string getAttributeName(uint32_t id);
+        const std::string& getAttributeName(uint32_t id);
         /**
             Takes the name of an attribute as its input and returns
             the ID of the attribute
         */
-        uint32_t getAttributeID(std::string attribute);
+        uint32_t getAttributeID(std::string_view attribute);
         /**
             Takes the name of an attribute as its input and returns
             the data type of the attribute
         */
-        type::Type getAttributeType(std::string attribute);
+        type::Type getAttributeType(std::string_view attribute);
         /**
             Takes the ID of an attribute as its input and returns
             the data type of the attribute
         */
         type::Type getAttributeType(uint32_t id);
+        /**
+            Takes the ID of an attribute as its input and returns its default
+            value, or nullptr if it was registered without a value.
+            Objects that don't set the attribute read the default value and
+            values equal to it are neither stored in Objects nor compiled
+        */
+        Attribute* getDefault(uint32_t id);
+        /**
+            Returns true if any attribute of the Class has a default value
+        */
+        bool hasDefaults();
+        /**
+            Returns the default values of the Class (see ClassDefaults), or nullptr
+            if it doesn't have any. Objects keep them to read the attributes they don't set.
+            Do not call this manually.
+        */
+        std::shared_ptr<ClassDefaults> _getDefaults();
 
     private:
+        /**
+            Replaces the default values shared with Objects with the current ones
+        */
+        void updateDefaults();
+
+
         // Class name
         std::string name;
         // List of attributes
         std::vector<Attribute> attributes;
         std::vector<std::string> attributesStr;
+        // Number of attributes with a default value
+        size_t defaultCount = 0;
+        // Default values shared with Objects, nullptr if there aren't any
+        std::shared_ptr<ClassDefaults> defaults;
     };
 }
\ No newline at end of file
@@ -6,10 +6,126 @@
 // std
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace eclang {
+    class StringTable;
+    class MappedDocument;
+    namespace format { struct Layout; struct Encoding; struct Header; struct NodeEntry; struct NodeCounts; class StreamReader; }
+
+    /**
+        How the values of an attribute are stored with less precision (see
+        CompileOptions::quantize). Every component of the value becomes:
+        - HALF:    A half float (2 bytes, about 3 significant digits)
+        - FIXED8:  An integer of 8 bits mapping [min, max] to 256 steps
+        - FIXED16: An integer of 16 bits mapping [min, max] to 65536 steps
+        Values outside [min, max] are clamped. Quantized values are lossy: reading
+        them gives the nearest value that can be stored.
+    */
+    struct Quantization {
+        enum Format : uint8_t { HALF, FIXED8, FIXED16 };
+
+        Format format = HALF;
+        float min = 0;
+        float max = 1;
+    };
+
+    /**
+        Options that change how files are compiled (see EcLang::setCompileOptions()).
+        Files compiled with any of these options can only be read by versions
+        of EcLang that support them.
+    */
+    struct CompileOptions {
+        // Store every string (object names, custom classes and attributes and
+        // string values) once in a table and refer to it by index. Makes files
+        // with repeated strings smaller and strings faster to read
+        bool stringTable = false;
+        // Store integers (and the components of integer vectors) as variable-length
+        // integers: small values take 1 or 2 bytes instead of their full size
+        bool varint = false;
+        // Compress the file with EcLang's LZ compression: 0 doesn't compress it, 1 is
+        // the fastest level and 9 the smallest. Blocks are (de)compressed in parallel
+        int compressionLevel = 0;
+        // Write the size of every scope after its SCOPE_ENTER so that readers can
+        // skip whole subtrees without reading them
+        bool sizedScopes = true;
+        // Add a hash table of the paths of all the nodes so that MappedDocument::getObject()
+        // finds a node reading only a few parts of the file
+        bool pathIndex = false;
+        // Store numbers and vectors at positions of the file that are multiples of their
+        // alignment (16 bytes for vec4f, 32 for vec4d...) and in little endian, so that
+        // MappedNode::getReferenceOf() can return references into the mapped file
+        bool alignedValues = false;
+        // Write the attributes of every object as a bitmap of the attributes of its class
+        // that are set followed by their values, instead of an instruction and an ID per
+        // attribute. Makes files with many small attributes smaller and faster to read
+        bool attributeBitmaps = false;
+        // Store the numbers and vectors of every object as the difference with the same
+        // attribute of its previous sibling of the same class (the XOR of their bits for
+        // floats). Files with runs of similar siblings get much smaller with varint or
+        // compression. MappedNode reads the previous siblings to get a value
+        bool deltaValues = false;
+        // Add a table per class with the values of every attribute of its objects stored
+        // one after the other (see MappedDocument::getTable()). Makes reading one attribute
+        // of all the objects of a class fast. The instructions are still written
+        bool columns = false;
+        // Write the children of an object once when an object before it has exactly the same
+        // children (same classes, names, attributes and children): the later ones refer to them.
+        // Makes files with repeated hierarchies smaller and faster to load (copied, not read again)
+        bool deduplicate = false;
+        // Attributes stored with less precision (class name -> attribute name -> how).
+        // Only FLOAT, DOUBLE and their vectors can be quantized (see Quantization)
+        std::unordered_map<std::string, std::unordered_map<std::string, Quantization>> quantize;
+    };
+
+    /**
+        Options that limit what is loaded from a compiled file (see the EcLang
+        constructor that takes them). Everything that is filtered out is skipped
+        without being allocated. Source files are always loaded entirely.
+    */
+    struct LoadOptions {
+        // Classes of the objects loaded. Objects of any other class are skipped
+        // with all their children, so the classes of the objects that contain
+        // the ones you need must be listed too. Empty loads every class
+        std::vector<std::string> classes;
+        // Attributes loaded for every class listed here (class name -> attribute
+        // names). Objects of classes that aren't listed keep all their attributes
+        std::unordered_map<std::string, std::vector<std::string>> attributes;
+    };
+
+    /**
+        Function that reads up to `size` bytes of a file into `buffer` and returns
+        the number of bytes read. Returns 0 when the file ends (see the EcLang
+        constructor that takes one)
+    */
+    using ByteSource = std::function<size_t(uint8_t* buffer, size_t size)>;
+
+    /**
+        Destination of the values of one attribute during a bulk export
+        (see EcLang::exportAttributes()).
+
+        The value of the attribute for the object number `i` is written
+        to `buffer + i * stride`. A stride of 0 means that the values are
+        tightly packed (the stride is the size of the attribute's type).
+        Objects that don't have the attribute set get its default value (see
+        Class::getDefault()) or, if it doesn't have one, leave their slot untouched.
+
+        After the export, bit `i` of `presence` (`presence[i / 8] >> (i % 8)`)
+        is set if a value was written for the object number `i`.
+    */
+    struct AttributeExport {
+        std::string attribute; // Name of the attribute
+        void* buffer = nullptr; // Provided by the caller. Must be big enough for all the objects
+        size_t stride = 0; // Bytes between two consecutive values
+        std::vector<uint8_t> presence; // Presence bitmap, filled by the export
+    };
+
     /**
         A single EcLang file. It contains a compiled file. If a source
         file is passed to the constructor, it will get automatically compiled.
@@ -36,10 +152,58 @@ namespace eclang {
             file export if no name is specified
         */
         EcLang(std::string name, void* data, size_t size, uint8_t fileID = 0);
+        /**
+            Constructs an EcLang object reading a source or compiled file from a stream.
+            Compiled files are decoded as they're read, so they don't need to be in
+            memory (see the constructor that takes a ByteSource).
+            The name is used during file export.
+        */
+        EcLang(std::string name, std::istream& stream, LoadOptions options = {});
+        /**
+            Constructs an EcLang object reading a source or compiled file from a
+            ByteSource (a pipe, a socket, a file descriptor...). The data is requested
+            in chunks and compiled files are decoded as they arrive: only the chunk being
+            read is kept in memory (and the string table if the file has one).
+            Source files and compressed files are read entirely first.
+            The name is used during file export.
+        */
+        EcLang(std::string name, ByteSource source, LoadOptions options = {});
+        /**
+            Constructs an EcLang object from the path to a compiled file, loading
+            only the classes and attributes allowed by the options (see LoadOptions).
+            The options are also applied to the files it includes dynamically.
+        */
+        EcLang(std::string filepath, LoadOptions options);
+        /**
+            Loads only the node at the path specified (node1/node2/node3) of a
+            compiled file and all of its children. The nodes that contain it are
+            created without attributes so that the node keeps its path.
+
+            Nothing else in the file is read, so loading a node costs the same
+            no matter how big the file is. The file must be a version 2 compiled
+            file with sized scopes (the default).
+
+            Throws a runtime error if the node doesn't exist.
+        */
+        static EcLang loadSubtree(std::string filepath, std::string_view path);
         /**
             Guess what it does
         */
         ~EcLang();
+
+        // Objects belong to one EcLang object: it can be moved but not copied
+        EcLang(const EcLang&) = delete;
+        EcLang& operator=(const EcLang&) = delete;
+        /**
+            Takes the Objects, strings and prototypes of another EcLang object,
+            which is left without any Objects
+        */
+        EcLang(EcLang&& other) noexcept;
+        /**
+            Deletes the Objects of this EcLang object (see setBackgroundRelease())
+            and takes the ones of another, which is left without any Objects
+        */
+        EcLang& operator=(EcLang&& other) noexcept;
         
         /**
             Saves the compiled/decompiled file.
@@ -78,20 +242,77 @@ namespace eclang {
             Returns the Object objects from the current file as a vector.
             The Objects allow us to access all the data with a simple interface
         */
-        std::vector<Object*> getAllObjects();
+        const std::vector<Object*>& getAllObjects();
         /**
             Returns the Object objects with the class name specified
             from the current file as a vector.
         */
-        std::vector<Object*> getObjectsByClass(std::string className);
+        std::vector<Object*> getObjectsByClass(std::string_view className);
         /**
             Returns the Object object with the name specified.
             A specific object in the hierarchy can be specified with paths (node1/node2/node3).
             The pointer returned may be nullptr.
         */
-        Object* getObject(std::string name);
+        Object* getObject(std::string_view name);
+
+        /**
+            Returns the number of objects with the class name specified in the
+            whole hierarchy (not only the root). This is the number of values
+            written per attribute by exportAttributes().
+        */
+        size_t countObjectsByClass(std::string_view className);
+        /**
+            Writes the values of the attributes specified for every object with the
+            class name specified into the buffers provided by the caller.
+            Objects are visited in the same order they appear in the file (depth first)
+            and the whole hierarchy is exported, not only the root.
+
+            Only attributes with a fixed size (numbers and vectors) registered in the
+            Language for this class can be exported. An exception is thrown otherwise.
+
+            Returns the number of objects exported.
+        */
+        size_t exportAttributes(std::string_view className, std::vector<AttributeExport>& exports);
+
+        /**
+            When enabled, destroying this EcLang object doesn't delete its Objects in
+            the calling thread. They're handed to a background thread that deletes them,
+            so unloading a big file doesn't stall the thread that unloads it.
+            Disabled by default.
+        */
+        void setBackgroundRelease(bool enabled);
+        /**
+            Blocks until all the Objects of the EcLang objects destroyed with
+            background release enabled are deleted.
+        */
+        static void waitForBackgroundRelease();
+
+        /**
+            Sets the options used by saveToFileCompiled() (and saveToFile() for
+            source files) from now on.
+        */
+        void setCompileOptions(CompileOptions options);
 
     private:
+        /**
+            Constructs an EcLang object from the path to the file, storing the
+            names of its objects in the string table specified and loading what the
+            LoadOptions allow.
+            Used for included files, so that they share the table of the file
+            that includes them.
+        */
+        EcLang(std::string filepath, uint8_t fileID, std::shared_ptr<StringTable> strings, LoadOptions loadOptions = {});
+        /**
+            Constructs an EcLang object with the node at the path specified of a
+            mapped file, its subtree and empty copies of its ancestors (see loadSubtree()).
+            The name is used during file export.
+        */
+        EcLang(const MappedDocument& document, std::string_view path, std::string name);
+        /**
+            Deletes the Objects of this EcLang object (in a background thread if
+            background release is enabled), unless another EcLang included them
+        */
+        void releaseObjects();
         /**
             For both constructors, a void* of data and a size are obtained
             and passed to this function. This function figures out the type of
@@ -101,14 +322,66 @@ namespace eclang {
             Throws a runtime error if the language can't be determined.
         */
         void initializeEcLang(void* dataRaw, size_t size);
+        /**
+            Same as initializeEcLang() but for files read from a stream. Compiled files
+            are decoded as they're read (see constructFromStream()). Source files are
+            read entirely and parsed.
+
+            Throws a runtime error if the language can't be determined.
+        */
+        void initializeEcLang(format::StreamReader& reader);
         /**
             Constructs all the Object objects by parsing a source file.
         */
-        void constructFromSource(std::string source);
+        void constructFromSource(const std::string& sourceCode);
         /**
             Constructs all the Object objects by reading a binary file.
+            Both legacy files (only instructions) and version 2 files (see util/binaryFormat.hpp)
+            can be read.
+        */
+        void constructFromBinary(const uint8_t* binary, size_t size);
+        /**
+            Constructs all the Object objects by reading a compiled file from a stream.
+            The reader must be at the start of the file. Only what's needed to decode the
+            instructions is kept in memory: the string table (if the file has one) and
+            the chunk of instructions being read.
+
+            Instructions are decoded as they arrive if the file doesn't have a string table
+            or if the table comes before them. Otherwise the DATA section is kept until the
+            table arrives. Compressed files are read entirely and decompressed.
+        */
+        void constructFromStream(format::StreamReader& reader);
+        /**
+            Throws a runtime error if the file wasn't compiled with the version of the
+            language we have
+        */
+        void checkFingerprint(const format::Header& header);
+        /**
+            Reads the number of children of every node from the node table and, if
+            the LoadOptions filter classes, the size of their subtrees.
+            Throws a runtime error if a parent is not in the table.
+        */
+        void readNodeTable(const std::vector<format::NodeEntry>& nodes, format::NodeCounts& counts);
+        /**
+            Runs the instructions between `begin` and `end` of a buffer.
+
+            Returns the number of objects read (created or filtered out), which can't be
+            more than `maxObjects` (see decodeInstructions()).
+        */
+        size_t decodeBuffer(const uint8_t* data, size_t begin, size_t end, format::NodeCounts& counts, const format::Encoding& encoding, size_t maxObjects = SIZE_MAX);
+        /**
+            Runs the instructions left in the reader (see util/byteReader.hpp), creating the Object objects.
+            The NodeCounts may contain the number of children of every object to allocate
+            their lists once, and the number of nodes in the subtree of every object, so
+            that the subtrees filtered out by the LoadOptions can be jumped over without reading them.
+
+            Returns the number of objects read (created or filtered out). CLONE instructions can't
+            read more than `maxObjects` (or the number of objects of the NodeCounts, if they have it),
+            so a corrupted file can't make them copy the same objects over and over. `cloneDepth`
+            is the number of CLONE instructions whose children are being read again.
         */
-        void constructFromBinary(std::vector<uint8_t> compiled);
+        template<class Reader>
+        size_t decodeInstructions(Reader& reader, const format::NodeCounts& counts, const format::Encoding& encoding, size_t maxObjects = SIZE_MAX, uint32_t cloneDepth = 0);
 
         /**
             returns a vector of uint8_t containing the compiled file.
@@ -144,37 +417,36 @@ namespace eclang {
         // COMPILATION / DECOMPILATION HELPER FUNCTIONS
 
         /**
-            Takes a pointer to an instance of Object and returns its compiled code.
-            This function is recursive and will produce the compiled code for setting
-            the attributes, setting the template tag and creating children objects
+            Takes an array of Objects and appends their compiled code to the binary.
+            The whole tree is walked (without recursion) and this function will produce the
+            compiled code for setting the attributes, setting the template tag and creating children objects.
+            If a Layout is specified, the node, include and string tables of the compiled file are
+            written into it (offsets start where the code starts).
         */
-        std::vector<uint8_t> compileObjects(std::vector<Object*> objects);
+        void compileObjects(std::vector<uint8_t>& binary, const std::vector<Object*>& objects, format::Layout* layout = nullptr);
         /**
-            Takes a pointer to an instance of Object and returns the CREATE instruction
-            for it.
+            Takes a pointer to an instance of Object and appends the CREATE instruction
+            for it. The strings are written as the flags of the Layout specify (if any).
         */
-        std::vector<uint8_t> compileObjectCreation(Object* object);
-
+        void compileObjectCreation(std::vector<uint8_t>& binary, Object* object, format::Layout* layout);
+        /**
+            Takes a pointer to an instance of Object and appends the ATTRIBUTE instructions
+            for all of its attributes (or only the ones in `names`, in that order).
+            The strings are written as the flags of the Layout specify (if any).
+        */
+        void compileObjectAttributes(std::vector<uint8_t>& binary, Object* object, format::Layout* layout, const std::vector<std::string>* names = nullptr);
         /**
-            Takes a pointer to an instance of Object and returns its decompiled code.
-            This function is recursive and will produce the decompiled code for setting
-            the attributes, setting the template tag and creating children objects
+            Takes a pointer to an instance of Object of a registered class and adds a row
+            with the values of its attributes to the table of its class in the Layout.
         */
-        std::string decompileObjects(std::vector<Object*> objects, uint8_t tabs = 0);
+        void compileObjectColumns(Object* object, uint32_t nodeIndex, uint32_t parentIndex, format::Layout* layout);
 
         /**
-            Converts a number to an array of bytes
+            Takes an array of Objects and returns their decompiled code.
+            The whole tree is walked (without recursion) and this function will produce the
+            decompiled code for setting the attributes, setting the template tag and creating children objects
         */
-        std::vector<uint8_t> numberToBytes(int8_t number);
-        std::vector<uint8_t> numberToBytes(int16_t number);
-        std::vector<uint8_t> numberToBytes(int32_t number);
-        std::vector<uint8_t> numberToBytes(int64_t number);
-        std::vector<uint8_t> numberToBytes(uint8_t number);
-        std::vector<uint8_t> numberToBytes(uint16_t number);
-        std::vector<uint8_t> numberToBytes(uint32_t number);
-        std::vector<uint8_t> numberToBytes(uint64_t number);
-        std::vector<uint8_t> numberToBytes(float number);
-        std::vector<uint8_t> numberToBytes(double number);
+        std::string decompileObjects(const std::vector<Object*>& objects, uint8_t tabs = 0);
 
         // Names of files relevant to this file
         // When a file is included or used as template dynamically,
@@ -199,9 +471,6 @@ namespace eclang {
         // Source code for the current file.
         // This value can be obtained from the user or from decompilation
         std::string source;
-        // Compiled code for the current file.
-        // This value can be obtained from the user or from compilation
-        std::vector<uint8_t> compiled;
 
         // All the objects obtained from parsing/reading source/binary file that
         // are in the root (and not inside another node (object))
@@ -212,10 +481,20 @@ namespace eclang {
         // When we exit scope, we remove the last object in this array.
         // WE DO NOT DELETE ANYTHING IN THIS ARRAY. THESE ARE REFERENCES
         std::vector<Object*> scope;
+        // Class and object names of all the objects in this file and the files
+        // it includes. Objects point to the strings in this table, so it's
+        // shared with the included EcLang objects
+        std::shared_ptr<StringTable> strings;
         // Has a (possible) parent EcLang obtained this object's Objects?
         // If this is the case, even if this EcLang instance is deleted we
         // don't want to delete our Objects
         bool isIncluded = false;
+        // Should the destructor delete our Objects in a background thread?
+        bool backgroundRelease = false;
+        // Options used when compiling
+        CompileOptions compileOptions;
+        // What is loaded from compiled files (and the files they include)
+        LoadOptions loadOptions;
 
         // Inclusion / Templating
         // ----------------------
@@ -228,6 +507,13 @@ namespace eclang {
         // Empty if no template was included
         std::vector<Object*> externalTemplateNode;
 
+        // Instances
+        // ---------
+
+        // Prototype of every object declared with #instance, so that compiled
+        // files only store what the instances change
+        std::unordered_map<Object*, Object*> prototypes;
+
         // The current file. When a file is dynamically included,
         // the current file index goes up and the name is registered
         // into the array. This value is copied into every loaded object.
@@ -236,6 +522,6 @@ namespace eclang {
         // will be done statically. This is because we only care about compiling the current
         // file; dynamically included files are compiled into an "include" instruction so we
         // shouldn't need to care about files that may change.
-        const uint8_t currentFile;
+        uint8_t currentFile;
     };
 }
\ No newline at end of file
@@ -7,9 +7,11 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-#define ECLANG_KEYWORD_COUNT 5
+#define ECLANG_KEYWORD_COUNT 6
 
 namespace eclang {
     /**
@@ -44,25 +46,25 @@ namespace eclang {
             Returns the name of the language. The name is used to select
             the language when creating an EcLang object
         */
-        std::string getName();
+        const std::string& getName();
         /**
             Returns the file extension of source files (uncompiled code) for this language.
         */
-        std::string getExtensionSource();
+        const std::string& getExtensionSource();
         /**
             Returns the file extension of compiled files for this language
         */
-        std::string getExtensionCompiled();
+        const std::string& getExtensionCompiled();
         /**
             Returns the first bytes of compiled files that use this language.
             They are used to identify the language of a compiled EcLang file.
         */
-        std::vector<uint8_t> getIdentifierBytes();
+        const std::vector<uint8_t>& getIdentifierBytes();
 
         /**
             Returns a list of keywords. This is constant and used for all languages
         */
-        static const std::array<std::string, ECLANG_KEYWORD_COUNT> getKeywords() { return keywords; }
+        static const std::array<std::string, ECLANG_KEYWORD_COUNT>& getKeywords() { return keywords; }
 
         // Register Classes
         // ----------------
@@ -70,13 +72,24 @@ namespace eclang {
             Registers a class into the language.
         */
         void registerClass(Class c);
+        /**
+            Constructs a class in place (with the same arguments as the Class
+            constructors) and registers it into the language.
+            Returns a reference to the registered class
+        */
+        template<class... Args>
+        Class& emplaceClass(Args&&... args) {
+            Class& c = classes.emplace_back(std::forward<Args>(args)...);
+            classesStr.push_back(c.getName());
+            return c;
+        }
 
         // Classes
         // -------
         /**
             Returns a list of all registered classes in the language
         */
-        std::vector<std::string> getClasses();
+        const std::vector<std::string>& getClasses();
         /**
             Returns true if a class with the ID specified exists
         */
@@ -84,47 +97,51 @@ namespace eclang {
         /**
             Returns true if a class with the name specified exists
         */
-        bool classExists(std::string name);
+        bool classExists(std::string_view name);
         /**
             Returns the class name from its ID
         */
-        std::string getClassName(uint32_t id);
+        const std::string& getClassName(uint32_t id);
         /**
             Returns the ID of the class from its name
         */
-        uint32_t getClassID(std::string name);
+        uint32_t getClassID(std::string_view name);
+        /**
+            Returns the class with the ID specified
+        */
+        Class& getClass(uint32_t id);
 
         // Attributes from classes
         // -----------------------
         /**
             Takes the ID of the Class and returns all attributes
         */
-        std::vector<std::string> getAttributes(uint32_t classID);
+        const std::vector<std::string>& getAttributes(uint32_t classID);
         /**
             Takes the name of the Class and returns all attributes
         */
-        std::vector<std::string> getAttributes(std::string className);
+        const std::vector<std::string>& getAttributes(std::string_view className);
         /**
             Takes the ID of the class and the ID of an attribute
             and returns the name of the attribute
         */
-        std::string getAttributeName(uint32_t classID, uint32_t attributeID);
+        const std::string& getAttributeName(uint32_t classID, uint32_t attributeID);
         /**
             Takes the name of the class and the ID of an attribute
             and returns the name of the attribute
         */
-        std::string getAttributeName(std::string className, uint32_t attributeID);
+        const std::string& getAttributeName(std::string_view className, uint32_t attributeID);
 
         /**
             Takes the ID of the class and the name of an attribute
             and returns the ID of the attribute
         */
-        uint32_t getAttributeID(uint32_t classID, std::string attributeName);
+        uint32_t getAttributeID(uint32_t classID, std::string_view attributeName);
         /**
             Takes the name of the class and the name of an attribute
             and returns the ID of the attribute
         */
-        uint32_t getAttributeID(std::string className, std::string attributeName);
+        uint32_t getAttributeID(std::string_view className, std::string_view attributeName);
 
         /**
             Takes the ID of the class and the ID of an attribute
@@ -135,17 +152,36 @@ namespace eclang {
             Takes the ID of the class and the name of an attribute
             and returns the data type of the attribute
         */
-        type::Type getAttributeType(uint32_t classID, std::string attributeName);
+        type::Type getAttributeType(uint32_t classID, std::string_view attributeName);
         /**
             Takes the name of the class and the ID of an attribute
             and returns the data type of the attribute
         */
-        type::Type getAttributeType(std::string className, uint32_t attributeID);
+        type::Type getAttributeType(std::string_view className, uint32_t attributeID);
         /**
             Takes the name of the class and the name of an attribute
             and returns the data type of the attribute
         */
-        type::Type getAttributeType(std::string className, std::string attributeName);
+        type::Type getAttributeType(std::string_view className, std::string_view attributeName);
+
+        /**
+            Takes the ID of the class and the ID of an attribute and returns the
+            default value of the attribute (nullptr if it doesn't have one, see Class::getDefault())
+        */
+        Attribute* getAttributeDefault(uint32_t classID, uint32_t attributeID);
+        /**
+            Takes the name of the class and the name of an attribute and returns the
+            default value of the attribute (nullptr if it doesn't have one, see Class::getDefault())
+        */
+        Attribute* getAttributeDefault(std::string_view className, std::string_view attributeName);
+
+        /**
+            Returns a hash of the classes, attributes, types and default values of the
+            language in the order they were registered (which determines their IDs).
+            Compiled files store it so that files compiled with a different version
+            of the language are detected when loading them.
+        */
+        uint64_t getFingerprint();
 
     private:
         // Language name
@@ -173,7 +209,8 @@ namespace eclang {
             "#include-dyn",
             "#template",
             "#template-dyn",
-            "#register"
+            "#register",
+            "#instance"
         };
     };
 }
\ No newline at end of file
@@ -0,0 +1,424 @@
+#pragma once
+
+// eclang
+#include "classes/attribute.hpp"
+#include "language.hpp"
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace eclang {
+    class MappedDocument;
+    namespace format { struct QuantizedAttribute; }
+
+    /**
+        A node of a MappedDocument.
+
+        It works like an Object but everything is read from the mapped file
+        when it's requested: the names and string values returned point to
+        the file and are valid while the MappedDocument exists.
+
+        MappedNodes are small values (a pointer and an index) that can be copied freely.
+    */
+    class MappedNode {
+    public:
+        /**
+            Returns the name of the node
+        */
+        std::string_view getName() const;
+        /**
+            Returns the name of the class of the node
+        */
+        std::string_view getClassName() const;
+
+        /**
+            Returns the node that contains this one (nothing for nodes in the root)
+        */
+        std::optional<MappedNode> getParent() const;
+        /**
+            Returns the number of children of this node
+        */
+        size_t getObjectCount() const;
+        /**
+            Returns all children of this node.
+            The vector may be empty
+        */
+        std::vector<MappedNode> getObjects() const;
+        /**
+            Returns the node with the name specified (or the path to it,
+            relative to this node) if it exists
+        */
+        std::optional<MappedNode> getObject(std::string_view name) const;
+
+        /**
+            Returns the names of all the attributes set in this node
+        */
+        std::vector<std::string_view> getAttributes() const;
+        /**
+            Returns true if the attribute is set in this node
+        */
+        bool hasAttribute(std::string_view attribute) const;
+        /**
+            Returns the data type of the attribute.
+            Throws a runtime error if the attribute is not set and doesn't have a default value
+        */
+        type::Type getTypeOf(std::string_view attribute) const;
+        /**
+            Returns the value of a String or Markdown String attribute (its default value
+            if it's not set). Throws a runtime error if the attribute is not set and doesn't
+            have a default value or is not a string
+        */
+        std::string_view getStringOf(std::string_view attribute) const;
+        /**
+            Returns the value of a number or vector attribute (for example
+            `node.getValueOf<vec3f>("position")`) or its default value if it's not set.
+            Throws a runtime error if the attribute is not set and doesn't have a default
+            value or the size of the type requested is not the size of the attribute
+        */
+        template<class T>
+        T getValueOf(std::string_view attribute) const {
+            T result;
+            _readValue(attribute, &result, sizeof(T));
+            return result;
+        }
+        /**
+            Returns a reference to the value of a number or vector attribute in the
+            mapped file (for example `node.getReferenceOf<vec4f>("color")`), valid while
+            the MappedDocument exists. The value is aligned to its size (up to 32 bytes)
+            so it can be loaded with aligned SIMD instructions.
+            Throws a runtime error if the file wasn't compiled with aligned values
+            (CompileOptions::alignedValues) or was compiled with delta values, the attribute is
+            not set, it's an integer stored as varints or quantized or the size of the type
+            requested is not the size of the attribute
+        */
+        template<class T>
+        const T& getReferenceOf(std::string_view attribute) const {
+            return *reinterpret_cast<const T*>(_referValue(attribute, sizeof(T)));
+        }
+
+        /**
+            Copies the value of a number or vector attribute to `value`, which has
+            `size` bytes. Attributes that aren't set read their default value. Throws a runtime
+            error if the attribute is not set and doesn't have one or `size` is not the size of
+            the attribute. In files compiled with delta values
+            (CompileOptions::deltaValues) the previous siblings of the node are read too.
+            Quantized attributes (CompileOptions::quantize) are converted back to their type
+        */
+        void _readValue(std::string_view attribute, void* value, size_t size) const;
+        /**
+            Like _readValue() but copies the value as it's stored: the difference with the
+            previous sibling in files compiled with delta values. Returns false if the
+            attribute is not set
+        */
+        bool _readStoredValue(std::string_view attribute, void* value, size_t size) const;
+        /**
+            Returns a pointer to the value of a number or vector attribute of `size` bytes
+            in the file. Throws a runtime error if it can't be read in place (see getReferenceOf())
+        */
+        const uint8_t* _referValue(std::string_view attribute, size_t size) const;
+        /**
+            Returns a pointer to the value of the attribute in the file and sets
+            its type. Returns nullptr if the attribute is not set.
+            Strings point to their first character (use getStringOf() to get their length),
+            integers stored as varints and quantized values to their first byte (use getValueOf()).
+        */
+        const uint8_t* _findValue(std::string_view attribute, type::Type& attributeType) const;
+        /**
+            Returns the default value of the attribute in the class of this node (see
+            Class::getDefault()) or nullptr if it doesn't have one
+        */
+        Attribute* _findDefault(std::string_view attribute) const;
+        /**
+            Returns the position of this node in the node table of the file
+        */
+        uint32_t _getIndex() const;
+        /**
+            Returns the position of the CREATE instruction of this node in the file
+        */
+        uint64_t _getPosition() const;
+        /**
+            Returns the number of nodes in the subtree of this node (this one included)
+        */
+        uint32_t _getSubtreeSize() const;
+        /**
+            Returns the position in the file of the end of the instructions of this node
+            and all of its subtree (after its SCOPE_EXIT). Throws a runtime error if the
+            file wasn't compiled with sized scopes and the node has a scope
+        */
+        uint64_t _getEnd() const;
+
+    private:
+        friend class MappedDocument;
+        MappedNode(const MappedDocument* document, uint32_t index);
+
+        /**
+            Calls `visit(attributeName, type, value, text)` for every attribute of this node
+            until it returns true. `text` is the value of strings (empty for other types).
+            Custom attributes are reported as STRING. The attributes of instances (INSTANCES)
+            are visited first, followed by the ones they get from their prototypes
+        */
+        template<class Visit>
+        void forEachAttribute(Visit visit) const;
+
+        const MappedDocument* document;
+        uint32_t index;
+    };
+
+    /**
+        A column of a MappedTable: the values of an attribute of every object of
+        the class, one row per object.
+
+        Values are read in place from the mapped file and are valid while the
+        MappedDocument exists. Rows of objects that don't set the attribute hold
+        zeros (or empty strings).
+    */
+    class MappedColumn {
+    public:
+        /**
+            Returns the name of the attribute
+        */
+        std::string_view getName() const;
+        /**
+            Returns the data type of the attribute
+        */
+        type::Type getType() const;
+        /**
+            Returns the number of rows of the column
+        */
+        size_t getRowCount() const;
+        /**
+            Returns true if the object of the row sets the attribute.
+            Throws a runtime error if the row doesn't exist
+        */
+        bool isSet(size_t row) const;
+        /**
+            Returns the bits that tell which rows set the attribute (one bit per row,
+            the lowest bit of the first byte is the first row)
+        */
+        const uint8_t* getValidity() const;
+        /**
+            Returns the values of a number or vector column, one per row (for example
+            `column.getValues<vec3f>()`). They are aligned to their size (up to 32 bytes).
+            Throws a runtime error if the column holds strings or the size of the type
+            requested is not the size of the attribute
+        */
+        template<class T>
+        const T* getValues() const {
+            return reinterpret_cast<const T*>(_getValues(sizeof(T)));
+        }
+        /**
+            Returns the value of a String or Markdown String column at the row specified.
+            Throws a runtime error if the column doesn't hold strings or the row doesn't exist
+        */
+        std::string_view getString(size_t row) const;
+
+        /**
+            Returns a pointer to the values of a number or vector column with values of
+            `size` bytes. Throws a runtime error if they can't be read (see getValues())
+        */
+        const uint8_t* _getValues(size_t size) const;
+
+    private:
+        friend class MappedDocument;
+        MappedColumn(std::string_view name, type::Type type, size_t rowCount, const uint8_t* validity, const uint8_t* values, uint64_t valuesSize);
+
+        std::string_view name;
+        type::Type type;
+        size_t rowCount;
+        const uint8_t* validity;
+        const uint8_t* values;
+        uint64_t valuesSize;
+    };
+
+    /**
+        The table of a class of a MappedDocument: one row per object of the class
+        (in the order of the node table) and one MappedColumn per attribute of the
+        class set in any of them. Only files compiled with CompileOptions::columns
+        have tables.
+    */
+    class MappedTable {
+    public:
+        /**
+            Returns the name of the class
+        */
+        std::string_view getClassName() const;
+        /**
+            Returns the number of rows (objects of the class)
+        */
+        size_t getRowCount() const;
+        /**
+            Returns the index in the node table of the object of every row
+            (see MappedDocument::getNode())
+        */
+        const uint32_t* getNodes() const;
+        /**
+            Returns the index in the node table of the parent of the object of every
+            row (0xFFFFFFFF for objects in the root)
+        */
+        const uint32_t* getParents() const;
+        /**
+            Returns the node of the object at the row specified.
+            Throws a runtime error if the row doesn't exist
+        */
+        MappedNode getNode(size_t row) const;
+        /**
+            Returns the column of the attribute specified if any object of the class sets it
+        */
+        std::optional<MappedColumn> getColumn(std::string_view attribute) const;
+        /**
+            Returns all the columns of the table
+        */
+        const std::vector<MappedColumn>& getColumns() const;
+
+    private:
+        friend class MappedDocument;
+        MappedTable(const MappedDocument* document, std::string_view className, size_t rowCount, const uint8_t* nodes, const uint8_t* parents);
+
+        const MappedDocument* document;
+        std::string_view className;
+        size_t rowCount;
+        const uint8_t* nodes;
+        const uint8_t* parents;
+        std::vector<MappedColumn> columns;
+    };
+
+    /**
+        A compiled file mapped into memory.
+
+        Nothing is decoded when the file is opened: only the header and the
+        section table are read. Nodes are read from the mapped file when they're
+        requested (see MappedNode), so opening a file costs the same no matter
+        how big it is.
+
+        Only version 2 compiled files can be mapped. Compressed files are
+        decompressed into memory when they're opened. Included files and
+        templates are not loaded; load the file with EcLang to resolve them.
+    */
+    class MappedDocument {
+    public:
+        /**
+            Maps the compiled file. The file path may be an alias.
+            Throws a runtime error if the file can't be mapped, it's not a version 2
+            compiled file or its language isn't registered.
+        */
+        MappedDocument(std::string filepath);
+        /**
+            Unmaps the file
+        */
+        ~MappedDocument();
+
+        MappedDocument(const MappedDocument&) = delete;
+        MappedDocument& operator=(const MappedDocument&) = delete;
+
+        /**
+            Returns the number of nodes in the file (all levels)
+        */
+        size_t getNodeCount() const;
+        /**
+            Returns the nodes in the root of the file
+        */
+        std::vector<MappedNode> getAllObjects() const;
+        /**
+            Returns the node with the name (or path: node1/node2/node3) specified
+            if it exists. Files compiled with a path index (CompileOptions::pathIndex)
+            find it with a hash table lookup instead of reading every node on the way
+        */
+        std::optional<MappedNode> getObject(std::string_view name) const;
+        /**
+            Returns the node at the position specified of the node table (nodes are
+            stored depth first, in the same order they appear in the source file)
+        */
+        MappedNode getNode(uint32_t index) const;
+        /**
+            Returns the table of the class specified if the file has one (see MappedTable).
+            Throws a runtime error if the COLUMNS section is corrupted or this machine is big endian
+        */
+        std::optional<MappedTable> getTable(std::string_view className) const;
+        /**
+            Returns the language of the file
+        */
+        Language* getLanguage() const;
+
+        /**
+            Returns the flags of the file (see util/binaryFormat.hpp)
+        */
+        uint16_t _getFlags() const;
+        /**
+            Returns the strings of the string table of the file (empty if the
+            file doesn't have a string table)
+        */
+        const std::vector<std::string_view>& _getStrings() const;
+        /**
+            Returns the attributes stored with less precision (empty if the file
+            wasn't compiled with quantized attributes)
+        */
+        const std::vector<format::QuantizedAttribute>& _getQuantized() const;
+        /**
+            Returns the contents of the file (mapped or read into memory). The instructions
+            are between the positions _getCodeBegin() and _getCodeEnd()
+        */
+        const uint8_t* _getData() const;
+        size_t _getCodeBegin() const;
+        size_t _getCodeEnd() const;
+
+    private:
+        friend class MappedNode;
+
+        // Unmaps the file if it's mapped (and not read into `buffer`)
+        void unmap();
+
+        // Node table entry `index`
+        uint64_t nodeOffset(uint32_t index) const;
+        uint32_t nodeSubtreeSize(uint32_t index) const;
+        uint32_t nodeParent(uint32_t index) const;
+        /**
+            Returns the node with the name specified among the nodes in [first, end)
+            that are siblings (each one after the subtree of the previous one)
+        */
+        std::optional<MappedNode> findSibling(uint32_t first, uint32_t end, std::string_view name) const;
+        /**
+            Returns the node with the path specified using the PATHS section
+        */
+        std::optional<MappedNode> findPath(std::string_view path) const;
+        /**
+            Returns true if the path of the node is the one specified
+        */
+        bool hasPath(uint32_t index, std::string_view path) const;
+        /**
+            Returns how the attribute of the class is quantized or nullptr if it isn't
+        */
+        const format::QuantizedAttribute* findQuantized(std::string_view className, std::string_view attribute) const;
+
+        // Mapped file
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        // Used when memory mapping is not available or the file is compressed
+        std::vector<uint8_t> buffer;
+
+        Language* language = nullptr;
+        // Node table
+        const uint8_t* nodes = nullptr;
+        uint32_t nodeCount = 0;
+        // DATA section (instructions)
+        size_t codeBegin = 0;
+        size_t codeEnd = 0;
+        // Slots of the PATHS section (nullptr if the file doesn't have one)
+        const uint8_t* paths = nullptr;
+        uint32_t pathSlotCount = 0;
+        // COLUMNS section (size 0 if the file doesn't have one)
+        uint64_t columnsOffset = 0;
+        uint64_t columnsSize = 0;
+        // Strings of the STRINGS section (if the file was compiled with a string table)
+        std::vector<std::string_view> strings;
+        // Attributes of the QUANTIZATION section
+        std::vector<format::QuantizedAttribute> quantized;
+        // Options used to compile the file (see util/binaryFormat.hpp)
+        uint16_t flags = 0;
+    };
+}
@@ -3,11 +3,16 @@
 // eclang
 #include "classes/attribute.hpp"
 // std
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace eclang {
+    struct ClassDefaults;
+
     /**
         A name, class type and array of Attributes.
 
@@ -36,10 +41,6 @@ namespace eclang {
     // a tree.
     class Object {
     public:
-        /**
-            Constructs the Object object with the class name and the object's name
-        */
-        Object(std::string className, std::string name, uint8_t sourceFileID);
         /**
             Delete all the registered Attributes
         */
@@ -47,9 +48,16 @@ namespace eclang {
 
         /**
             Adds an attribute. This attribute must contain data.
+            Attributes equal to the default value of their class are deleted instead.
             Do not call this manually.
         */
         void _addAttribute(Attribute* a);
+        /**
+            Adds an array of attributes (see _addAttribute()), allocating the space
+            for all of them at once.
+            Do not call this manually.
+        */
+        void _addAttributes(const std::vector<Attribute*>& a);
         /**
             Adds an Object object as a child of this object.
             Do not call this manually.
@@ -59,18 +67,65 @@ namespace eclang {
             Adds an array of Objects as children of this object.
             Do not call this manually.
         */
-        void _addChildren(std::vector<Object*> o);
+        void _addChildren(const std::vector<Object*>& o);
+        /**
+            Allocates space for the number of children specified.
+            Do not call this manually.
+        */
+        void _reserveChildren(size_t count);
+        /**
+            Returns a copy of this object, its attributes and all of its children
+            (copied too). The copies point to the same interned strings and belong
+            to the file specified (see getSourceFileID()).
+            Do not call this manually.
+        */
+        Object* _copy(uint8_t sourceFileID);
+        /**
+            Makes this object an instance of the prototype (an object of the same class):
+            it gets copies of the attributes of the prototype it doesn't set and of its
+            children (after its own). The attributes keep the order of the prototype,
+            followed by the ones the prototype doesn't have.
+            Do not call this manually.
+        */
+        void _instantiate(Object* prototype);
+        /**
+            Moves the attributes of `overrides` into this object. They replace the ones
+            with the same name, or remove them if they're equal to their default value.
+            Do not call this manually.
+        */
+        void _override(Object& overrides);
+        /**
+            Returns a reference to the children of this object.
+            Used internally to walk the tree without copying vectors.
+        */
+        const std::vector<Object*>& _getChildren();
+        /**
+            Returns a reference to the attributes of this object.
+            Used internally to read values without copying vectors.
+        */
+        const std::vector<Attribute*>& _getAttributes();
+        /**
+            Returns the interned name of this object. Objects from the same
+            EcLang with the same name return the same pointer.
+        */
+        const std::string* _getNameHandle();
+        /**
+            Returns the interned class name of this object. Objects from the same
+            EcLang with the same class return the same pointer.
+        */
+        const std::string* _getClassHandle();
 
         /**
             Returns the name of the object
         */
-        std::string getName();
+        const std::string& getName();
         /**
             Returns the name of the class.
         */
-        std::string getClassName();
+        const std::string& getClassName();
         /**
-            Returns the names of all registered attributes
+            Returns the names of all the attributes set in this object (attributes
+            that have the default value of their class aren't included)
         */
         std::vector<std::string> getAttributes();
 
@@ -78,23 +133,32 @@ namespace eclang {
             Returns all children of this object.
             The vector may be empty
         */
-        std::vector<Object*> getObjects();
+        const std::vector<Object*>& getObjects();
         /**
             Returns the Object objects with the class name specified
             from the current file as a vector.
         */
-        std::vector<Object*> getObjectsByClass(std::string className);
+        std::vector<Object*> getObjectsByClass(std::string_view className);
         /**
             Returns the Object object with the name specified.
             The pointer returned may be nullptr.
         */
-        Object* getObject(std::string name);
+        Object* getObject(std::string_view name);
 
         /**
             Returns the ID of the attribute.
-            This ID is required to use the other methods
+            This ID is required to use the other methods.
+            Attributes that aren't set but have a default value in the class of
+            the object also have an ID, which reads the default value.
+
+            Attributes set have the IDs 0, 1, 2... in the order they were set.
+            Default values have the ID UINT8_MAX-1 minus the ID of the attribute
+            in the class (254, 253, 252...), so their ID doesn't change when other
+            attributes are set and reads the value set if the attribute is set later.
+            A default value whose ID would be the ID of an attribute set doesn't
+            have an ID (-1 is returned).
         */
-        uint8_t getIDOf(std::string attribute);
+        uint8_t getIDOf(std::string_view attribute);
 
         /**
             Returns the data type of this attribute.
@@ -148,16 +212,40 @@ namespace eclang {
         vec3d getVec3dOf(uint8_t attribute);
         vec4d getVec4dOf(uint8_t attribute);
     private:
+        // Objects are only created by the EcLang object that owns them
+        friend class EcLang;
+
+        /**
+            Constructs the Object object with the class name and the object's name.
+            The strings are not copied: they're handles of the string table of the
+            EcLang object that creates this object (see StringTable::intern()) and
+            must outlive it.
+            `defaults` are the default values of the registered class of the object
+            (see Class::_getDefaults()), nullptr if it doesn't have any.
+        */
+        Object(const std::string* className, const std::string* name, uint8_t sourceFileID, std::shared_ptr<ClassDefaults> defaults = nullptr);
         /**
             Throws an error if the number of attributes is too big
         */
         void checkAttributesNumber();
+        /**
+            Returns the attribute with the ID specified (see getIDOf()): a set attribute
+            or a default value of the class. Throws an out of range error if there isn't one
+        */
+        Attribute* attributeAt(uint8_t attribute);
+        /**
+            Returns the default value of the attribute in the class of the object and sets
+            `classAttributeID` to the ID of the attribute in the class. Returns nullptr
+            if the attribute doesn't have a default value
+        */
+        Attribute* defaultOf(std::string_view attribute, uint32_t& classAttributeID);
 
 
-        std::string name; // This object's name
-        std::string className; // The class' name
+        const std::string* name; // This object's name (interned, see StringTable)
+        const std::string* className; // The class' name (interned, see StringTable)
         std::vector<Attribute*> attributes; // List of attributes (with data)
         std::vector<Object*> children; // List of other objects
+        std::shared_ptr<ClassDefaults> defaults; // Default values of the class, nullptr if it doesn't have any
 
         
         // ID of the file that loaded this object. Each ID corresponds to a file
@@ -13,4 +13,5 @@
     By A31Nesta
 */
 
-#include "classes/eclangClass.hpp"
\ No newline at end of file
+#include "classes/eclangClass.hpp"
+#include "classes/mappedDocument.hpp"
\ No newline at end of file
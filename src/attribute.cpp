@@ -1,10 +1,46 @@
 #include "classes/attribute.hpp"
 #include "classes/vectors.hpp"
+#include <cstddef>
 #include <cstdint>
-#include <iostream>
+#include <cstring>
 #include <string>
+#include <utility>
 
 namespace eclang {
+    /**
+        Returns the size in bytes of a value of the type specified.
+        Strings don't have a fixed size so 0 is returned for STRING and STR_MD
+    */
+    size_t type::sizeOf(Type type) {
+        switch (type) {
+        case INT8:   return sizeof(int8_t);
+        case INT16:  return sizeof(int16_t);
+        case INT32:  return sizeof(int32_t);
+        case INT64:  return sizeof(int64_t);
+        case UINT8:  return sizeof(uint8_t);
+        case UINT16: return sizeof(uint16_t);
+        case UINT32: return sizeof(uint32_t);
+        case UINT64: return sizeof(uint64_t);
+        case FLOAT:  return sizeof(float);
+        case DOUBLE: return sizeof(double);
+        case STRING:
+        case STR_MD: return 0;
+        case VEC2I:  return sizeof(vec2i);
+        case VEC3I:  return sizeof(vec3i);
+        case VEC4I:  return sizeof(vec4i);
+        case VEC2L:  return sizeof(vec2l);
+        case VEC3L:  return sizeof(vec3l);
+        case VEC4L:  return sizeof(vec4l);
+        case VEC2F:  return sizeof(vec2f);
+        case VEC3F:  return sizeof(vec3f);
+        case VEC4F:  return sizeof(vec4f);
+        case VEC2D:  return sizeof(vec2d);
+        case VEC3D:  return sizeof(vec3d);
+        case VEC4D:  return sizeof(vec4d);
+        }
+        return 0;
+    }
+
     // CONSTRUCTORS
     // ------------
 
@@ -13,7 +49,7 @@ namespace eclang {
         It specifies the name and the type but no value.
     */
     Attribute::Attribute(std::string name, type::Type type) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type;
     }
 
@@ -22,235 +58,170 @@ namespace eclang {
         stored using this constructor.
     */
     Attribute::Attribute(std::string name, int8_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::INT8;
-        bytesValue = new int8_t(value); // copy value
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, int16_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::INT16;
-        bytesValue = new int16_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, int32_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::INT32;
-        bytesValue = new int32_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, int64_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::INT64;
-        bytesValue = new int64_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, uint8_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::UINT8;
-        bytesValue = new uint8_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, uint16_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::UINT16;
-        bytesValue = new uint16_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, uint32_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::UINT32;
-        bytesValue = new uint32_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, uint64_t value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::UINT64;
-        bytesValue = new uint64_t(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, float value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::FLOAT;
-        bytesValue = new float(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, double value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::DOUBLE;
-        bytesValue = new double(value);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, std::string value, type::Type type) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type;
-        bytesValue = new std::string(value);
-        sizeofValue = sizeof(value);
+        stringValue = new std::string(std::move(value));
     }
     Attribute::Attribute(std::string name, vec2i value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC2I;
-        bytesValue = new vec2i(value.x, value.y);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec3i value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC3I;
-        bytesValue = new vec3i(value.x, value.y, value.z);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec4i value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC4I;
-        bytesValue = new vec4i(value.x, value.y, value.z, value.w);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec2l value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC2L;
-        bytesValue = new vec2l(value.x, value.y);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec3l value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC3L;
-        bytesValue = new vec3l(value.x, value.y, value.z);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec4l value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC4L;
-        bytesValue = new vec4l(value.x, value.y, value.z, value.w);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec2f value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC2F;
-        bytesValue = new vec2f(value.x, value.y);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec3f value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC3F;
-        bytesValue = new vec3f(value.x, value.y, value.z);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec4f value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC4F;
-        bytesValue = new vec4f(value.x, value.y, value.z, value.w);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec2d value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC2D;
-        bytesValue = new vec2d(value.x, value.y);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec3d value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC3D;
-        bytesValue = new vec3d(value.x, value.y, value.z);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
     Attribute::Attribute(std::string name, vec4d value) {
-        this->name = name;
+        this->name = std::move(name);
         this->type = type::VEC4D;
-        bytesValue = new vec4d(value.x, value.y, value.z, value.w);
-        sizeofValue = sizeof(value);
+        storeValue(value);
     }
 
     /**
-        Destructor. The way data is stored is sussy so we do
-        need a destructor
+        Copy constructor. Strings are allocated so they have to be copied
     */
-    Attribute::~Attribute() {
-        // If size of value is not 0 we have a value
-        // if we have a value we have to delete it
-        if (sizeofValue != 0) {
-            if (bytesValue == nullptr) {
-                std::cerr << "sizeofValue was 0 but bytesValue was nullptr. I don't know how this is possible but memory may have been leaked.\n";
-                return;
-            }
-            // Delete value
-            switch (type) {
-            case type::INT8:
-                delete (int8_t*)bytesValue;
-                break;
-            case type::INT16:
-                delete (int16_t*)bytesValue;
-                break;
-            case type::INT32:
-                delete (int32_t*)bytesValue;
-                break;
-            case type::INT64:
-                delete (int64_t*)bytesValue;
-                break;
-            case type::UINT8:
-                delete (uint8_t*)bytesValue;
-                break;
-            case type::UINT16:
-                delete (uint16_t*)bytesValue;
-                break;
-            case type::UINT32:
-                delete (uint32_t*)bytesValue;
-                break;
-            case type::UINT64:
-                delete (uint64_t*)bytesValue;
-                break;
-            case type::FLOAT:
-                delete (float*)bytesValue;
-                break;
-            case type::DOUBLE:
-                delete (double*)bytesValue;
-                break;
-            case type::STRING:
-            case type::STR_MD:
-                delete (std::string*)bytesValue;
-                break;
-            case type::VEC2I:
-                delete (vec2i*)bytesValue;
-                break;
-            case type::VEC3I:
-                delete (vec3i*)bytesValue;
-                break;
-            case type::VEC4I:
-                delete (vec4i*)bytesValue;
-                break;
-            case type::VEC2L:
-                delete (vec2l*)bytesValue;
-                break;
-            case type::VEC3L:
-                delete (vec3l*)bytesValue;
-                break;
-            case type::VEC4L:
-                delete (vec4l*)bytesValue;
-                break;
-            case type::VEC2F:
-                delete (vec2f*)bytesValue;
-                break;
-            case type::VEC3F:
-                delete (vec3f*)bytesValue;
-                break;
-            case type::VEC4F:
-                delete (vec4f*)bytesValue;
-                break;
-            case type::VEC2D:
-                delete (vec2d*)bytesValue;
-                break;
-            case type::VEC3D:
-                delete (vec3d*)bytesValue;
-                break;
-            case type::VEC4D:
-                delete (vec4d*)bytesValue;
-                break;
-            }
+    Attribute::Attribute(const Attribute& other) {
+        *this = other;
+    }
+    Attribute& Attribute::operator=(const Attribute& other) {
+        if (this == &other) {
+            return *this;
         }
+        name = other.name;
+        type = other.type;
+        std::memcpy(value, other.value, sizeof(value));
+        hasValue = other.hasValue;
+        delete stringValue;
+        stringValue = (other.stringValue == nullptr) ? nullptr : new std::string(*other.stringValue);
+        return *this;
+    }
+    /**
+        Move constructor. Takes the string (if any) from the other attribute
+    */
+    Attribute::Attribute(Attribute&& other) noexcept {
+        *this = std::move(other);
+    }
+    Attribute& Attribute::operator=(Attribute&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        name = std::move(other.name);
+        type = other.type;
+        std::memcpy(value, other.value, sizeof(value));
+        hasValue = other.hasValue;
+        delete stringValue;
+        stringValue = other.stringValue;
+        other.stringValue = nullptr;
+        return *this;
+    }
+
+    /**
+        Destructor. Numbers and vectors are stored inside the Attribute, only
+        strings are allocated and have to be deleted
+    */
+    Attribute::~Attribute() {
+        delete stringValue;
     }
 
     // Get Name
     // --------
-    std::string Attribute::getName() {
+    const std::string& Attribute::getName() {
         return name;
     }
 
@@ -262,38 +233,61 @@ namespace eclang {
 
     // Get Value
     // ---------
+    /**
+        Returns a pointer to the value stored in this attribute or nullptr if
+        there is no value. For strings this points to an std::string.
+    */
+    const void* Attribute::getRawValue() {
+        if (stringValue != nullptr) {
+            return stringValue;
+        }
+        return hasValue ? value : nullptr;
+    }
+    /**
+        Returns true if the other attribute has the same type and value. Numbers
+        and vectors are compared byte by byte
+    */
+    bool Attribute::hasSameValue(Attribute& other) {
+        if (type != other.type) {
+            return false;
+        }
+        if (stringValue != nullptr || other.stringValue != nullptr) {
+            return stringValue != nullptr && other.stringValue != nullptr && *stringValue == *other.stringValue;
+        }
+        return hasValue == other.hasValue && std::memcmp(value, other.value, type::sizeOf(type)) == 0;
+    }
     // Int
     int8_t Attribute::getInt8() {
-        return *(int8_t*)bytesValue;
+        return readValue<int8_t>();
     }
     int16_t Attribute::getInt16() {
-        return *(int16_t*)bytesValue;
+        return readValue<int16_t>();
     }
     int32_t Attribute::getInt32() {
-        return *(int32_t*)bytesValue;
+        return readValue<int32_t>();
     }
     int64_t Attribute::getInt64() {
-        return *(int64_t*)bytesValue;
+        return readValue<int64_t>();
     }
     // Uint
     uint8_t Attribute::getUint8() {
-        return *(uint8_t*)bytesValue;
+        return readValue<uint8_t>();
     }
     uint16_t Attribute::getUint16() {
-        return *(uint16_t*)bytesValue;
+        return readValue<uint16_t>();
     }
     uint32_t Attribute::getUint32() {
-        return *(uint32_t*)bytesValue;
+        return readValue<uint32_t>();
     }
     uint64_t Attribute::getUint64() {
-        return *(uint64_t*)bytesValue;
+        return readValue<uint64_t>();
     }
     // Decimal
     float Attribute::getFloat() {
-        return *(float*)bytesValue;
+        return readValue<float>();
     }
     double Attribute::getDouble() {
-        return *(double*)bytesValue;
+        return readValue<double>();
     }
     // Strings
     // Used for String and Markdown Strings. The only difference between strings and MD strings is how the program interprets them
@@ -323,7 +317,7 @@ namespace eclang {
         case type::STRING:
         case type::STR_MD:
             // THIS IS THE NORMAL RETURN.
-            return *(std::string*)bytesValue;
+            return *stringValue;
         case type::VEC2I: {
             auto value = getVec2i();
             return "vec2i("+std::to_string(value.x)+", "+std::to_string(value.y)+")";
@@ -375,47 +369,47 @@ namespace eclang {
         }
 
         // shouldn't happen but I was getting a warning
-        return *(std::string*)bytesValue;
+        return *stringValue;
     }
     // Vectors
     // int
     vec2i Attribute::getVec2i() {
-        return *(vec2i*)bytesValue;
+        return readValue<vec2i>();
     }
     vec3i Attribute::getVec3i() {
-        return *(vec3i*)bytesValue;
+        return readValue<vec3i>();
     }
     vec4i Attribute::getVec4i() {
-        return *(vec4i*)bytesValue;
+        return readValue<vec4i>();
     }
     // long
     vec2l Attribute::getVec2l() {
-        return *(vec2l*)bytesValue;
+        return readValue<vec2l>();
     }
     vec3l Attribute::getVec3l() {
-        return *(vec3l*)bytesValue;
+        return readValue<vec3l>();
     }
     vec4l Attribute::getVec4l() {
-        return *(vec4l*)bytesValue;
+        return readValue<vec4l>();
     }
     // float
     vec2f Attribute::getVec2f() {
-        return *(vec2f*)bytesValue;
+        return readValue<vec2f>();
     }
     vec3f Attribute::getVec3f() {
-        return *(vec3f*)bytesValue;
+        return readValue<vec3f>();
     }
     vec4f Attribute::getVec4f() {
-        return *(vec4f*)bytesValue;
+        return readValue<vec4f>();
     }
     // double
     vec2d Attribute::getVec2d() {
-        return *(vec2d*)bytesValue;
+        return readValue<vec2d>();
     }
     vec3d Attribute::getVec3d() {
-        return *(vec3d*)bytesValue;
+        return readValue<vec3d>();
     }
     vec4d Attribute::getVec4d() {
-        return *(vec4d*)bytesValue;
+        return readValue<vec4d>();
     }
 }
\ No newline at end of file
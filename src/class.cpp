@@ -3,45 +3,61 @@
 // std
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace eclang {
     Class::Class(std::string name) {
-        this->name = name;
+        this->name = std::move(name);
     }
     Class::Class(std::string name, std::vector<Attribute> attributes) {
-        this->name = name;
-        this->attributes = attributes;
+        this->name = std::move(name);
+        this->attributes = std::move(attributes);
         // Populate attributesStr array
-        for (Attribute a : attributes) {
+        attributesStr.reserve(this->attributes.size());
+        for (Attribute& a : this->attributes) {
             attributesStr.push_back(a.getName());
+            if (a.getRawValue() != nullptr) {
+                defaultCount++;
+            }
         }
+        updateDefaults();
     }
         
     void Class::registerAttribute(Attribute attribute) {
-        attributes.push_back(attribute);
         attributesStr.push_back(attribute.getName());
+        const bool hasValue = attribute.getRawValue() != nullptr;
+        if (hasValue) {
+            defaultCount++;
+        }
+        attributes.push_back(std::move(attribute));
+        // Attributes without a value don't change the defaults of Objects
+        if (hasValue) {
+            updateDefaults();
+        }
     }
     void Class::registerAttribute(std::string name, type::Type type) {
-        attributes.push_back(Attribute(name, type));
         attributesStr.push_back(name);
+        attributes.emplace_back(std::move(name), type);
     }
 
-    std::string Class::getName() {
+    const std::string& Class::getName() {
         return name;
     }
-    std::vector<std::string> Class::getAttributes() {
+    const std::vector<std::string>& Class::getAttributes() {
         return attributesStr;
     }
     bool Class::attributeExists(uint32_t id) {
         return id < attributesStr.size();
     }
-    bool Class::attributeExists(std::string attribute) {
+    bool Class::attributeExists(std::string_view attribute) {
         return std::find(attributesStr.begin(), attributesStr.end(), attribute) != attributesStr.end();
     }
-    std::string Class::getAttributeName(uint32_t id) {
+    const std::string& Class::getAttributeName(uint32_t id) {
         if (!attributeExists(id)) {
             throw std::runtime_error(
                 "ECLANG_ERROR: Couldn't get attribute name from ID. ID ("+std::to_string(id)+") was greater than "
@@ -50,24 +66,23 @@ namespace eclang {
         }
         return attributesStr.at(id);
     }
-    uint32_t Class::getAttributeID(std::string attribute) {
+    uint32_t Class::getAttributeID(std::string_view attribute) {
         auto iterator = std::find(attributesStr.begin(), attributesStr.end(), attribute);
         // We don't use attributeExists here to avoid using std::find() again
         if (iterator == attributesStr.end()) {
             throw std::runtime_error(
-                "ECLANG_ERROR: Couldn't get attribute ID from name. Attribute with name \""+attribute+"\" is not registered"
+                "ECLANG_ERROR: Couldn't get attribute ID from name. Attribute with name \""+std::string(attribute)+"\" is not registered"
             );
         }
         return iterator - attributesStr.begin();
     }
-    type::Type Class::getAttributeType(std::string attribute) {
-        uint32_t attributeID;
-        try {
-            attributeID = getAttributeID(attribute);
-        } catch (...) {
-            throw std::runtime_error("ECLANG_ERROR: Couldn't get type of attribute \""+attribute+"\". Attribute is not registered");
+    type::Type Class::getAttributeType(std::string_view attribute) {
+        // We don't use getAttributeID here to avoid throwing and catching an exception
+        auto iterator = std::find(attributesStr.begin(), attributesStr.end(), attribute);
+        if (iterator == attributesStr.end()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't get type of attribute \""+std::string(attribute)+"\". Attribute is not registered");
         }
-        return attributes.at(attributeID).getType();
+        return attributes.at(iterator - attributesStr.begin()).getType();
     }
     type::Type Class::getAttributeType(uint32_t id) {
         if (!attributeExists(id)) {
@@ -75,4 +90,36 @@ namespace eclang {
         }
         return attributes.at(id).getType();
     }
+    Attribute* Class::getDefault(uint32_t id) {
+        if (!attributeExists(id)) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't get default value of attribute with ID \""+std::to_string(id)+"\". Invalid ID");
+        }
+        Attribute& attribute = attributes[id];
+        return attribute.getRawValue() != nullptr ? &attribute : nullptr;
+    }
+    bool Class::hasDefaults() {
+        return defaultCount > 0;
+    }
+    /**
+        Returns the default values of the Class (see ClassDefaults), or nullptr
+        if it doesn't have any. Objects keep them to read the attributes they don't set.
+        Do not call this manually.
+    */
+    std::shared_ptr<ClassDefaults> Class::_getDefaults() {
+        return defaults;
+    }
+
+
+    // PRIVATE
+    // -------
+    /**
+        Replaces the default values shared with Objects with the current ones
+    */
+    void Class::updateDefaults() {
+        if (defaultCount == 0) {
+            return;
+        }
+        // Objects loaded before keep the old ones
+        defaults = std::make_shared<ClassDefaults>(ClassDefaults{attributesStr, attributes});
+    }
 }
\ No newline at end of file
@@ -2,41 +2,40 @@
 // eclang
 #include "classes/attribute.hpp"
 #include "classes/language.hpp"
+#include "classes/mappedDocument.hpp"
 #include "classes/object.hpp"
 #include "classes/vectors.hpp"
+#include "util/binaryFormat.hpp"
+#include "util/byteReader.hpp"
 #include "util/globalConfig.hpp"
 #include "util/lexer.hpp"
+#include "util/releaseQueue.hpp"
+#include "util/stringTable.hpp"
 #include "util/stringUtils.hpp"
+#include "util/traversal.hpp"
 // std
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <istream>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
-// Defines (Instructions for clearer compiler code)
-#define INST_CREATE         uint8_t(0x01)
-#define INST_ATTRIBUTE      uint8_t(0x02)
-#define INST_SCOPE_ENTER    uint8_t(0x03)
-#define INST_SCOPE_EXIT     uint8_t(0x04)
-#define INST_INCLUDE        uint8_t(0x05)
-#define INST_TEMPLATE       uint8_t(0x06)
-#define INST_MARK_TEMPLATE  uint8_t(0x07)
-
-// When creating an object or attribute during compilation,
-// we might find a custom class or attribute. In this case
-// we enter INST_ATTR_CUSTOM (255) as an attribute followed
-// by a STRING.
-#define INST_ATTR_CUSTOM    uint8_t(255)
-
-
 namespace eclang {
     // Other
     #ifdef ECLANG_DEBUG
-    void debugLexer(std::vector<lexer::Token> tokens) {
+    void debugLexer(const std::vector<lexer::Token>& tokens) {
         std::cout << "ECLANG_LOG: Debugging lexer...\n";
         for (lexer::Token t : tokens) {
             // Set color depending on the token type
@@ -91,21 +90,20 @@ namespace eclang {
         }
         std::cout << "\nECLANG_LOG: Done!\n";
     }
-    void debugObjectsRecursive(std::vector<Object*> objects, uint8_t indentationLv = 0) {
-        std::string indentationStr = "";
-        for (uint8_t i = 0; i < indentationLv; i++) {
-            indentationStr += "\t";
-        }
-        for (Object* o : objects) {
-            std::vector<Object*> children = o->getObjects();
-            std::cout << 
-                indentationStr + "N_CHILDREN: " << children.size() << "\n" <<
-                indentationStr + "N_ATTRIBUT: " << o->getAttributes().size() << "\n" <<
-                indentationStr + "CLASS_NAME: " << o->getClassName() << "\n" <<
-                indentationStr + "OBJCT_NAME: " << o->getName() << "\n\n";
-            
-            debugObjectsRecursive(children, indentationLv+1);
-        }
+    void debugObjects(const std::vector<Object*>& objects) {
+        traversal::walk(objects,
+            [](traversal::Step& step) -> uint8_t {
+                Object* o = step.object;
+                std::string indentationStr(step.depth, '\t');
+                std::cout << 
+                    indentationStr + "N_CHILDREN: " << o->_getChildren().size() << "\n" <<
+                    indentationStr + "N_ATTRIBUT: " << o->_getAttributes().size() << "\n" <<
+                    indentationStr + "CLASS_NAME: " << o->getClassName() << "\n" <<
+                    indentationStr + "OBJCT_NAME: " << o->getName() << "\n\n";
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [](traversal::Step&) {}
+        );
     }
     #endif
 
@@ -134,7 +132,7 @@ namespace eclang {
         We assume that this is a number assignation. This function sets the current attribute with the value
         obtained from the text file (object) into the current Object
     */
-    size_t parseNumberAssignment(std::vector<lexer::Token> tokens, size_t currentIndex, type::Type attributeType, Object* currentScope) {
+    size_t parseNumberAssignment(const std::vector<lexer::Token>& tokens, size_t currentIndex, type::Type attributeType, Object* currentScope) {
         const lexer::Token& t = tokens.at(currentIndex);
         const lexer::Token& value = tokens.at(currentIndex+2); // We skip the equals because we know it's there
         const lexer::Token& semicolon = tokens.at(currentIndex+3);
@@ -190,7 +188,7 @@ namespace eclang {
         We assume that this is a vector assignation. This function sets the current attribute with the value
         obtained from the text file (vector) into the current Object
     */
-    size_t parseVectorAssignment(std::vector<lexer::Token> tokens, size_t currentIndex, type::Type attributeType, Object* currentScope) {
+    size_t parseVectorAssignment(const std::vector<lexer::Token>& tokens, size_t currentIndex, type::Type attributeType, Object* currentScope) {
         const lexer::Token& t = tokens.at(currentIndex);
         const lexer::Token& value = tokens.at(currentIndex+2); // must be identifier in the case of vectors
         if (value.type != lexer::type::IDENTIFIER) {
@@ -393,13 +391,13 @@ namespace eclang {
         
         Returns the amount of tokens consumed.
     */
-    size_t parseIdentifier(std::vector<lexer::Token> tokens, size_t currentIndex, Object* currentScope, Language* language) {
+    size_t parseIdentifier(const std::vector<lexer::Token>& tokens, size_t currentIndex, Object* currentScope, Language* language) {
         const lexer::Token& t = tokens.at(currentIndex);
         if (t.type != lexer::type::IDENTIFIER) throw std::runtime_error("ECLANG_ERROR: Called parseIdentifier() on a token that was not an identifier at column "+std::to_string(t.column)+" at line "+std::to_string(t.line)+".");
 
         // Is this an attribute?
         // Check for attribute of the current class
-        std::vector<std::string> attributes = language->getAttributes(currentScope->getClassName());
+        const std::vector<std::string>& attributes = language->getAttributes(currentScope->getClassName());
         bool isAttribute = false;
         for (std::string attribute : attributes) {
             if (attribute == t.string) {
@@ -489,283 +487,687 @@ namespace eclang {
     }
 
     /**
-        Takes a std::string and returns that same string in EcLang's binary format.
+        Appends a std::string in EcLang's binary format to the binary.
+        If a Layout with the STRING_TABLE flag is specified, the string is added to its
+        table and only its index is written.
     */
-    std::vector<uint8_t> compileString(std::string string, bool isMarkdown = false) {
-        std::vector<uint8_t> binary;
-
+    void compileString(std::vector<uint8_t>& binary, const std::string& string, bool isMarkdown = false, format::Layout* layout = nullptr) {
         binary.push_back(isMarkdown ? 1 : 0); // 0 or 1 depending on whether or not this is a markdown string
-        for (char c : string) {
-            binary.push_back(uint8_t(c)); // insert all chars
+        if (layout != nullptr && (layout->flags & format::flag::STRING_TABLE)) {
+            if (layout->flags & format::flag::VARINT) {
+                format::putVarint(binary, layout->addString(string));
+            } else {
+                format::putU32(binary, layout->addString(string));
+            }
+            return;
         }
+        binary.insert(binary.end(), string.begin(), string.end()); // insert all chars
         binary.push_back(0); // NULL-terminate
-
-        return binary;
     }
     /**
-        Takes a stream of bytes and an index and reads until the next 0.
-        This function will set the index passed to the position after the string
-        This string will have a 'n' or a 'm' prefix indicating whether it is
-        a Normal String or a Markdown String
+        Reads a STRING (prefix included) and returns its characters.
+        The view points into the data read (or the string table), no characters are
+        copied. It's only valid until the reader reads something else
     */
-    std::string decompileString(std::vector<uint8_t>& binary, size_t& index) {
-        // Get the type of String
-        char prefix;
-        if (binary.at(index) == 0) {
-            prefix = 'n';
-        } else {
-            prefix = 'm';
+    template<class Reader>
+    std::string_view readString(Reader& reader, const format::Encoding& encoding) {
+        if (reader.atEnd()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A String is out of bounds.");
         }
-
-        std::string decompiled;
-
-        // Get all the chars until we see a 0
-        for (size_t i = index+1; i < binary.size(); i++) {
-            if (binary.at(i) == 0) {
-                index = i;
-                break;
+        reader.byte(); // Prefix
+        // Strings stored in the table: prefix and index
+        if (encoding.flags & format::flag::STRING_TABLE) {
+            uint64_t string;
+            if (encoding.flags & format::flag::VARINT) {
+                size_t available;
+                const uint8_t* start = reader.window(format::MAX_VARINT_SIZE, available);
+                const uint8_t* next = format::getVarint(start, start + available, string);
+                if (next == nullptr) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A String is out of bounds.");
+                }
+                reader.skip(next - start);
+            } else {
+                if (reader.remaining() < 4) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A String is out of bounds.");
+                }
+                string = format::getU32(reader.bytes(4));
             }
+            if (string >= encoding.strings.size()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. String "+std::to_string(string)+" is not in the table.");
+            }
+            return encoding.strings[string];
+        }
 
-            decompiled += binary.at(i);
+        // Get all the chars until we see a 0
+        std::string_view value;
+        if (!reader.cstring(value)) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A String is not terminated.");
         }
+        return value;
+    }
 
-        return prefix + decompiled;
+    /**
+        Returns the quantization of an attribute in QUANTIZED files (see format::quantizeValue()),
+        nullptr if it isn't quantized. Throws a runtime error if its type can't be quantized
+    */
+    const format::QuantizedAttribute* findQuantized(const format::Encoding& encoding, uint32_t classID, uint32_t attributeID, type::Type type) {
+        if (encoding.quantized.empty()) {
+            return nullptr;
+        }
+        const format::QuantizedAttribute* quantized = format::findQuantized(encoding.quantized, classID, attributeID);
+        if (quantized != nullptr && format::quantizedComponents(type) == 0) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The QUANTIZATION section has an attribute that can't be quantized.");
+        }
+        return quantized;
     }
+    /**
+        Creates an Attribute object from an integer value stored as varints (see
+        format::putVarintValue()). If `previous` is not nullptr the value is a difference
+        that is added to it (see format::DeltaContext)
+    */
+    template<class Reader>
+    Attribute* createVarintAttributeFromBinary(Reader& reader, const std::string& attributeName, type::Type type, uint8_t* previous) {
+        alignas(8) uint8_t value[sizeof(vec4l)];
+        size_t available;
+        const uint8_t* start = reader.window(format::varintLayout(type).count * format::MAX_VARINT_SIZE, available);
+        const uint8_t* next = format::getVarintValue(start, start + available, type, value);
+        if (next == nullptr) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The value of \""+attributeName+"\" is corrupted.");
+        }
+        reader.skip(next - start);
+        if (previous != nullptr) {
+            format::addDelta(type, value, previous);
+            std::memcpy(value, previous, type::sizeOf(type));
+        }
 
+        auto make = [&](auto v) {
+            std::memcpy(&v, value, sizeof(v));
+            return new Attribute(attributeName, v);
+        };
+        switch (type) {
+        case type::INT16: return make(int16_t());
+        case type::INT32: return make(int32_t());
+        case type::INT64: return make(int64_t());
+        case type::UINT16: return make(uint16_t());
+        case type::UINT32: return make(uint32_t());
+        case type::UINT64: return make(uint64_t());
+        case type::VEC2I: return make(vec2i());
+        case type::VEC3I: return make(vec3i());
+        case type::VEC4I: return make(vec4i());
+        case type::VEC2L: return make(vec2l());
+        case type::VEC3L: return make(vec3l());
+        case type::VEC4L: return make(vec4l());
+        default:
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The type of \""+attributeName+"\" can't be stored as varints.");
+        }
+    }
     /**
         Creates an Attribute object by reading raw binary data.
-        This function obtains the value of the attribute by reading the type
-        of the data
+        This function obtains the value of the attribute (the data after the ID of
+        the attribute) by reading the type of the data. In DELTA files `previous` is the
+        previous value of the attribute (see format::DeltaContext), nullptr otherwise
     */
-    Attribute* createAttributeFromBinary(std::vector<uint8_t>& binary, size_t& index, uint8_t classID, Language* language) {
+    template<class Reader>
+    Attribute* createAttributeFromBinary(Reader& reader, uint8_t classID, uint8_t attributeID, Language* language, const format::Encoding& encoding, uint8_t* previous) {
         // Get the Name and Type of the attribute
-        std::string attributeName = language->getAttributeName(classID, binary.at(index));
-        type::Type type = language->getAttributeType(classID, binary.at(index));
-        index++;
+        const std::string& attributeName = language->getAttributeName(classID, attributeID);
+        type::Type type = language->getAttributeType(classID, attributeID);
+
+        if (type == type::STRING || type == type::STR_MD) {
+            std::string_view value = readString(reader, encoding);
+            return new Attribute(attributeName, std::string(value), type);
+        }
+        // Integers stored as varints
+        if ((encoding.flags & format::flag::VARINT) && format::varintLayout(type).count > 0) {
+            return createVarintAttributeFromBinary(reader, attributeName, type, previous);
+        }
 
-        // Get the value
+        // Lossy values are never padded nor stored as differences (see format::quantizeValue())
+        alignas(8) uint8_t dequantized[sizeof(vec4d)];
+        const uint8_t* value = dequantized;
+        if (const format::QuantizedAttribute* quantized = findQuantized(encoding, classID, attributeID, type)) {
+            const size_t size = format::quantizedSize(type, *quantized);
+            if (reader.remaining() < size) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The value of \""+attributeName+"\" is out of bounds.");
+            }
+            format::dequantizeValue(reader.bytes(size), type, *quantized, dequantized);
+        } else {
+            // Values with a fixed size must be inside the file (after their padding in ALIGNED files)
+            const size_t padding = format::alignmentPadding(reader.position() + encoding.fileOffset, type, encoding.flags);
+            if (reader.remaining() < padding + type::sizeOf(type)) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The value of \""+attributeName+"\" is out of bounds.");
+            }
+            reader.skip(padding);
+            value = reader.bytes(type::sizeOf(type));
+            if (previous != nullptr) {
+                format::addDelta(type, value, previous);
+                value = previous;
+            }
+        }
+
+        // Get the value (values are stored as they are in memory)
+        auto make = [&](auto v) {
+            std::memcpy(&v, value, sizeof(v));
+            return new Attribute(attributeName, v);
+        };
         switch (type) {
-        case type::INT8: {
-            int8_t value = *reinterpret_cast<int8_t*>(&binary.at(index));
-            return new Attribute(attributeName, value);
-        }
-        case type::INT16: {
-            uint8_t bytes[2];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            index += 1;
-            int16_t value = *reinterpret_cast<int16_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::INT32: {
-            uint8_t bytes[4];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            index += 3;
-            int32_t value = *reinterpret_cast<int32_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::INT64: {
-            uint8_t bytes[8];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            bytes[4] = binary.at(index+4);
-            bytes[5] = binary.at(index+5);
-            bytes[6] = binary.at(index+6);
-            bytes[7] = binary.at(index+7);
-            index += 7;
-            int64_t value = *reinterpret_cast<int64_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::UINT8: {
-            return new Attribute(attributeName, binary.at(index));
-        }
-        case type::UINT16: {
-            uint8_t bytes[2];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            index += 1;
-            uint16_t value = *reinterpret_cast<uint16_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::UINT32: {
-            uint8_t bytes[4];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            index += 3;
-            uint32_t value = *reinterpret_cast<uint32_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::UINT64: {
-            uint8_t bytes[8];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            bytes[4] = binary.at(index+4);
-            bytes[5] = binary.at(index+5);
-            bytes[6] = binary.at(index+6);
-            bytes[7] = binary.at(index+7);
-            index += 7;
-            uint64_t value = *reinterpret_cast<uint64_t*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::FLOAT: {
-            uint8_t bytes[4];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            index += 3;
-            float value = *reinterpret_cast<float*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::DOUBLE: {
-            uint8_t bytes[8];
-            bytes[0] = binary.at(index);
-            bytes[1] = binary.at(index+1);
-            bytes[2] = binary.at(index+2);
-            bytes[3] = binary.at(index+3);
-            bytes[4] = binary.at(index+4);
-            bytes[5] = binary.at(index+5);
-            bytes[6] = binary.at(index+6);
-            bytes[7] = binary.at(index+7);
-            index += 7;
-            double value = *reinterpret_cast<double*>(&bytes);
-            return new Attribute(attributeName, value);
-        }
-        case type::STRING: {
-            std::string value = decompileString(binary, index);
-            return new Attribute(attributeName, value.substr(1), type::STRING);
-        }
-        case type::STR_MD: {
-            std::string value = decompileString(binary, index);
-            return new Attribute(attributeName, value.substr(1), type::STR_MD);
-        }
-        case type::VEC2I: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec2i));
-            index += sizeof(vec2i) - 1;
-            vec2i value = *reinterpret_cast<vec2i*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC3I: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec3i));
-            index += sizeof(vec3i) - 1;
-            vec3i value = *reinterpret_cast<vec3i*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC4I: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec4i));
-            index += sizeof(vec4i) - 1;
-            vec4i value = *reinterpret_cast<vec4i*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC2L: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec2l));
-            index += sizeof(vec2l) - 1;
-            vec2l value = *reinterpret_cast<vec2l*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC3L: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec3l));
-            index += sizeof(vec3l) - 1;
-            vec3l value = *reinterpret_cast<vec3l*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC4L: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec4l));
-            index += sizeof(vec4l) - 1;
-            vec4l value = *reinterpret_cast<vec4l*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC2F: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec2f));
-            index += sizeof(vec2f) - 1;
-            vec2f value = *reinterpret_cast<vec2f*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC3F: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec3f));
-            index += sizeof(vec3f) - 1;
-            vec3f value = *reinterpret_cast<vec3f*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC4F: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec4f));
-            index += sizeof(vec4f) - 1;
-            vec4f value = *reinterpret_cast<vec4f*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC2D: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec2d));
-            index += sizeof(vec2d) - 1;
-            vec2d value = *reinterpret_cast<vec2d*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC3D: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec3d));
-            index += sizeof(vec3d) - 1;
-            vec3d value = *reinterpret_cast<vec3d*>(subVec.data());
-            return new Attribute(attributeName, value);
-        }
-        case type::VEC4D: {
-            std::vector<uint8_t> subVec(binary.begin() + index, binary.begin() + index + sizeof(vec4d));
-            index += sizeof(vec4d) - 1;
-            vec4d value = *reinterpret_cast<vec4d*>(subVec.data());
-            return new Attribute(attributeName, value);
+        case type::INT8: return make(int8_t());
+        case type::INT16: return make(int16_t());
+        case type::INT32: return make(int32_t());
+        case type::INT64: return make(int64_t());
+        case type::UINT8: return make(uint8_t());
+        case type::UINT16: return make(uint16_t());
+        case type::UINT32: return make(uint32_t());
+        case type::UINT64: return make(uint64_t());
+        case type::FLOAT: return make(float());
+        case type::DOUBLE: return make(double());
+        case type::VEC2I: return make(vec2i());
+        case type::VEC3I: return make(vec3i());
+        case type::VEC4I: return make(vec4i());
+        case type::VEC2L: return make(vec2l());
+        case type::VEC3L: return make(vec3l());
+        case type::VEC4L: return make(vec4l());
+        case type::VEC2F: return make(vec2f());
+        case type::VEC3F: return make(vec3f());
+        case type::VEC4F: return make(vec4f());
+        case type::VEC2D: return make(vec2d());
+        case type::VEC3D: return make(vec3d());
+        case type::VEC4D: return make(vec4d());
+        default:
+            return nullptr;
         }
+    }
+    /**
+        Skips a value of the type specified without reading it. `quantized` is the
+        quantization of the attribute (see findQuantized()), nullptr if it isn't quantized
+    */
+    template<class Reader>
+    void skipAttributeValue(Reader& reader, type::Type type, const format::Encoding& encoding, const format::QuantizedAttribute* quantized) {
+        if (type == type::STRING || type == type::STR_MD) {
+            readString(reader, encoding);
+            return;
         }
-        return nullptr;
+        if (quantized != nullptr) {
+            reader.skip(format::quantizedSize(type, *quantized));
+            return;
+        }
+        // Integers stored as varints: every byte but the last one of each number has the highest bit set
+        format::VarintLayout varints = format::varintLayout(type);
+        if ((encoding.flags & format::flag::VARINT) && varints.count > 0) {
+            size_t available;
+            const uint8_t* start = reader.window(varints.count * format::MAX_VARINT_SIZE, available);
+            const uint8_t* next = start;
+            uint64_t value;
+            for (size_t n = 0; n < varints.count && next != nullptr; n++) {
+                next = format::getVarint(next, start + available, value);
+            }
+            if (next == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A value is out of bounds.");
+            }
+            reader.skip(next - start);
+            return;
+        }
+        const size_t padding = format::alignmentPadding(reader.position() + encoding.fileOffset, type, encoding.flags);
+        if (reader.remaining() < padding + type::sizeOf(type)) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A value is out of bounds.");
+        }
+        reader.skip(padding + type::sizeOf(type));
     }
+    /**
+        Types of the attributes of the classes of a language, in order of ID. Each class
+        is looked up in the language the first time it's used, so every attribute after
+        that costs a single array lookup
+    */
+    class AttributeTypes {
+    public:
+        AttributeTypes(Language* language) : language(language) {}
+
+        const std::vector<type::Type>& of(uint32_t classID) {
+            if (classID >= types.size()) {
+                language->getClassName(classID); // Throws if the class doesn't exist
+                types.resize(classID + 1);
+            }
+            std::vector<type::Type>& classTypes = types[classID];
+            if (classTypes.empty()) {
+                const size_t count = language->getAttributes(classID).size();
+                for (uint32_t id = 0; id < count; id++) {
+                    classTypes.push_back(language->getAttributeType(classID, id));
+                }
+            }
+            return classTypes;
+        }
+        type::Type get(uint32_t classID, uint8_t id) {
+            const std::vector<type::Type>& classTypes = of(classID);
+            if (id >= classTypes.size()) {
+                return language->getAttributeType(classID, id); // Throws
+            }
+            return classTypes[id];
+        }
 
-    // PUBLIC
-    // ------
+    private:
+        Language* language;
+        std::vector<std::vector<type::Type>> types;
+    };
+    /**
+        Interned names of the classes of the language (see StringTable) and their default
+        values, found the first time a class is used. Objects created after that don't
+        look for their class name in the table, and the ID of the class of an object is
+        found by comparing its class name handle
+    */
+    class ClassHandles {
+    public:
+        ClassHandles(Language* language, StringTable& strings) : language(language), strings(strings) {}
+
+        const std::string* name(uint32_t classID) {
+            if (classID >= names.size()) {
+                language->getClassName(classID); // Throws if the class doesn't exist
+                names.resize(classID + 1, nullptr);
+                defaults.resize(classID + 1);
+            }
+            if (names[classID] == nullptr) {
+                names[classID] = strings.intern(language->getClassName(classID));
+                defaults[classID] = language->getClass(classID)._getDefaults();
+            }
+            return names[classID];
+        }
+        // Default values of the class of the ID, nullptr if it doesn't have any (see Object::Object())
+        const std::shared_ptr<ClassDefaults>& defaultsOf(uint32_t classID) {
+            name(classID);
+            return defaults[classID];
+        }
+        uint32_t id(const std::string* className) {
+            for (size_t i = 0; i < names.size(); i++) {
+                if (names[i] == className) {
+                    return i;
+                }
+            }
+            return language->getClassID(*className);
+        }
 
+    private:
+        Language* language;
+        StringTable& strings;
+        std::vector<const std::string*> names;
+        std::vector<std::shared_ptr<ClassDefaults>> defaults;
+    };
     /**
-        Constructs an EcLang object from the path to the file.
-        The Language (AUII, NEA, Other...) will be automatically
-        detected.
+        Reads the bitmap of an ATTRIBUTES instruction of a class with `attributeCount`
+        attributes into `bitmap` (format::MAX_BITMAP_SIZE bytes) and returns its size.
+        Throws a runtime error if a bit is set for an attribute the class doesn't have
     */
-    EcLang::EcLang(std::string filepath, uint8_t fileID) : currentFile(fileID) {
-        // The filepath specified may be an alias.
-        // This string contains the actual file path that we can load.
-        std::string trueFilepath;
+    template<class Reader>
+    size_t readAttributeBitmap(Reader& reader, size_t attributeCount, uint8_t* bitmap) {
+        const size_t size = (attributeCount + 7) / 8;
+        if (size > format::MAX_BITMAP_SIZE || reader.remaining() < size) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An attribute bitmap is out of bounds.");
+        }
+        // Copied because stream readers may reuse the bytes returned
+        std::memcpy(bitmap, reader.bytes(size), size);
+        if (size > 0 && (attributeCount % 8) != 0 && (bitmap[size-1] >> (attributeCount % 8)) != 0) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An attribute bitmap sets an attribute that doesn't exist.");
+        }
+        return size;
+    }
+    /**
+        Calls `visit(id)` for every attribute set in a bitmap, in order of ID
+    */
+    template<class Visit>
+    void forEachBit(const uint8_t* bitmap, size_t size, Visit visit) {
+        for (size_t byte = 0; byte < size; byte++) {
+            for (uint8_t bits = bitmap[byte]; bits != 0; bits &= bits - 1) {
+                uint8_t bit = 0;
+                while (!(bits & (1 << bit))) {
+                    bit++;
+                }
+                visit(uint8_t(byte*8 + bit));
+            }
+        }
+    }
 
-        // Get alias if it exists
-        if (config::filepathIsAlias(filepath)) {
-            trueFilepath = config::filepathGetFor(filepath);
-        } else {
-            trueFilepath = filepath;
+    /**
+        Parameters of a CLONE instruction (DEDUPLICATED files): the position of the
+        instructions of the children copied (from the start of DATA), their size in
+        bytes and the number of objects they create.
+        INSTANCE instructions (INSTANCES files) have the same ones for their prototype
+    */
+    struct Clone {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t objects;
+    };
+    template<class Reader>
+    Clone readClone(Reader& reader) {
+        uint64_t values[3];
+        for (uint64_t& value : values) {
+            size_t available;
+            const uint8_t* start = reader.window(format::MAX_VARINT_SIZE, available);
+            const uint8_t* next = format::getVarint(start, start + available, value);
+            if (next == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A CLONE instruction is out of bounds.");
+            }
+            reader.skip(next - start);
         }
+        return {values[0], values[1], values[2]};
+    }
 
-        // Read file as binary
-        std::ifstream file(trueFilepath, std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("ECLANG_ERROR: Couldn't load file \""+trueFilepath+"\". No such fie or directory");
+    /**
+        Skips the object created by the CREATE instruction just read without creating
+        anything: its scope (if it has one) is skipped. If the file has sized scopes and
+        the number of objects in its subtree is known (`subtreeSize` is not 0) the scope
+        is jumped over. If not, its instructions are read until the scope is closed.
+
+        Returns the number of objects skipped (this one included).
+    */
+    template<class Reader>
+    size_t skipObject(Reader& reader, uint32_t classID, uint32_t subtreeSize, Language* language, const format::Encoding& encoding) {
+        if (reader.atEnd() || reader.peek() != INST_SCOPE_ENTER) {
+            return 1;
+        }
+        const bool sizedScopes = encoding.flags & format::flag::SIZED_SCOPES;
+
+        // Jump to the SCOPE_EXIT
+        if (sizedScopes && subtreeSize > 0) {
+            reader.byte();
+            if (reader.remaining() < format::SCOPE_SIZE_SIZE) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+            }
+            uint32_t scopeSize = format::getU32(reader.bytes(format::SCOPE_SIZE_SIZE));
+            if (scopeSize == 0 || scopeSize > reader.remaining()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+            }
+            reader.skip(scopeSize - 1);
+            if (reader.byte() != INST_SCOPE_EXIT) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+            }
+            return subtreeSize;
         }
 
-        // Find file size
-        file.seekg(0, std::ios::end);
-        size_t length = file.tellg();
-        file.seekg(0, std::ios::beg);
+        // Read the instructions until the scope is closed. We need the class of every
+        // open scope to know the types of the attributes
+        std::vector<uint32_t> scopeClasses;
+        uint32_t lastClass = classID;
+        size_t skipped = 1;
+        AttributeTypes attributeTypes(language);
+        while (!reader.atEnd()) {
+            const size_t position = reader.position();
+            const uint8_t instruction = reader.byte();
+            switch (instruction) {
+            case INST_CREATE: {
+                const uint8_t id = reader.byte();
+                if (id == INST_ATTR_CUSTOM) {
+                    // Custom classes only have custom attributes
+                    std::string_view className = readString(reader, encoding);
+                    lastClass = language->classExists(className) ? language->getClassID(className) : INST_ATTR_CUSTOM;
+                } else {
+                    lastClass = id;
+                }
+                readString(reader, encoding);
+                skipped++;
+                break;
+            }
+            case INST_ATTRIBUTE: {
+                const uint8_t id = reader.byte();
+                if (id == INST_ATTR_CUSTOM) {
+                    readString(reader, encoding);
+                    readString(reader, encoding);
+                    break;
+                }
+                const type::Type type = attributeTypes.get(scopeClasses.back(), id);
+                skipAttributeValue(reader, type, encoding, findQuantized(encoding, scopeClasses.back(), id, type));
+                break;
+            }
+            case INST_ATTRIBUTES: {
+                const std::vector<type::Type>& types = attributeTypes.of(scopeClasses.back());
+                uint8_t bitmap[format::MAX_BITMAP_SIZE];
+                forEachBit(bitmap, readAttributeBitmap(reader, types.size(), bitmap), [&](uint8_t id) {
+                    skipAttributeValue(reader, types[id], encoding, findQuantized(encoding, scopeClasses.back(), id, types[id]));
+                });
+                break;
+            }
+            case INST_SCOPE_ENTER: {
+                if (sizedScopes) {
+                    if (reader.remaining() < format::SCOPE_SIZE_SIZE) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+                    }
+                    reader.skip(format::SCOPE_SIZE_SIZE);
+                }
+                scopeClasses.push_back(lastClass);
+                break;
+            }
+            case INST_SCOPE_EXIT: {
+                scopeClasses.pop_back();
+                if (scopeClasses.empty()) {
+                    return skipped;
+                }
+                break;
+            }
+            case INST_INCLUDE:
+            case INST_TEMPLATE: {
+                readString(reader, encoding);
+                break;
+            }
+            case INST_MARK_TEMPLATE:
+                break;
+            case INST_CLONE: {
+                if (encoding.flags & format::flag::DEDUPLICATED) {
+                    skipped += readClone(reader).objects;
+                    break;
+                }
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unknown instruction ("+std::to_string(instruction)+") at byte "+std::to_string(position)+".");
+            }
+            case INST_INSTANCE: {
+                // The prototype counts itself, which is the object of the scope
+                if (encoding.flags & format::flag::INSTANCES) {
+                    const uint64_t objects = readClone(reader).objects;
+                    if (objects == 0) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An INSTANCE instruction doesn't copy its prototype.");
+                    }
+                    skipped += objects - 1;
+                    break;
+                }
+                [[fallthrough]];
+            }
+            default:
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unknown instruction ("+std::to_string(instruction)+") at byte "+std::to_string(position)+".");
+            }
+        }
+        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is not closed.");
+    }
 
-        // Put contents into vector
-        char* buffer = new char[length];
-        if (!file.read(buffer, length)) {
-            delete[] buffer;
-            throw std::runtime_error("ECLANG_ERROR: Couldn't copy contents of file into buffer");
+    /**
+        Writes the value of an attribute for every object into a buffer (used by
+        EcLang::exportAttributes()). The size is a template parameter so that every
+        copy is a fixed-size memcpy that the compiler turns into plain (vector) moves.
+    */
+    template<size_t size>
+    void exportAttributeValues(const std::vector<Object*>& objects, const std::string& attribute, type::Type type, const uint8_t* defaultValue, uint8_t* buffer, size_t stride, std::vector<uint8_t>& presence) {
+        // Objects of the same class usually set their attributes in the same order,
+        // so we first try the position where we found the attribute in the previous object
+        size_t guess = 0;
+        for (size_t i = 0; i < objects.size(); i++) {
+            const std::vector<Attribute*>& attributes = objects[i]->_getAttributes();
+            Attribute* found = nullptr;
+            if (guess < attributes.size() && attributes[guess]->getName() == attribute) {
+                found = attributes[guess];
+            } else {
+                for (size_t a = 0; a < attributes.size(); a++) {
+                    if (attributes[a]->getName() == attribute) {
+                        found = attributes[a];
+                        guess = a;
+                        break;
+                    }
+                }
+            }
+            // Not set (or set with a different type, which can only happen with custom attributes).
+            // Objects that don't set it have the default value of the class, if any
+            const void* value = (found != nullptr && found->getType() == type) ? found->getRawValue() : defaultValue;
+            if (value == nullptr) {
+                continue;
+            }
+            std::memcpy(buffer + i*stride, value, size);
+            presence[i / 8] |= uint8_t(1 << (i % 8));
         }
+    }
 
-        // Close file
-        file.close();
+    /**
+        Hashes of an object of a tree being compiled with the DEDUPLICATED flag: of the
+        object with its attributes and children and of the list of its children alone.
+        Children that contain objects of other files or the Template Node can't be
+        written with a CLONE instruction
+    */
+    struct SubtreeHash {
+        uint64_t subtree;
+        uint64_t children;
+        bool clonable; // The object can be part of a CLONE
+        bool childrenClonable; // All the children can be part of a CLONE
+    };
+    /**
+        Returns the SubtreeHash of every object of the tree (walked without recursion)
+    */
+    std::unordered_map<Object*, SubtreeHash> hashSubtrees(const std::vector<Object*>& objects, Object* templateNode) {
+        std::unordered_map<Object*, SubtreeHash> hashes;
+        traversal::walk(objects,
+            [&](traversal::Step& step) -> uint8_t {
+                // Objects of other files are written as INCLUDE and TEMPLATE instructions
+                if (step.object->getSourceFileID() != 0) {
+                    hashes[step.object] = {0, 0, false, false};
+                    return traversal::action::SKIP_CHILDREN;
+                }
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [&](traversal::Step& step) {
+                Object* object = step.object;
+                SubtreeHash hash {format::hashBytes(object->getClassName().data(), object->getClassName().size()), format::PATH_HASH_BASIS, true, true};
+                hash.subtree = format::hashBytes("", 1, format::hashBytes(object->getName().data(), object->getName().size(), hash.subtree));
+                for (Attribute* a : object->_getAttributes()) {
+                    const type::Type attributeType = a->getType();
+                    hash.subtree = format::hashBytes(a->getName().data(), a->getName().size() + 1, hash.subtree);
+                    hash.subtree = format::hashBytes(&attributeType, sizeof(attributeType), hash.subtree);
+                    const void* value = a->getRawValue();
+                    if (attributeType == type::STRING || attributeType == type::STR_MD) {
+                        const std::string* string = static_cast<const std::string*>(value);
+                        hash.subtree = format::hashBytes(string->data(), string->size() + 1, hash.subtree);
+                    } else if (value != nullptr) {
+                        hash.subtree = format::hashBytes(value, type::sizeOf(attributeType), hash.subtree);
+                    }
+                }
+                for (Object* child : object->_getChildren()) {
+                    const SubtreeHash& childHash = hashes.at(child);
+                    hash.children = format::hashBytes(&childHash.subtree, sizeof(childHash.subtree), hash.children);
+                    hash.childrenClonable = hash.childrenClonable && childHash.clonable;
+                }
+                hash.subtree = format::hashBytes(&hash.children, sizeof(hash.children), hash.subtree);
+                hash.clonable = hash.childrenClonable && object != templateNode;
+                hashes[object] = hash;
+            }
+        );
+        return hashes;
+    }
+    /**
+        Returns true if the children of both objects are the same: same classes, names,
+        attributes (in the same order) and children (compared without recursion)
+    */
+    bool sameChildren(Object* a, Object* b) {
+        std::vector<std::pair<Object*, Object*>> pending {{a, b}};
+        while (!pending.empty()) {
+            const auto [first, second] = pending.back();
+            pending.pop_back();
+            const std::vector<Object*>& firstChildren = first->_getChildren();
+            const std::vector<Object*>& secondChildren = second->_getChildren();
+            if (firstChildren.size() != secondChildren.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < firstChildren.size(); i++) {
+                Object* x = firstChildren[i];
+                Object* y = secondChildren[i];
+                if (x->getSourceFileID() != y->getSourceFileID() || x->getClassName() != y->getClassName() || x->getName() != y->getName()) {
+                    return false;
+                }
+                const std::vector<Attribute*>& xAttributes = x->_getAttributes();
+                const std::vector<Attribute*>& yAttributes = y->_getAttributes();
+                if (xAttributes.size() != yAttributes.size()) {
+                    return false;
+                }
+                for (size_t j = 0; j < xAttributes.size(); j++) {
+                    if (xAttributes[j]->getName() != yAttributes[j]->getName() || !xAttributes[j]->hasSameValue(*yAttributes[j])) {
+                        return false;
+                    }
+                }
+                pending.push_back({x, y});
+            }
+        }
+        return true;
+    }
+    /**
+        Returns true if the attributes of the instance are the ones of its prototype
+        (same order) with the ones in `own` replacing or following them, and it gets
+        something from the prototype. `own` gets the attributes the instance changes
+        or adds, which are the only ones compiled with its INSTANCE instruction
+    */
+    bool instanceAttributes(Object* instance, Object* prototype, std::vector<std::string>& own) {
+        const std::vector<Attribute*>& attributes = instance->_getAttributes();
+        const std::vector<Attribute*>& inherited = prototype->_getAttributes();
+        auto find = [](const std::vector<Attribute*>& list, const std::string& name) {
+            return std::find_if(list.begin(), list.end(), [&](Attribute* a) { return a->getName() == name; });
+        };
+        // The attributes the prototype sets come first and none of them was removed
+        if (attributes.size() < inherited.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < attributes.size(); i++) {
+            Attribute* a = attributes[i];
+            if (i < inherited.size()) {
+                if (a->getName() != inherited[i]->getName()) {
+                    return false;
+                }
+                if (a->hasSameValue(*inherited[i])) {
+                    continue;
+                }
+            } else if (find(inherited, a->getName()) != inherited.end()) {
+                return false;
+            }
+            own.push_back(a->getName());
+        }
+        return own.size() < inherited.size() || !prototype->_getChildren().empty();
+    }
 
-        // Get file name without extension
+    /**
+        Returns the default values of the class of the language with the name specified
+        (see Class::_getDefaults()), or nullptr if it isn't registered or doesn't have any.
+        Objects keep them to read the defaults of the attributes they don't set
+    */
+    std::shared_ptr<ClassDefaults> classDefaults(Language* language, std::string_view className) {
+        if (!language->classExists(className)) {
+            return nullptr;
+        }
+        return language->getClass(language->getClassID(className))._getDefaults();
+    }
+    /**
+        Returns the Language whose identifier bytes start the data (the language
+        of a compiled file) or nullptr if there isn't one
+    */
+    Language* findCompiledLanguage(const uint8_t* data, size_t size) {
+        for (Language& languageChecking : config::getLanguages()) {
+            const std::vector<uint8_t>& identifierBytes = languageChecking.getIdentifierBytes();
+            if (identifierBytes.size() <= size && std::equal(identifierBytes.begin(), identifierBytes.end(), data)) {
+                return &languageChecking;
+            }
+        }
+        return nullptr;
+    }
+    /**
+        Returns a ByteSource that reads from the stream
+    */
+    format::ByteSource readFrom(std::istream& stream) {
+        return [&stream](uint8_t* buffer, size_t size) {
+            stream.read(reinterpret_cast<char*>(buffer), size);
+            return size_t(stream.gcount());
+        };
+    }
+    /**
+        Returns the name of the file (without the directories or the extension)
+    */
+    std::string filenameWithoutExtension(const std::string& trueFilepath) {
         size_t indexOfLastSlash = trueFilepath.find_last_of('/');
         size_t indexOfLastDot = trueFilepath.find_last_of('.');
         // If there are no slash characters in the name, the file name starts in the 0th position
@@ -782,18 +1184,51 @@ namespace eclang {
             // For example, if `indexOfLastSlash` is 0, we would read `trueFilepath.length()` characters from the position 0 (the whole string)
             indexOfLastDot = trueFilepath.length();
         }
-        // Finally get name without extension
-        // Register this name into array if this is the original file loaded by the user (fileID = 0)
+        return trueFilepath.substr(indexOfLastSlash, indexOfLastDot - indexOfLastSlash);
+    }
+
+    // PUBLIC
+    // ------
+
+    /**
+        Constructs an EcLang object from the path to the file.
+        The Language (AUII, NEA, Other...) will be automatically
+        detected.
+    */
+    EcLang::EcLang(std::string filepath, uint8_t fileID) : EcLang(std::move(filepath), fileID, std::make_shared<StringTable>()) {}
+    /**
+        Constructs an EcLang object from the path to the file, storing the
+        names of its objects in the string table specified and loading what the
+        LoadOptions allow.
+    */
+    EcLang::EcLang(std::string filepath, uint8_t fileID, std::shared_ptr<StringTable> strings, LoadOptions loadOptions) : strings(std::move(strings)), loadOptions(std::move(loadOptions)), currentFile(fileID) {
+        // The filepath specified may be an alias.
+        // This string contains the actual file path that we can load.
+        std::string trueFilepath;
+
+        // Get alias if it exists
+        if (config::filepathIsAlias(filepath)) {
+            trueFilepath = config::filepathGetFor(filepath);
+        } else {
+            trueFilepath = filepath;
+        }
+
+        // Read file as binary
+        std::ifstream file(trueFilepath, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't load file \""+trueFilepath+"\". No such fie or directory");
+        }
+
+        // Register the name without extension into array if this is the original file loaded by the user (fileID = 0)
         // This is used when exporting the file
         if (fileID == 0) {
-            includedFilenames.push_back(trueFilepath.substr(indexOfLastSlash, indexOfLastDot - indexOfLastSlash));
+            includedFilenames.push_back(filenameWithoutExtension(trueFilepath));
         }
 
-        // Initialize EcLang with the raw file data
-        initializeEcLang(buffer, length);
-
-        // Delete file buffer
-        delete[] buffer;
+        // Initialize EcLang reading the file in chunks (compiled files are never
+        // loaded entirely)
+        format::StreamReader reader(readFrom(file));
+        initializeEcLang(reader);
     }
     /**
         Constructs an EcLang object from raw data that corresponds to the
@@ -801,7 +1236,7 @@ namespace eclang {
         The Language (AUII, NEA, Other...) will be automatically
         detected.
     */
-    EcLang::EcLang(std::string name, void* data, size_t size, uint8_t fileID) : currentFile(fileID) {
+    EcLang::EcLang(std::string name, void* data, size_t size, uint8_t fileID) : strings(std::make_shared<StringTable>()), currentFile(fileID) {
         // Register name into array if this is the original file loaded by the user (fileID = 0)
         // This is used when exporting the file
         if (fileID == 0) {
@@ -810,35 +1245,218 @@ namespace eclang {
         initializeEcLang(data, size);
     }
     /**
-        Guess what it does
+        Constructs an EcLang object reading a source or compiled file from a stream.
+        Compiled files are decoded as they're read, so they don't need to be in
+        memory (see the constructor that takes a ByteSource).
+        The name is used during file export.
     */
-    EcLang::~EcLang() {
-        // We should only delete our objects if this file was not included by another file
-        if (isIncluded) { return; }
-        for (Object* o : objects) {
-            delete o;
-        }
-    }
-    
+    EcLang::EcLang(std::string name, std::istream& stream, LoadOptions options) : EcLang(std::move(name), readFrom(stream), std::move(options)) {}
     /**
-        Saves the compiled/decompiled file.
-        If a source file was loaded in the constructor we save a compiled file,
-        if a compiled file was loaded instead we save a decompiled source file.
+        Constructs an EcLang object reading a source or compiled file from a
+        ByteSource (a pipe, a socket, a file descriptor...). The data is requested
+        in chunks and compiled files are decoded as they arrive: only the chunk being
+        read is kept in memory (and the string table if the file has one).
+        Source files and compressed files are read entirely first.
+        The name is used during file export.
     */
-    void EcLang::saveToFile(std::string fileWithoutExtension) {
-        // If if's a source file we save the compiled file.
-        // If not, we save a decompiled source file
-        if (fileWasSource) {
-            saveToFileCompiled(fileWithoutExtension);
-        } else {
-            saveToFileSource(fileWithoutExtension);
-        }
+    EcLang::EcLang(std::string name, ByteSource source, LoadOptions options) : strings(std::make_shared<StringTable>()), loadOptions(std::move(options)), currentFile(0) {
+        includedFilenames.push_back(std::move(name));
+        format::StreamReader reader(std::move(source));
+        initializeEcLang(reader);
     }
     /**
-        Saves the compiled EcLang file (compiled at initialization or simply loaded)
+        Constructs an EcLang object from the path to a compiled file, loading
+        only the classes and attributes allowed by the options (see LoadOptions).
+        The options are also applied to the files it includes dynamically.
     */
-    void EcLang::saveToFileCompiled(std::string fileWithoutExtension) {
-        // Check: is this file the one loaded by the user?
+    EcLang::EcLang(std::string filepath, LoadOptions options) : EcLang(std::move(filepath), 0, std::make_shared<StringTable>(), std::move(options)) {}
+    /**
+        Loads only the node at the path specified (node1/node2/node3) of a
+        compiled file and all of its children. The nodes that contain it are
+        created without attributes so that the node keeps its path.
+
+        Nothing else in the file is read, so loading a node costs the same
+        no matter how big the file is. The file must be a version 2 compiled
+        file with sized scopes (the default).
+
+        Throws a runtime error if the node doesn't exist.
+    */
+    EcLang EcLang::loadSubtree(std::string filepath, std::string_view path) {
+        if (config::filepathIsAlias(filepath)) {
+            filepath = config::filepathGetFor(filepath);
+        }
+        // The node table and the names are read from the mapped file
+        MappedDocument document(filepath);
+        return EcLang(document, path, filenameWithoutExtension(filepath));
+    }
+    /**
+        Constructs an EcLang object with the node at the path specified of a
+        mapped file, its subtree and empty copies of its ancestors (see loadSubtree()).
+        The name is used during file export.
+    */
+    EcLang::EcLang(const MappedDocument& document, std::string_view path, std::string name) : strings(std::make_shared<StringTable>()), currentFile(0) {
+        std::optional<MappedNode> node = document.getObject(path);
+        if (!node.has_value()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't load \""+std::string(path)+"\" from \""+name+"\". The node doesn't exist.");
+        }
+        includedFilenames.push_back(std::move(name));
+        language = document.getLanguage();
+        fileWasSource = false;
+
+        try {
+            // Ancestors: only their class and name
+            std::vector<MappedNode> ancestors;
+            for (std::optional<MappedNode> parent = node->getParent(); parent.has_value(); parent = parent->getParent()) {
+                ancestors.push_back(*parent);
+            }
+            for (auto it = ancestors.rbegin(); it != ancestors.rend(); it++) {
+                Object* o = new Object(strings->intern(it->getClassName()), strings->intern(it->getName()), currentFile, classDefaults(language, it->getClassName()));
+                if (scope.empty()) {
+                    objects.push_back(o);
+                } else {
+                    scope.back()->_addChild(o);
+                }
+                scope.push_back(o);
+            }
+
+            const uint32_t first = node->_getIndex();
+            const uint32_t subtreeSize = node->_getSubtreeSize();
+            format::NodeCounts counts;
+            counts.children.resize(subtreeSize);
+            for (uint32_t i = 0; i < subtreeSize; i++) {
+                counts.children[i] = document.getNode(first + i).getObjectCount();
+            }
+            // The node and its subtree are decoded where they are in the mapped file
+            format::Encoding encoding;
+            encoding.flags = document._getFlags();
+            encoding.strings = document._getStrings();
+            encoding.quantized = document._getQuantized();
+            encoding.code = document._getData();
+            encoding.codeBegin = document._getCodeBegin();
+            encoding.codeEnd = document._getCodeEnd();
+            // The values of the node are differences with its previous siblings of the same class
+            if ((encoding.flags & format::flag::DELTA) && language->classExists(node->getClassName())) {
+                const uint32_t classID = language->getClassID(node->getClassName());
+                AttributeTypes attributeTypes(language);
+                const std::vector<type::Type>& types = attributeTypes.of(classID);
+                std::optional<MappedNode> parent = node->getParent();
+                alignas(8) uint8_t delta[format::MAX_VALUE_SIZE];
+                for (const MappedNode& sibling : parent.has_value() ? parent->getObjects() : document.getAllObjects()) {
+                    if (sibling._getIndex() == first) {
+                        break;
+                    }
+                    if (sibling.getClassName() != node->getClassName()) {
+                        continue;
+                    }
+                    for (size_t id = 0; id < types.size(); id++) {
+                        const size_t size = type::sizeOf(types[id]);
+                        // Quantized values are never stored as differences
+                        if (size > 0 && format::findQuantized(encoding.quantized, classID, id) == nullptr && sibling._readStoredValue(language->getAttributeName(classID, id), delta, size)) {
+                            format::addDelta(types[id], delta, encoding.previous.find(format::deltaKey(classID, id)));
+                        }
+                    }
+                }
+            }
+            size_t created = decodeBuffer(document._getData(), node->_getPosition(), node->_getEnd(), counts, encoding, subtreeSize);
+            if (created != subtreeSize) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The NODES section doesn't match the instructions.");
+            }
+            scope.clear();
+        } catch (...) {
+            for (Object* o : objects) {
+                delete o;
+            }
+            throw;
+        }
+    }
+    /**
+        Guess what it does
+    */
+    EcLang::~EcLang() {
+        releaseObjects();
+    }
+    /**
+        Takes the Objects, strings and prototypes of another EcLang object,
+        which is left without any Objects
+    */
+    EcLang::EcLang(EcLang&& other) noexcept :
+        includedFilenames(std::move(other.includedFilenames)),
+        fileWasSource(other.fileWasSource),
+        language(other.language),
+        source(std::move(other.source)),
+        objects(std::move(other.objects)),
+        scope(std::move(other.scope)),
+        strings(std::move(other.strings)),
+        isIncluded(other.isIncluded),
+        backgroundRelease(other.backgroundRelease),
+        compileOptions(std::move(other.compileOptions)),
+        loadOptions(std::move(other.loadOptions)),
+        templateNode(std::move(other.templateNode)),
+        externalTemplateNode(std::move(other.externalTemplateNode)),
+        prototypes(std::move(other.prototypes)),
+        currentFile(other.currentFile)
+    {
+        // The other object mustn't delete the Objects or point to them
+        other.objects.clear();
+        other.scope.clear();
+        other.templateNode.clear();
+        other.externalTemplateNode.clear();
+        other.prototypes.clear();
+    }
+    /**
+        Deletes the Objects of this EcLang object (see setBackgroundRelease())
+        and takes the ones of another, which is left without any Objects
+    */
+    EcLang& EcLang::operator=(EcLang&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        releaseObjects();
+
+        includedFilenames = std::move(other.includedFilenames);
+        fileWasSource = other.fileWasSource;
+        language = other.language;
+        source = std::move(other.source);
+        objects = std::move(other.objects);
+        scope = std::move(other.scope);
+        strings = std::move(other.strings);
+        isIncluded = other.isIncluded;
+        backgroundRelease = other.backgroundRelease;
+        compileOptions = std::move(other.compileOptions);
+        loadOptions = std::move(other.loadOptions);
+        templateNode = std::move(other.templateNode);
+        externalTemplateNode = std::move(other.externalTemplateNode);
+        prototypes = std::move(other.prototypes);
+        currentFile = other.currentFile;
+
+        // The other object mustn't delete the Objects or point to them
+        other.objects.clear();
+        other.scope.clear();
+        other.templateNode.clear();
+        other.externalTemplateNode.clear();
+        other.prototypes.clear();
+        return *this;
+    }
+    
+    /**
+        Saves the compiled/decompiled file.
+        If a source file was loaded in the constructor we save a compiled file,
+        if a compiled file was loaded instead we save a decompiled source file.
+    */
+    void EcLang::saveToFile(std::string fileWithoutExtension) {
+        // If if's a source file we save the compiled file.
+        // If not, we save a decompiled source file
+        if (fileWasSource) {
+            saveToFileCompiled(fileWithoutExtension);
+        } else {
+            saveToFileSource(fileWithoutExtension);
+        }
+    }
+    /**
+        Saves the compiled EcLang file (compiled at initialization or simply loaded)
+    */
+    void EcLang::saveToFileCompiled(std::string fileWithoutExtension) {
+        // Check: is this file the one loaded by the user?
         if (currentFile != 0) throw std::runtime_error("ECLANG_FATAL: Attempted to compile a dynamically included file");
         // Check: is the name valid?
         if (fileWithoutExtension == "") fileWithoutExtension = includedFilenames[0];
@@ -880,17 +1498,23 @@ namespace eclang {
         Returns the Object objects from the current file as a vector.
         The Objects allow us to access all the data with a simple interface
     */
-    std::vector<Object*> EcLang::getAllObjects() {
+    const std::vector<Object*>& EcLang::getAllObjects() {
         return objects;
     }
     /**
         Returns the Object objects with the class name specified
         from the current file as a vector.
     */
-    std::vector<Object*> EcLang::getObjectsByClass(std::string className) {
+    std::vector<Object*> EcLang::getObjectsByClass(std::string_view className) {
         std::vector<Object*> objsWithClass;
+        // Names are interned: if the class is not in the table no object uses it,
+        // and if it is we only have to compare pointers
+        const std::string* handle = strings->find(className);
+        if (handle == nullptr) {
+            return objsWithClass;
+        }
         for (Object* o : objects) {
-            if (o->getClassName() == className) {
+            if (o->_getClassHandle() == handle) {
                 objsWithClass.push_back(o);
             }
         }
@@ -900,27 +1524,134 @@ namespace eclang {
         Returns the Object object with the name specified.
         The pointer returned may be nullptr.
     */
-    Object* EcLang::getObject(std::string name) {
+    Object* EcLang::getObject(std::string_view name) {
         // Is this a path?
         size_t indexOfSlash = name.find_first_of('/');
-        if (indexOfSlash != std::string::npos) {
-            std::string firstNode = name.substr(0, indexOfSlash);
+        if (indexOfSlash != std::string_view::npos) {
+            const std::string* firstNode = strings->find(name.substr(0, indexOfSlash));
+            if (firstNode == nullptr) {
+                return nullptr;
+            }
             for (Object* o : objects) {
-                if (o->getName() == firstNode) {
-                    // Get Node by path from Object (This is recursive)
+                if (o->_getNameHandle() == firstNode) {
+                    // Get Node by path from Object
                     return o->getObject(name.substr(indexOfSlash+1));
                 }
             }
         } else {
             // This is not a path, just a single node
+            const std::string* node = strings->find(name);
+            if (node == nullptr) {
+                return nullptr;
+            }
             for (Object* o : objects) {
-                if (o->getName() == name) {
+                if (o->_getNameHandle() == node) {
                     return o;
                 }
             }
         }
         return nullptr;
     }
+    /**
+        Returns the number of objects with the class name specified in the
+        whole hierarchy (not only the root).
+    */
+    size_t EcLang::countObjectsByClass(std::string_view className) {
+        size_t count = 0;
+        const std::string* handle = strings->find(className);
+        if (handle == nullptr) {
+            return count;
+        }
+        traversal::walk(objects,
+            [&](traversal::Step& step) -> uint8_t {
+                if (step.object->_getClassHandle() == handle) {
+                    count++;
+                }
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [](traversal::Step&) {}
+        );
+        return count;
+    }
+    /**
+        Writes the values of the attributes specified for every object with the
+        class name specified into the buffers provided by the caller.
+        Returns the number of objects exported.
+    */
+    size_t EcLang::exportAttributes(std::string_view className, std::vector<AttributeExport>& exports) {
+        // Check the attributes before writing anything
+        std::vector<type::Type> types;
+        for (AttributeExport& e : exports) {
+            type::Type type = language->getAttributeType(className, e.attribute);
+            if (type::sizeOf(type) == 0) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't export attribute \""+e.attribute+"\" of class \""+std::string(className)+"\". Only numbers and vectors can be exported.");
+            }
+            if (e.buffer == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't export attribute \""+e.attribute+"\" of class \""+std::string(className)+"\". No buffer was specified.");
+            }
+            types.push_back(type);
+        }
+
+        // Collect all the objects of this class once (same order as countObjectsByClass())
+        std::vector<Object*> matching;
+        const std::string* handle = strings->find(className);
+        traversal::walk(objects,
+            [&](traversal::Step& step) -> uint8_t {
+                if (step.object->_getClassHandle() == handle) {
+                    matching.push_back(step.object);
+                }
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [](traversal::Step&) {}
+        );
+
+        // One pass per attribute
+        for (size_t e = 0; e < exports.size(); e++) {
+            AttributeExport& attributeExport = exports[e];
+            const size_t size = type::sizeOf(types[e]);
+            const size_t stride = attributeExport.stride == 0 ? size : attributeExport.stride;
+            uint8_t* buffer = static_cast<uint8_t*>(attributeExport.buffer);
+            attributeExport.presence.assign((matching.size() + 7) / 8, 0);
+            Attribute* defaultAttribute = language->getAttributeDefault(className, attributeExport.attribute);
+            const uint8_t* defaultValue = defaultAttribute != nullptr ? static_cast<const uint8_t*>(defaultAttribute->getRawValue()) : nullptr;
+
+            switch (size) {
+            case 1:  exportAttributeValues<1>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 2:  exportAttributeValues<2>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 4:  exportAttributeValues<4>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 8:  exportAttributeValues<8>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 12: exportAttributeValues<12>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 16: exportAttributeValues<16>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 24: exportAttributeValues<24>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            case 32: exportAttributeValues<32>(matching, attributeExport.attribute, types[e], defaultValue, buffer, stride, attributeExport.presence); break;
+            default:
+                throw std::runtime_error("ECLANG_FATAL: Internal error at `exportAttributes()`. Unexpected size ("+std::to_string(size)+")");
+            }
+        }
+
+        return matching.size();
+    }
+    /**
+        When enabled, destroying this EcLang object doesn't delete its Objects in
+        the calling thread. They're handed to a background thread that deletes them.
+    */
+    void EcLang::setBackgroundRelease(bool enabled) {
+        backgroundRelease = enabled;
+    }
+    /**
+        Sets the options used by saveToFileCompiled() (and saveToFile() for
+        source files) from now on.
+    */
+    void EcLang::setCompileOptions(CompileOptions options) {
+        compileOptions = std::move(options);
+    }
+    /**
+        Blocks until all the Objects of the EcLang objects destroyed with
+        background release enabled are deleted.
+    */
+    void EcLang::waitForBackgroundRelease() {
+        release::waitForBackgroundDeletes();
+    }
     // FOR USE IN ANOTHER ECLANG (Private, moved up here to keep it close to getAllObjects)
     /**
         Returns the Object objects from the current file as a vector.
@@ -944,6 +1675,25 @@ namespace eclang {
     // PRIVATE
     // -------
 
+    /**
+        Deletes the Objects of this EcLang object (in a background thread if
+        background release is enabled), unless another EcLang included them
+    */
+    void EcLang::releaseObjects() {
+        // We should only delete our objects if this file was not included by another file
+        if (isIncluded) { return; }
+        // Let the background thread do the work
+        if (backgroundRelease) {
+            release::deleteInBackground(std::move(objects));
+            objects.clear();
+            return;
+        }
+        for (Object* o : objects) {
+            delete o;
+        }
+        objects.clear();
+    }
+
     /**
         For both constructors, a void* of data and a size are obtained
         and passed to this function. This function figures out the type of
@@ -955,8 +1705,8 @@ namespace eclang {
     void EcLang::initializeEcLang(void* dataRaw, size_t size) {
         // Pass void* to uint8_t to make working with raw data easier
         uint8_t* data = (uint8_t*)dataRaw;
-        // Pass dataRaw to String to make working with source files easier. Only used if actually working with strings
-        std::string dataString((char*)dataRaw, size);
+        // View of the data as a String to make working with source files easier. Only copied if this is a source file
+        std::string_view dataString((char*)dataRaw, size);
 
         // Get all languages
         std::vector<Language>& languages = config::getLanguages();
@@ -970,33 +1720,14 @@ namespace eclang {
         // specified in our configuration
         bool languageFound = false;
         bool isBinary = true; // set to binary by default; arbitrary
-        for (Language& languageChecking : languages) {
-            std::vector<uint8_t> identifierBytes = languageChecking.getIdentifierBytes();
-            uint8_t numberOfBytes = identifierBytes.size();
-            bool found = true;
-
-            // If any of the bytes is not the found in our data,
-            // set found to false and break
-            // TODO: Extract bytes from file until we find NULL (0) and compare the sequences instead of comparing directly
-            for (uint8_t i = 0; i < numberOfBytes; i++) {
-                if (data[i] != identifierBytes.at(i)) {
-                    found = false;
-                    break;
-                }
-            }
-
-            // If found is still true we set our Language to languageChecking and break
-            if (found) {
-                language = &languageChecking;
-                languageFound = true;
-                isBinary = true;
-                // Log to console
-                #ifdef ECLANG_DEBUG
-                    std::cout << "ECLANG_LOG: File identified as a binary file compiled with the language \""+language->getName()+"\".\n";
-                #endif
-                // break
-                break;
-            }
+        language = findCompiledLanguage(data, size);
+        if (language != nullptr) {
+            languageFound = true;
+            isBinary = true;
+            // Log to console
+            #ifdef ECLANG_DEBUG
+                std::cout << "ECLANG_LOG: File identified as a binary file compiled with the language \""+language->getName()+"\".\n";
+            #endif
         }
         // Check if we found the language; if we didn't, try to read the #language tag
         if (!languageFound) {
@@ -1005,7 +1736,7 @@ namespace eclang {
             if (newlineIndex == std::string::npos) {
                 newlineIndex = dataString.length();
             }
-            std::string line = string::trim(dataString.substr(0, newlineIndex));
+            std::string line = string::trim(std::string(dataString.substr(0, newlineIndex)));
 
             // Find first instance of a space (' ')
             size_t spaceIndex = line.find_first_of(' ');
@@ -1053,20 +1784,69 @@ namespace eclang {
         fileWasSource = !isBinary;
         // Set either source or compiled depending on the file type
         // Also construct the Object objects
-        if (fileWasSource) {
-            source = dataString;
-            constructFromSource(source);
-        } else {
-            compiled.assign(data, data + size);
-            constructFromBinary(compiled);
+        // The destructor won't run if the file is invalid so we delete
+        // the objects created before the error
+        try {
+            if (fileWasSource) {
+                source = std::string(dataString);
+                constructFromSource(source);
+            } else {
+                constructFromBinary(data, size);
+            }
+        } catch (...) {
+            if (!isIncluded) {
+                for (Object* o : objects) {
+                    delete o;
+                }
+            }
+            objects.clear();
+            throw;
+        }
+    }
+    /**
+        Same as initializeEcLang() but for files read from a stream. Compiled files
+        are decoded as they're read (see constructFromStream()). Source files are
+        read entirely and parsed.
+
+        Throws a runtime error if the language can't be determined.
+    */
+    void EcLang::initializeEcLang(format::StreamReader& reader) {
+        // The identifier bytes must be in the first chunk
+        size_t identifierSize = 0;
+        for (Language& languageChecking : config::getLanguages()) {
+            identifierSize = std::max(identifierSize, languageChecking.getIdentifierBytes().size());
+        }
+        size_t available;
+        const uint8_t* data = reader.window(identifierSize, available);
+        language = findCompiledLanguage(data, available);
+        if (language == nullptr) {
+            std::vector<uint8_t> file;
+            reader.readToEnd(file);
+            initializeEcLang(file.data(), file.size());
+            return;
+        }
+        #ifdef ECLANG_DEBUG
+            std::cout << "ECLANG_LOG: File identified as a binary file compiled with the language \""+language->getName()+"\".\n";
+        #endif
+
+        fileWasSource = false;
+        try {
+            constructFromStream(reader);
+        } catch (...) {
+            if (!isIncluded) {
+                for (Object* o : objects) {
+                    delete o;
+                }
+            }
+            objects.clear();
+            throw;
         }
     }
     /**
         Constructs all the Object objects by parsing a source file.
     */
-    void EcLang::constructFromSource(std::string source) {
-        source = source.substr(source.find_first_of('\n')+1); // remove #language tag
-        std::vector<lexer::Token> tokens = lexer::tokenizeSource(source, language);
+    void EcLang::constructFromSource(const std::string& sourceCode) {
+        std::vector<lexer::Token> tokens = lexer::tokenizeSource(sourceCode.substr(sourceCode.find_first_of('\n')+1), language); // remove #language tag
 
         #ifdef ECLANG_DEBUG
         // Print entire lexical analysis
@@ -1094,8 +1874,9 @@ namespace eclang {
                     #ifdef ECLANG_DEBUG
                     std::cout << "ECLANG_LOG: Statically including file: "+file.string+"\n";
                     #endif
-                    EcLang includedEcLang(file.string);
+                    EcLang includedEcLang(file.string, 0, strings);
                     std::vector<Object*> children = includedEcLang._getAllObjectsAsInclude();
+                    prototypes.insert(includedEcLang.prototypes.begin(), includedEcLang.prototypes.end());
                     // Add to current object in scope OR simply add to root
                     if (scope.empty()) {
                         objects.insert(objects.end(), children.begin(), children.end());
@@ -1128,7 +1909,7 @@ namespace eclang {
                     }
                     #endif
 
-                    EcLang includedEcLang(file.string, includedFile);
+                    EcLang includedEcLang(file.string, includedFile, strings);
                     
                     // We only have to do this is the file included by the user. We register the path
                     // so that the file ID actually points to something lol
@@ -1165,8 +1946,9 @@ namespace eclang {
                         #ifdef ECLANG_DEBUG
                         std::cout << "ECLANG_LOG: Statically including Template file: "+file.string+"\n";
                         #endif
-                        EcLang includedEcLang(file.string);
+                        EcLang includedEcLang(file.string, 0, strings);
                         std::vector<Object*> children = includedEcLang._getAllObjectsAsInclude();
+                        prototypes.insert(includedEcLang.prototypes.begin(), includedEcLang.prototypes.end());
                         externalTemplateNode = includedEcLang._getTemplateNodePath();
                         // Add to current object in scope OR simply add to root
                         if (scope.empty()) {
@@ -1217,7 +1999,7 @@ namespace eclang {
                     }
                     #endif
 
-                    EcLang includedEcLang(file.string, includedFile);
+                    EcLang includedEcLang(file.string, includedFile, strings);
                     
                     // We only have to do this is the file included by the user. We register the path
                     // so that the file ID actually points to something.
@@ -1261,6 +2043,52 @@ namespace eclang {
                     // Update current
                     current += 2;
                 }
+                // INSTANCE
+                else if (t.string == "#instance") {
+                    const lexer::Token& path = tokens.at(current+1); // This should be a String
+                    const lexer::Token& identifier = tokens.at(current+2);
+                    const lexer::Token& terminator = tokens.at(current+3); // again, semicolon or enter scope
+                    if (path.type != lexer::type::STRING) {
+                        hasErrors = true;
+                        std::cerr << "ECLANG_ERROR: Unexpected token \""+path.string+"\" at column "+std::to_string(path.column)+" at line "+std::to_string(path.line)+". Usage: #instance <prototype:String> <name>; or #instance <prototype:String> <name> {}\n";
+                        break;
+                    }
+                    if (identifier.type != lexer::type::IDENTIFIER) {
+                        hasErrors = true;
+                        std::cerr << "ECLANG_ERROR: Unexpected token \""+identifier.string+"\" at column "+std::to_string(identifier.column)+" at line "+std::to_string(identifier.line)+". Usage: #instance <prototype:String> <name>; or #instance <prototype:String> <name> {}\n";
+                        break;
+                    }
+                    if (terminator.type != lexer::type::SEMICOLON && terminator.type != lexer::type::SCOPE_ENTER) {
+                        hasErrors = true;
+                        std::cerr << "ECLANG_ERROR: Unexpected token \""+terminator.string+"\" at column "+std::to_string(terminator.column)+" at line "+std::to_string(terminator.line)+". Semicolon or curly braces were expected after Node declaration.\n";
+                        current += 3;
+                        break;
+                    }
+                    // The prototype is found by its path (node1/node2/node3) among the objects declared
+                    // or included before. The instance is a copy of it with another name
+                    Object* prototype = getObject(path.string);
+                    if (prototype == nullptr) {
+                        hasErrors = true;
+                        std::cerr << "ECLANG_ERROR: The prototype \""+path.string+"\" at column "+std::to_string(path.column)+" at line "+std::to_string(path.line)+" doesn't exist. It must be declared or included before its instances.\n";
+                        current += 3;
+                        break;
+                    }
+                    Object* o = new Object(strings->intern(prototype->getClassName()), strings->intern(identifier.string), currentFile, classDefaults(language, prototype->getClassName()));
+                    o->_instantiate(prototype);
+                    prototypes[o] = prototype;
+                    if (scope.empty()) {
+                        objects.push_back(o);
+                    } else {
+                        scope.at(scope.size()-1)->_addChild(o);
+                    }
+                    // The attributes set in its scope replace the ones of the prototype
+                    if (terminator.type == lexer::type::SCOPE_ENTER) {
+                        scope.push_back(o);
+                    }
+
+                    // Update current
+                    current += 3;
+                }
             }break;
             case lexer::type::CLASS: {
                 // CLASS should be followed by IDENTIFIER and optionally SCOPE_ENTER.
@@ -1274,7 +2102,7 @@ namespace eclang {
                     break;
                 }
                 if (terminator.type == lexer::type::SEMICOLON) {
-                    Object* o = new Object(t.string, identifier.string, currentFile);
+                    Object* o = new Object(strings->intern(t.string), strings->intern(identifier.string), currentFile, classDefaults(language, t.string));
                     // Only add to `objects` if the scope is empty
                     // If not, we add it to the latest object in the scope
                     if (scope.empty()) {
@@ -1284,7 +2112,7 @@ namespace eclang {
                     }
                 }
                 else if (terminator.type == lexer::type::SCOPE_ENTER) {
-                    Object* o = new Object(t.string, identifier.string, currentFile);
+                    Object* o = new Object(strings->intern(t.string), strings->intern(identifier.string), currentFile, classDefaults(language, t.string));
                     // Only add to `objects` if the scope is empty
                     // If not, we add it to the latest object in the scope
                     if (scope.empty()) {
@@ -1310,6 +2138,14 @@ namespace eclang {
                     break;
                 }
                 // If we are in a node, pass the current Object in the scope
+                // Attributes of instances replace the ones copied from their prototype
+                if (!prototypes.empty() && prototypes.count(scope.at(scope.size()-1)) > 0) {
+                    Object* instance = scope.at(scope.size()-1);
+                    Object overrides(instance->_getClassHandle(), instance->_getNameHandle(), currentFile);
+                    current += parseIdentifier(tokens, current, &overrides, language);
+                    instance->_override(overrides);
+                    break;
+                }
                 current += parseIdentifier(tokens, current, scope.at(scope.size()-1), language);
             } break;
             case lexer::type::SCOPE_EXIT:
@@ -1337,56 +2173,481 @@ namespace eclang {
         #ifdef ECLANG_DEBUG
         // Prints the tree and some info
         // std::cout << "-------------------------------------------------\n";
-        // debugObjectsRecursive(objects);
+        // debugObjects(objects);
         // std::cout << "-------------------------------------------------\n";
         #endif
     }
     /**
         Constructs all the Object objects by reading a binary file.
+        Both legacy files (only instructions) and version 2 files (see util/binaryFormat.hpp)
+        can be read.
     */
-    void EcLang::constructFromBinary(std::vector<uint8_t> compiled) {
-        // Remove language bytes
-        // We remove the (number of identifier bytes + 0 (null termination)) first bytes
-        compiled.erase(compiled.begin(), compiled.begin()+language->getIdentifierBytes().size()+1);
+    void EcLang::constructFromBinary(const uint8_t* binary, size_t size) {
+        // Skip the identifier bytes and their NULL termination
+        const size_t start = language->getIdentifierBytes().size()+1;
+
+        // Compressed files contain a normal version 2 file
+        if (format::isCompressed(binary, size, start)) {
+            std::vector<uint8_t> decompressed = format::decompressContainer(binary, size, start);
+            constructFromBinary(decompressed.data(), decompressed.size());
+            return;
+        }
 
-        // Current Class ID
-        uint8_t classID = 0;
+        // Legacy files only contain the instructions
+        if (!format::isVersioned(binary, size, start)) {
+            format::NodeCounts counts;
+            decodeBuffer(binary, std::min(start, size), size, counts, format::Encoding());
+            return;
+        }
+
+        format::Container container = format::readContainer(binary, size, start);
+        checkFingerprint(container.header);
 
-        for (size_t i = 0; i < compiled.size(); i++) {
-            // 7 types of instructions
-            switch (compiled.at(i)) {
+        // The node table tells us how many children every node has, so every
+        // list of objects is allocated only once
+        std::vector<format::NodeEntry> nodes = format::readNodes(binary, *container.find(format::section::NODES), container.header.nodeCount);
+        format::NodeCounts counts;
+        readNodeTable(nodes, counts);
+
+        const format::SectionEntry* data = container.find(format::section::DATA);
+        size_t created = decodeBuffer(binary, data->offset, data->offset + data->size, counts, format::readEncoding(binary, container), nodes.size());
+        if (created != nodes.size()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The NODES section doesn't match the instructions.");
+        }
+    }
+    /**
+        Constructs all the Object objects by reading a compiled file from a stream.
+        The reader must be at the start of the file. Only what's needed to decode the
+        instructions is kept in memory: the string and quantization tables (if the file
+        has them) and the chunk of instructions being read.
+
+        Instructions are decoded as they arrive if the file doesn't have those tables
+        or if they come before them. Otherwise the DATA section is kept until the
+        tables arrive. It's also kept if the file is DEDUPLICATED (or has INSTANCES)
+        and the LoadOptions filter classes, as the objects filtered out may be read
+        again for a CLONE (or INSTANCE) instruction. Compressed files are read entirely
+        and decompressed.
+    */
+    void EcLang::constructFromStream(format::StreamReader& reader) {
+        const std::vector<uint8_t>& identifierBytes = language->getIdentifierBytes();
+        reader.skip(identifierBytes.size()+1);
+
+        // Legacy files only contain the instructions
+        if (reader.atEnd() || reader.peek() != format::FORMAT_MARKER) {
+            decodeInstructions(reader, format::NodeCounts(), format::Encoding());
+            return;
+        }
+
+        // Compressed files are decompressed as a whole
+        size_t available;
+        const uint8_t* header = reader.window(format::HEADER_SIZE, available);
+        if (available >= 4 && (format::getU16(header + 2) & format::flag::COMPRESSED)) {
+            std::vector<uint8_t> file(identifierBytes.begin(), identifierBytes.end());
+            file.push_back(0);
+            reader.readToEnd(file);
+            constructFromBinary(file.data(), file.size());
+            return;
+        }
+
+        // Header and section table
+        if (available < format::HEADER_SIZE) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The header is missing or incomplete.");
+        }
+        const uint32_t sectionCount = format::getU32(header + format::HEADER_SIZE - 4);
+        std::vector<uint8_t> table;
+        reader.read(table, format::HEADER_SIZE + uint64_t(sectionCount)*format::SECTION_ENTRY_SIZE);
+        format::Container container = format::readContainer(table.data(), table.size(), 0, UINT64_MAX);
+        checkFingerprint(container.header);
+
+        // Sections are read in the order they're stored
+        std::vector<format::SectionEntry> sections = container.sections;
+        std::sort(sections.begin(), sections.end(), [](const format::SectionEntry& a, const format::SectionEntry& b) {
+            return a.offset < b.offset || (a.offset == b.offset && a.size < b.size);
+        });
+        format::Encoding encoding;
+        encoding.flags = container.header.flags;
+        std::vector<uint8_t> stringData;
+        bool stringsRead = !(encoding.flags & format::flag::STRING_TABLE);
+        bool quantizedRead = !(encoding.flags & format::flag::QUANTIZED);
+        // Node table (only used if it comes before the instructions)
+        format::NodeCounts counts;
+        // Instructions kept until the tables arrive (and their position in the file)
+        std::vector<uint8_t> code;
+        uint64_t codeOffset = 0;
+        bool codeRead = false;
+        size_t created = 0;
+
+        for (const format::SectionEntry& section : sections) {
+            if (codeRead && stringsRead && quantizedRead) {
+                break;
+            }
+            const bool needed = section.type == format::section::DATA
+                || (section.type == format::section::STRINGS && !stringsRead)
+                || (section.type == format::section::QUANTIZATION && !quantizedRead)
+                || (section.type == format::section::NODES && !codeRead);
+            if (!needed) {
+                continue;
+            }
+            if (section.offset < reader.position()) {
+                if (section.size > 0) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Section "+std::to_string(section.type)+" overlaps another section.");
+                }
+            } else {
+                reader.skip(section.offset - reader.position());
+            }
+
+            switch (section.type) {
+            case format::section::STRINGS: {
+                reader.read(stringData, section.size);
+                encoding.strings = format::readStrings(stringData.data(), stringData.size(), container.header.stringCount);
+                stringsRead = true;
+                break;
+            }
+            case format::section::QUANTIZATION: {
+                std::vector<uint8_t> quantizedData;
+                reader.read(quantizedData, section.size);
+                encoding.quantized = format::readQuantized(quantizedData.data(), quantizedData.size());
+                quantizedRead = true;
+                break;
+            }
+            case format::section::NODES: {
+                std::vector<uint8_t> nodeData;
+                reader.read(nodeData, section.size);
+                readNodeTable(format::readNodes(nodeData.data(), {section.type, 0, section.size}, container.header.nodeCount), counts);
+                break;
+            }
+            case format::section::DATA: {
+                if (!stringsRead || !quantizedRead || ((encoding.flags & (format::flag::DEDUPLICATED | format::flag::INSTANCES)) && !loadOptions.classes.empty())) {
+                    reader.read(code, section.size);
+                    codeOffset = section.offset;
+                } else {
+                    encoding.codeBegin = section.offset;
+                    encoding.codeEnd = section.offset + section.size;
+                    reader.setEnd(section.offset + section.size);
+                    created = decodeInstructions(reader, counts, encoding, container.header.nodeCount);
+                    reader.setEnd(format::UNKNOWN_END);
+                }
+                codeRead = true;
+                break;
+            }
+            }
+        }
+
+        if (!stringsRead) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The STRINGS section is missing.");
+        }
+        if (!quantizedRead) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The QUANTIZATION section is missing.");
+        }
+        if (!code.empty()) {
+            encoding.fileOffset = codeOffset;
+            encoding.code = code.data();
+            encoding.codeBegin = 0;
+            encoding.codeEnd = code.size();
+            created = decodeBuffer(code.data(), 0, code.size(), counts, encoding, container.header.nodeCount);
+        }
+        if (created != container.header.nodeCount) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The NODES section doesn't match the instructions.");
+        }
+    }
+    /**
+        Throws a runtime error if the file wasn't compiled with the version of the
+        language we have
+    */
+    void EcLang::checkFingerprint(const format::Header& header) {
+        if (header.fingerprint != language->getFingerprint()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. It was compiled with a different version of the language \""+language->getName()+"\". Compile it again from its source file.");
+        }
+    }
+    /**
+        Reads the number of children of every node from the node table and, if
+        the LoadOptions filter classes, the size of their subtrees.
+        Throws a runtime error if a parent is not in the table.
+    */
+    void EcLang::readNodeTable(const std::vector<format::NodeEntry>& nodes, format::NodeCounts& counts) {
+        counts.children.assign(nodes.size(), 0);
+        size_t rootCount = 0;
+        for (const format::NodeEntry& node : nodes) {
+            if (node.parent == format::NO_PARENT) {
+                rootCount++;
+            } else if (node.parent < nodes.size()) {
+                counts.children[node.parent]++;
+            } else {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The NODES section is corrupted.");
+            }
+        }
+        objects.reserve(rootCount);
+        // Filtered out subtrees are jumped over using their sizes
+        if (!loadOptions.classes.empty()) {
+            counts.subtrees.reserve(nodes.size());
+            for (const format::NodeEntry& node : nodes) {
+                counts.subtrees.push_back(node.subtreeSize);
+            }
+        }
+    }
+    /**
+        Runs the instructions between `begin` and `end` of a buffer.
+
+        Returns the number of objects read (created or filtered out), which can't be
+        more than `maxObjects` (see decodeInstructions()).
+    */
+    size_t EcLang::decodeBuffer(const uint8_t* data, size_t begin, size_t end, format::NodeCounts& counts, const format::Encoding& encoding, size_t maxObjects) {
+        format::BufferReader reader(data, begin, end);
+        return decodeInstructions(reader, counts, encoding, maxObjects);
+    }
+    /**
+        Runs the instructions left in the reader (see util/byteReader.hpp), creating the Object objects.
+        The NodeCounts may contain the number of children of every object to allocate
+        their lists once, and the number of nodes in the subtree of every object, so
+        that the subtrees filtered out by the LoadOptions can be jumped over without reading them.
+
+        Returns the number of objects read (created or filtered out). CLONE instructions can't
+        read more than `maxObjects` (or the number of objects of the NodeCounts, if they have it),
+        so a corrupted file can't make them copy the same objects over and over. `cloneDepth`
+        is the number of CLONE instructions whose children are being read again.
+    */
+    template<class Reader>
+    size_t EcLang::decodeInstructions(Reader& reader, const format::NodeCounts& counts, const format::Encoding& encoding, size_t maxObjects, uint32_t cloneDepth) {
+        // Object created by the last CREATE instruction (used by SCOPE_ENTER)
+        Object* lastCreated = nullptr;
+        size_t created = 0;
+        // Object whose attributes are being read and the ID of its class.
+        // Attributes are always stored together, so we only look for the class ID once
+        Object* attributeOwner = nullptr;
+        uint8_t classID = 0;
+        // Position of the SCOPE_EXIT of every open scope (files with sized scopes)
+        std::vector<size_t> scopeExits;
+
+        // What the LoadOptions allow (empty if everything is loaded) and the attributes
+        // allowed for the class of `filteredOwner` (nullptr if they're all allowed)
+        std::unordered_set<std::string> loadedClasses(loadOptions.classes.begin(), loadOptions.classes.end());
+        std::unordered_map<std::string, std::unordered_set<std::string>> loadedAttributes;
+        for (const auto& [className, attributes] : loadOptions.attributes) {
+            loadedAttributes.emplace(className, std::unordered_set<std::string>(attributes.begin(), attributes.end()));
+        }
+        Object* filteredOwner = nullptr;
+        const std::unordered_set<std::string>* allowedAttributes = nullptr;
+        // Returns the object in scope, which gets the attributes read next
+        auto attributeTarget = [&]() {
+            if (scope.empty()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Attribute found outside of an object.");
+            }
+            Object* owner = scope.at(scope.size()-1);
+            if (owner != filteredOwner && !loadedAttributes.empty()) {
+                filteredOwner = owner;
+                auto allowed = loadedAttributes.find(owner->getClassName());
+                allowedAttributes = allowed == loadedAttributes.end() ? nullptr : &allowed->second;
+            }
+            return owner;
+        };
+        AttributeTypes attributeTypes(language);
+        ClassHandles classHandles(language, *strings);
+        // Attributes read for the object in scope, added together when the next instruction
+        // isn't an attribute so that its list of attributes is allocated once. The ones
+        // that weren't added are deleted if the file is invalid
+        struct PendingAttributes {
+            Object* owner = nullptr;
+            std::vector<Attribute*> attributes;
+            ~PendingAttributes() {
+                for (Attribute* a : attributes) {
+                    delete a;
+                }
+            }
+        } pending;
+        auto addPendingAttributes = [&]() {
+            if (!pending.attributes.empty()) {
+                pending.owner->_addAttributes(pending.attributes);
+                pending.attributes.clear();
+            }
+        };
+        auto addAttribute = [&](Object* owner, Attribute* a) {
+            if (owner != pending.owner) {
+                addPendingAttributes();
+                pending.owner = owner;
+            }
+            pending.attributes.push_back(a);
+        };
+        // Previous values of the attributes in every open scope (DELTA)
+        const bool deltaValues = encoding.flags & format::flag::DELTA;
+        format::DeltaContext deltas(encoding.previous);
+
+        // Children read (DEDUPLICATED), by the position of their first instruction in DATA, so that
+        // CLONE copies them instead of reading them again. They're kept when their scope is closed.
+        // Objects read (INSTANCES) are kept the same way by the position of their CREATE, so that
+        // INSTANCE copies its prototype
+        const bool deduplicated = encoding.flags & format::flag::DEDUPLICATED;
+        const bool instanced = encoding.flags & format::flag::INSTANCES;
+        constexpr size_t NO_CHILDREN = SIZE_MAX;
+        struct OpenScope {
+            Object* owner;
+            size_t position; // Position of the CREATE of the owner
+            size_t index; // Objects read before the owner
+            size_t begin; // Position of the first child (NO_CHILDREN until there's one)
+            size_t created; // Objects read before the first child
+        };
+        struct ReadObjects {
+            Object* owner;
+            uint64_t size;
+            size_t objects;
+        };
+        std::vector<OpenScope> openScopes;
+        std::unordered_map<uint64_t, ReadObjects> readChildren;
+        std::unordered_map<uint64_t, ReadObjects> readObjects;
+        size_t lastCreatedPosition = 0;
+        size_t lastCreatedIndex = 0;
+        // Called for every instruction that can start the children of the object in scope
+        auto childrenStart = [&](size_t position) {
+            if (deduplicated && !openScopes.empty() && openScopes.back().begin == NO_CHILDREN) {
+                openScopes.back().begin = position;
+                openScopes.back().created = created;
+            }
+        };
+        const size_t objectLimit = counts.children.empty() ? maxObjects : std::min(maxObjects, counts.children.size());
+        // Children run again by CLONE start a scope, so they don't have previous values (DELTA)
+        std::unique_ptr<format::Encoding> childrenEncoding;
+
+        while (!reader.atEnd()) {
+            const size_t position = reader.position();
+            const uint8_t instruction = reader.byte();
+            if (instruction != INST_ATTRIBUTE && instruction != INST_ATTRIBUTES) {
+                addPendingAttributes();
+            }
+            // 10 types of instructions
+            switch (instruction) {
             case INST_CREATE: {
+                childrenStart(position);
                 // Get Class Name
-                i++;
-                classID = compiled.at(i);
-                std::string className = language->getClassName(classID);
+                const uint8_t id = reader.byte();
+                const std::string* className;
+                const std::shared_ptr<ClassDefaults>* defaults = nullptr;
+                if (id == INST_ATTR_CUSTOM) {
+                    // Custom class (not registered in the language). The name is stored as a STRING
+                    // and stored in the table before reading anything else
+                    className = strings->intern(readString(reader, encoding));
+                } else {
+                    className = classHandles.name(id);
+                    defaults = &classHandles.defaultsOf(id);
+                }
                 // Get Object Name
-                i++;
-                std::string objectName = decompileString(compiled, i).substr(1); // Remove prefix
+                std::string_view objectName = readString(reader, encoding);
+                // Objects of classes that aren't loaded are skipped with their children
+                if (!loadedClasses.empty() && loadedClasses.count(*className) == 0) {
+                    uint32_t subtreeSize = created < counts.subtrees.size() ? counts.subtrees[created] : 0;
+                    uint32_t skippedClass = language->classExists(*className) ? language->getClassID(*className) : INST_ATTR_CUSTOM;
+                    created += skipObject(reader, skippedClass, subtreeSize, language, encoding);
+                    break;
+                }
                 // Create
-                objects.push_back(new Object(className, objectName, currentFile));
+                Object* o = new Object(className, strings->intern(objectName), currentFile, defaults != nullptr ? *defaults : nullptr);
+                if (created < counts.children.size()) {
+                    o->_reserveChildren(counts.children[created]);
+                }
+                // Only add to `objects` if the scope is empty
+                // If not, we add it to the latest object in the scope
+                if (scope.empty()) {
+                    objects.push_back(o);
+                } else {
+                    scope.at(scope.size()-1)->_addChild(o);
+                }
+                lastCreated = o;
+                lastCreatedPosition = position;
+                lastCreatedIndex = created;
+                created++;
                 break;
             }
             case INST_ATTRIBUTE: {
-                i++;
-                Attribute* attribute = createAttributeFromBinary(compiled, i, classID, language);
+                const uint8_t id = reader.byte();
+                Object* owner = attributeTarget();
+                // Custom attributes store their name and value as STRINGs
+                if (id == INST_ATTR_CUSTOM) {
+                    std::string attributeName(readString(reader, encoding));
+                    std::string value(readString(reader, encoding));
+                    if (allowedAttributes == nullptr || allowedAttributes->count(attributeName) > 0) {
+                        addAttribute(owner, new Attribute(std::move(attributeName), std::move(value), type::STRING));
+                    }
+                    break;
+                }
+                if (owner != attributeOwner) {
+                    attributeOwner = owner;
+                    classID = classHandles.id(owner->_getClassHandle());
+                }
+                // Attributes that aren't loaded are skipped using the size of their type
+                if (allowedAttributes != nullptr && allowedAttributes->count(language->getAttributeName(classID, id)) == 0) {
+                    const type::Type type = attributeTypes.get(classID, id);
+                    skipAttributeValue(reader, type, encoding, findQuantized(encoding, classID, id, type));
+                    break;
+                }
+                addAttribute(owner, createAttributeFromBinary(reader, classID, id, language, encoding, deltaValues ? deltas.previous(classID, id) : nullptr));
+                break;
+            }
+            case INST_ATTRIBUTES: {
+                Object* owner = attributeTarget();
+                if (owner != attributeOwner) {
+                    attributeOwner = owner;
+                    classID = classHandles.id(owner->_getClassHandle());
+                }
+                // The values of the attributes set in the bitmap follow it in order of ID
+                const std::vector<type::Type>& types = attributeTypes.of(classID);
+                uint8_t bitmap[format::MAX_BITMAP_SIZE];
+                forEachBit(bitmap, readAttributeBitmap(reader, types.size(), bitmap), [&](uint8_t id) {
+                    if (allowedAttributes != nullptr && allowedAttributes->count(language->getAttributeName(classID, id)) == 0) {
+                        skipAttributeValue(reader, types[id], encoding, findQuantized(encoding, classID, id, types[id]));
+                        return;
+                    }
+                    addAttribute(owner, createAttributeFromBinary(reader, classID, id, language, encoding, deltaValues ? deltas.previous(classID, id) : nullptr));
+                });
                 break;
             }
             case INST_SCOPE_ENTER: {
-                // Get last object saved and put it in scope
-                if (objects.empty()) { break; }
-                scope.push_back(objects.at(objects.size()-1));
+                // Check that the size of the scope is right so that readers can trust it
+                if (encoding.flags & format::flag::SIZED_SCOPES) {
+                    if (reader.remaining() < format::SCOPE_SIZE_SIZE) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+                    }
+                    uint32_t scopeSize = format::getU32(reader.bytes(format::SCOPE_SIZE_SIZE));
+                    if (scopeSize == 0 || scopeSize > reader.remaining()) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is out of bounds.");
+                    }
+                    scopeExits.push_back(reader.position() + scopeSize - 1);
+                }
+                if (deltaValues) {
+                    deltas.enterScope();
+                }
+                if (deduplicated || instanced) {
+                    openScopes.push_back({lastCreated, lastCreatedPosition, lastCreatedIndex, NO_CHILDREN, 0});
+                }
+                // Put the last object created in scope
+                if (lastCreated == nullptr) { break; }
+                scope.push_back(lastCreated);
                 break;
             }
             case INST_SCOPE_EXIT: {
+                if (encoding.flags & format::flag::SIZED_SCOPES) {
+                    if (scopeExits.empty() || scopeExits.back() != position) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The size of a scope doesn't match its contents.");
+                    }
+                    scopeExits.pop_back();
+                }
+                if (deltaValues) {
+                    deltas.exitScope();
+                }
+                if ((deduplicated || instanced) && !openScopes.empty()) {
+                    const OpenScope open = openScopes.back();
+                    openScopes.pop_back();
+                    if (deduplicated && open.owner != nullptr && open.begin != NO_CHILDREN) {
+                        readChildren[open.begin - encoding.codeBegin] = {open.owner, position - open.begin, created - open.created};
+                    }
+                    if (instanced && open.owner != nullptr) {
+                        readObjects[open.position - encoding.codeBegin] = {open.owner, position + 1 - open.position, created - open.index};
+                    }
+                }
                 if (scope.empty()) { break; }
                 scope.pop_back();
                 break;
             }
             case INST_INCLUDE: {
                 // Get File we're including
-                i++;
-                std::string file = decompileString(compiled, i).substr(1);
+                std::string file(readString(reader, encoding));
 
                 uint8_t includedFile = (currentFile==0) ? includedFilenames.size() : currentFile;
 
@@ -1398,7 +2659,7 @@ namespace eclang {
                 }
                 #endif
 
-                EcLang includedEcLang(file, includedFile);
+                EcLang includedEcLang(file, includedFile, strings, loadOptions);
                 
                 // We only have to do this if this is the file included by the user.
                 // We register the path so that the file ID actually points to something
@@ -1415,6 +2676,7 @@ namespace eclang {
                 } else {
                     scope.at(scope.size()-1)->_addChildren(children);
                 }
+                break;
             }
             case INST_TEMPLATE: {
                 // We can't use multiple templates in the same file
@@ -1423,8 +2685,7 @@ namespace eclang {
                 }
 
                 // Get File we're including
-                i++;
-                std::string file = decompileString(compiled, i).substr(1);
+                std::string file(readString(reader, encoding));
                 
                 uint8_t includedFile = (currentFile==0) ? includedFilenames.size() : currentFile;
 
@@ -1436,7 +2697,7 @@ namespace eclang {
                 }
                 #endif
 
-                EcLang includedEcLang(file, includedFile);
+                EcLang includedEcLang(file, includedFile, strings, loadOptions);
                 
                 // Register filename
                 if (currentFile == 0) {
@@ -1454,12 +2715,112 @@ namespace eclang {
                 }
                 // Add template node to current scope (even if any of the vectors is empty)
                 scope.insert(scope.end(), externalTemplateNode.begin(), externalTemplateNode.end());
+                break;
             }
             case INST_MARK_TEMPLATE: {
                 templateNode = scope;
+                break;
             }
+            case INST_CLONE: {
+                if (!deduplicated) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unknown instruction ("+std::to_string(instruction)+") at byte "+std::to_string(position)+".");
+                }
+                childrenStart(position);
+                const Clone clone = readClone(reader);
+                if (created > objectLimit || clone.objects > objectLimit - created) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A CLONE instruction creates more objects than the file has.");
+                }
+                // Children read before are copied
+                auto found = readChildren.find(clone.offset);
+                if (found != readChildren.end() && found->second.size == clone.size && found->second.objects == clone.objects) {
+                    std::vector<Object*> copies;
+                    copies.reserve(found->second.owner->_getChildren().size());
+                    for (Object* child : found->second.owner->_getChildren()) {
+                        copies.push_back(child->_copy(currentFile));
+                    }
+                    if (scope.empty()) {
+                        objects.insert(objects.end(), copies.begin(), copies.end());
+                    } else {
+                        scope.at(scope.size()-1)->_addChildren(copies);
+                    }
+                    created += clone.objects;
+                    break;
+                }
+                // The others weren't read (the LoadOptions filtered out the object they belong to or
+                // only a part of the file is read) and are read again from the instructions before this one
+                if (encoding.code == nullptr || clone.offset > encoding.codeEnd - encoding.codeBegin || clone.size > encoding.codeEnd - encoding.codeBegin - clone.offset
+                    || encoding.codeBegin + clone.offset + clone.size > position || cloneDepth >= format::MAX_CLONE_DEPTH) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A CLONE instruction refers to instructions that can't be read.");
+                }
+                if (!encoding.previous.keys.empty() && childrenEncoding == nullptr) {
+                    childrenEncoding = std::make_unique<format::Encoding>(encoding);
+                    childrenEncoding->previous = format::DeltaScope();
+                }
+                format::BufferReader children(encoding.code, encoding.codeBegin + clone.offset, encoding.codeBegin + clone.offset + clone.size);
+                const size_t depth = scope.size();
+                if (decodeInstructions(children, format::NodeCounts(), childrenEncoding != nullptr ? *childrenEncoding : encoding, clone.objects, cloneDepth + 1) != clone.objects || scope.size() != depth) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A CLONE instruction doesn't match the instructions it refers to.");
+                }
+                created += clone.objects;
+                break;
+            }
+            case INST_INSTANCE: {
+                if (!instanced) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unknown instruction ("+std::to_string(instruction)+") at byte "+std::to_string(position)+".");
+                }
+                // The object in scope gets the attributes it doesn't set and the children of its prototype.
+                // The prototype counts itself, which isn't created again
+                const Clone prototype = readClone(reader);
+                if (prototype.objects == 0 || created > objectLimit || prototype.objects - 1 > objectLimit - created) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An INSTANCE instruction creates more objects than the file has.");
+                }
+                if (scope.empty()) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. INSTANCE found outside of an object.");
+                }
+                Object* owner = scope.at(scope.size()-1);
+                // Prototypes read before are copied
+                auto found = readObjects.find(prototype.offset);
+                if (found != readObjects.end() && found->second.size == prototype.size && found->second.objects == prototype.objects) {
+                    owner->_instantiate(found->second.owner);
+                    created += prototype.objects - 1;
+                    break;
+                }
+                // The others are read again (see CLONE) into an object that only holds them
+                if (encoding.code == nullptr || prototype.offset > encoding.codeEnd - encoding.codeBegin || prototype.size > encoding.codeEnd - encoding.codeBegin - prototype.offset
+                    || encoding.codeBegin + prototype.offset + prototype.size > position || cloneDepth >= format::MAX_CLONE_DEPTH) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An INSTANCE instruction refers to instructions that can't be read.");
+                }
+                if (!encoding.previous.keys.empty() && childrenEncoding == nullptr) {
+                    childrenEncoding = std::make_unique<format::Encoding>(encoding);
+                    childrenEncoding->previous = format::DeltaScope();
+                }
+                format::BufferReader instructions(encoding.code, encoding.codeBegin + prototype.offset, encoding.codeBegin + prototype.offset + prototype.size);
+                Object holder(owner->_getClassHandle(), owner->_getNameHandle(), currentFile);
+                const std::vector<Object*> templates = templateNode;
+                const std::vector<Object*> externalTemplates = externalTemplateNode;
+                scope.push_back(&holder);
+                const size_t depth = scope.size();
+                const size_t read = decodeInstructions(instructions, format::NodeCounts(), childrenEncoding != nullptr ? *childrenEncoding : encoding, prototype.objects, cloneDepth + 1);
+                const bool matches = read == prototype.objects && scope.size() == depth && holder._getChildren().size() == 1
+                    && templateNode == templates && externalTemplateNode == externalTemplates;
+                scope.resize(depth - 1);
+                if (!matches) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. An INSTANCE instruction doesn't match the instructions it refers to.");
+                }
+                owner->_instantiate(holder._getChildren().front());
+                created += prototype.objects - 1;
+                break;
+            }
+            default:
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unknown instruction ("+std::to_string(instruction)+") at byte "+std::to_string(position)+".");
             }
         }
+        addPendingAttributes();
+        if (!scopeExits.empty()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. A scope is not closed.");
+        }
+
+        return created;
     }
 
     /**
@@ -1468,7 +2829,8 @@ namespace eclang {
         This method is called when calling saveToFileCompiled() if the file is a source file.
 
         WHAT IT DOES
-        1. Save Identifier Bytes for the language and NULL-terminate
+        1. Save Identifier Bytes for the language and NULL-terminate, followed by the header
+            and section table of a version 2 file (see util/binaryFormat.hpp)
 
         2. For each object in the array, check what file it belongs to. Is the File ID 0?
             T: Then this object is part of this file or was statically included
@@ -1498,6 +2860,9 @@ namespace eclang {
                 2.F.3. Continue consuming objects until we see that the next object has a different file ID.
                 2.F.4. When we find a different file ID we stop consuming. Continue.
 
+        3. While doing [2], register every object in the node table and every [INCLUDE]
+            and [TEMPLATE] instruction in the include table. The instructions go in the DATA section.
+
 
         INSTRUCTIONS
         - INST_CREATE:        [0x00] - Takes the Language-specific Class ID (or 255 and then a STRING with the Class Name) and the name as a STRING as parameter.
@@ -1507,6 +2872,9 @@ namespace eclang {
         - INST_INCLUDE:       [0x04] - Takes STRING with the file name or alias. Represents a Dynamic Include (`include-dyn`)
         - INST_TEMPLATE:      [0x05] - Takes STRING with the file name or alias. Represents a Dynamic Template (`template-dyn`)
         - INST_MARK_TEMPLATE: [0x06] - Takes nothing. Marks the current node as Template Node
+        - INST_ATTRIBUTES:    [0x07] - Takes a bitmap of the attributes of the class set and their values in order of ID (ATTRIBUTE_BITMAP flag)
+        - INST_CLONE:         [0x08] - Takes the position, size and number of objects of the children of an earlier object and copies them into the current scope (DEDUPLICATED flag)
+        - INST_INSTANCE:      [0x09] - Takes the position, size and number of objects of an earlier object and copies its attributes and children into the object in scope (INSTANCES flag)
         
         DATA TYPES
         The only strange one are Strings because of their variable size:
@@ -1514,18 +2882,81 @@ namespace eclang {
         - STRING_MD: Starts with a [0x01] to indicate that it's a Markdown String, then it continues until the next 0.
     */
     std::vector<uint8_t> EcLang::compile() {
-        std::vector<uint8_t> binary;
-
-        // Insert identifier bytes
-        std::vector<uint8_t> languageIdentifier = language->getIdentifierBytes();
-        binary.insert(binary.end(), languageIdentifier.begin(), languageIdentifier.end());
-        binary.push_back(uint8_t(0));
+        // Compile all objects (this function takes care of includes and templates)
+        // and get the tables of the file
+        format::Layout layout;
+        if (compileOptions.stringTable) {
+            layout.flags |= format::flag::STRING_TABLE;
+        }
+        if (compileOptions.varint) {
+            layout.flags |= format::flag::VARINT;
+        }
+        if (compileOptions.sizedScopes) {
+            layout.flags |= format::flag::SIZED_SCOPES;
+        }
+        if (compileOptions.alignedValues) {
+            if (!format::isLittleEndian()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. Aligned values are stored in little endian and this machine is big endian.");
+            }
+            layout.flags |= format::flag::ALIGNED;
+        }
+        if (compileOptions.attributeBitmaps) {
+            layout.flags |= format::flag::ATTRIBUTE_BITMAP;
+        }
+        if (compileOptions.deltaValues) {
+            layout.flags |= format::flag::DELTA;
+        }
+        if (compileOptions.deduplicate) {
+            layout.flags |= format::flag::DEDUPLICATED;
+        }
+        // Instances only store what they change from their prototypes. Differences with the
+        // previous siblings would depend on the instructions of the prototype being read again
+        if (!prototypes.empty() && !compileOptions.deltaValues) {
+            layout.flags |= format::flag::INSTANCES;
+        }
+        if (compileOptions.columns) {
+            if (!format::isLittleEndian()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. Columns are stored in little endian and this machine is big endian.");
+            }
+            layout.columns = true;
+        }
+        layout.pathIndex = compileOptions.pathIndex;
 
-        // Save all objects (this function takes care of includes and templates)
-        auto compiledObjects = compileObjects(objects);
-        binary.insert(binary.end(), compiledObjects.begin(), compiledObjects.end());
+        // Attributes stored with less precision, by ID
+        for (const auto& [className, attributes] : compileOptions.quantize) {
+            if (!language->classExists(className)) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. The class \""+className+"\" of an attribute to quantize isn't registered.");
+            }
+            const uint32_t classID = language->getClassID(className);
+            for (const auto& [attribute, quantization] : attributes) {
+                const std::vector<std::string>& classAttributes = language->getAttributes(classID);
+                if (std::find(classAttributes.begin(), classAttributes.end(), attribute) == classAttributes.end()) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. The attribute \""+attribute+"\" to quantize isn't registered for the class \""+className+"\".");
+                }
+                const uint8_t attributeID = language->getAttributeID(className, attribute);
+                if (format::quantizedComponents(language->getAttributeType(classID, attributeID)) == 0) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. The attribute \""+attribute+"\" of \""+className+"\" can't be quantized (only floats, doubles and their vectors can).");
+                }
+                if (quantization.format != Quantization::HALF && !(quantization.min < quantization.max)) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't compile file. The range to quantize \""+attribute+"\" of \""+className+"\" is empty.");
+                }
+                layout.quantized.push_back({classID, attributeID, uint32_t(quantization.format), quantization.min, quantization.max});
+            }
+        }
+        if (!layout.quantized.empty()) {
+            layout.flags |= format::flag::QUANTIZED;
+        }
 
-        return binary;
+        // Everything is written once into the same buffer: the instructions
+        // go right after the header and the tables after them (see util/binaryFormat.hpp)
+        std::vector<uint8_t> file;
+        size_t codeBegin = format::beginContainer(file, language->getIdentifierBytes(), layout);
+        compileObjects(file, objects, &layout);
+        format::finishContainer(file, language->getFingerprint(), layout, codeBegin);
+        if (compileOptions.compressionLevel > 0) {
+            return format::compressContainer(file, language->getIdentifierBytes().size()+1, compileOptions.compressionLevel);
+        }
+        return file;
     }
     /**
         returns a string containing the decompiled source code.
@@ -1549,34 +2980,212 @@ namespace eclang {
     // COMPILATION / DECOMPILATION HELPER FUNCTIONS
 
     /**
-        Takes a pointer to an instance of Object and returns its compiled code.
-        This function is recursive and will produce the compiled code for setting
-        the attributes, setting the template tag and creating children objects
+        Takes an array of Objects and appends their compiled code to the binary.
+        The whole tree is walked (without recursion) and this function will produce the
+        compiled code for setting the attributes, setting the template tag and creating children objects.
+        If a Layout is specified, the node, include and string tables of the compiled file are
+        written into it (offsets start where the code starts).
     */
-    std::vector<uint8_t> EcLang::compileObjects(std::vector<Object*> objects) {
-        // Create container for binary code
-        std::vector<uint8_t> binary;
+    void EcLang::compileObjects(std::vector<uint8_t>& binary, const std::vector<Object*>& objects, format::Layout* layout) {
+        // Offsets in the tables are from the first instruction
+        const size_t codeBegin = binary.size();
+        // Nodes of the layout whose scope is open (the last one is the parent of the next node)
+        std::vector<uint32_t> openNodes;
+        // Position of the size of every open scope (SIZED_SCOPES), written when the scope is closed
+        const bool sizedScopes = layout != nullptr && (layout->flags & format::flag::SIZED_SCOPES);
+        std::vector<size_t> openScopes;
+        // Values are written as differences with the previous siblings (DELTA) of every open scope
+        const bool deltaValues = layout != nullptr && (layout->flags & format::flag::DELTA);
+        // Registers an INCLUDE/TEMPLATE instruction that is about to be written
+        auto addInclude = [&](uint8_t kind, const std::string& filename) {
+            if (layout == nullptr) return;
+            layout->includes.push_back({kind, layout->addString(filename), openNodes.empty() ? format::NO_PARENT : openNodes.back(), binary.size() - codeBegin});
+        };
 
-        for (size_t i = 0; i < objects.size(); i++) {
-            Object* object = objects.at(i);
+        // Children written once and copied with CLONE instructions (DEDUPLICATED). The children of
+        // every object written are kept by the hash of the list (there may be several with the same hash)
+        const bool deduplicate = layout != nullptr && (layout->flags & format::flag::DEDUPLICATED);
+        struct WrittenChildren {
+            Object* owner;
+            uint64_t offset; // Position of their first instruction
+            uint64_t size; // Up to the SCOPE_EXIT of the owner
+            uint32_t firstNode;
+            uint32_t nodeCount;
+        };
+        std::unordered_map<Object*, SubtreeHash> hashes;
+        std::unordered_map<uint64_t, std::vector<WrittenChildren>> writtenChildren;
+        // Position of the children of every open scope (NO_CHILDREN if they aren't kept)
+        constexpr uint64_t NO_CHILDREN = UINT64_MAX;
+        std::vector<uint64_t> openChildren;
+        const std::vector<Object*> noChildren;
+        if (deduplicate) {
+            hashes = hashSubtrees(objects, templateNode.empty() ? nullptr : templateNode.back());
+        }
+        // Registers the nodes of the children of `object` (and their children) copied from
+        // the nodes starting at `firstCopied`, with the same offsets. The nodes are in the same
+        // order as the ones copied, so their parents are at the same distance from the first one
+        auto copyNodes = [&](Object* object, uint32_t nodeIndex, uint32_t firstCopied) {
+            const uint32_t firstNode = layout->nodes.size();
+            size_t copied = 0;
+            traversal::walk(object->_getChildren(),
+                [&](traversal::Step& step) {
+                    format::NodeEntry node = layout->nodes[firstCopied + copied];
+                    node.parent = node.parent == firstCopied - 1 ? nodeIndex : node.parent - firstCopied + firstNode;
+                    layout->nodes.push_back(node);
+                    layout->attributeCount += step.object->_getAttributes().size();
+                    if (layout->pathIndex) {
+                        layout->pathHashes.push_back(format::hashPath(step.object->getName(), format::hashPath("/", layout->pathHashes[node.parent])));
+                    }
+                    if (layout->columns && language->classExists(step.object->getClassName())) {
+                        compileObjectColumns(step.object, firstNode + copied, node.parent, layout);
+                    }
+                    copied++;
+                    return traversal::action::VISIT_CHILDREN;
+                },
+                [](traversal::Step&) {}
+            );
+        };
+        // Writes a CLONE instruction for the children of `object` if they were written before.
+        // Their nodes are registered with the offsets of the ones they copy
+        auto cloneChildren = [&](Object* object, uint32_t nodeIndex) {
+            const SubtreeHash& hash = hashes.at(object);
+            auto candidates = writtenChildren.find(hash.children);
+            if (candidates == writtenChildren.end()) {
+                return false;
+            }
+            for (const WrittenChildren& written : candidates->second) {
+                if (!sameChildren(written.owner, object)) {
+                    continue;
+                }
+                std::vector<uint8_t> instruction {INST_CLONE};
+                format::putVarint(instruction, written.offset);
+                format::putVarint(instruction, written.size);
+                format::putVarint(instruction, written.nodeCount);
+                if (instruction.size() >= written.size) {
+                    return false;
+                }
+                binary.insert(binary.end(), instruction.begin(), instruction.end());
+                copyNodes(object, nodeIndex, written.firstNode);
+                return true;
+            }
+            return false;
+        };
+
+        // Prototypes written (INSTANCES), so that their instances only store what they change
+        // and an INSTANCE instruction. The size is 0 until their scope is closed
+        const bool instancing = layout != nullptr && (layout->flags & format::flag::INSTANCES);
+        struct WrittenPrototype {
+            uint64_t offset; // Position of its CREATE
+            uint64_t size; // Up to its SCOPE_EXIT
+            uint32_t node;
+            uint32_t nodeCount;
+        };
+        std::unordered_map<Object*, WrittenPrototype> writtenPrototypes;
+        if (instancing) {
+            for (const auto& [instance, prototype] : prototypes) {
+                writtenPrototypes[prototype] = {0, 0, 0, 0};
+            }
+        }
+        // Prototypes and instances can't contain the Template Node, which is marked once
+        auto containsTemplate = [&](Object* object) {
+            return std::find(templateNode.begin(), templateNode.end(), object) != templateNode.end();
+        };
+        // Returns the prototype the object can be written as an instance of (nullptr if it can't)
+        // and the attributes it changes
+        auto writtenPrototype = [&](Object* object, std::vector<std::string>& own) -> const WrittenPrototype* {
+            auto prototype = prototypes.find(object);
+            if (prototype == prototypes.end()) {
+                return nullptr;
+            }
+            auto written = writtenPrototypes.find(prototype->second);
+            if (written == writtenPrototypes.end() || written->second.size == 0 || containsTemplate(object) || containsTemplate(prototype->second)
+                || object->getClassName() != prototype->second->getClassName() || !sameChildren(object, prototype->second)
+                || !instanceAttributes(object, prototype->second, own)) {
+                return nullptr;
+            }
+            return &written->second;
+        };
+
+        traversal::walk(objects,
+            [&](traversal::Step& step) -> uint8_t {
+                Object* object = step.object;
+
+                if (object->getSourceFileID() != 0) {
+                    // Templates exist and require extra code. If the file is a template we need to get its Template Node
+                    // and compile every child Node of it instead of the included nodes
+                    const uint8_t fileID = object->getSourceFileID();
+                    const std::string filenameWithType = includedFilenames.at(fileID);
+                    const std::string filename = filenameWithType.substr(1);
+
+                    // 't' for template, 'i' for include
+                    if (filenameWithType.at(0) == 't') {
+                        // Create the instruction
+                        addInclude('t', filename);
+                        binary.push_back(INST_TEMPLATE);
+                        compileString(binary, filename, false, layout);
+
+                        // We visit the children of the Template Node instead of this node's children
+                        // INFO: There can be only one Template included so it's OK (albeit a bit hacky) to just read the Temaplate Node object saved into this object
+                        // INFO: We are IGNORING all nodes that come after the Template node.
+                        // This is fine because anything below a Template inclusion goes into its Template Node
+                        step.children = &externalTemplateNode.at(externalTemplateNode.size()-1)->_getChildren();
+                        return traversal::action::VISIT_CHILDREN | traversal::action::STOP_SIBLINGS;
+                    }
+
+                    // All the consecutive nodes that come from the same included file are
+                    // replaced by a single instruction. If the previous node came from this
+                    // file, the instruction was already created
+                    if (step.index > 0 && step.siblings->at(step.index-1)->getSourceFileID() == fileID) {
+                        return traversal::action::SKIP_CHILDREN;
+                    }
+                    addInclude('i', filename);
+                    binary.push_back(INST_INCLUDE);
+                    compileString(binary, filename, false, layout);
+                    return traversal::action::SKIP_CHILDREN;
+                }
+
+                // Register the node. Its subtree size is updated when we leave it
+                uint32_t nodeIndex = 0;
+                if (layout != nullptr) {
+                    nodeIndex = layout->nodes.size();
+                    layout->nodes.push_back({binary.size() - codeBegin, openNodes.empty() ? format::NO_PARENT : openNodes.back(), 1});
+                    layout->attributeCount += object->_getAttributes().size();
+                    if (layout->pathIndex) {
+                        uint64_t parentPath = openNodes.empty() ? format::PATH_HASH_BASIS : format::hashPath("/", layout->pathHashes[openNodes.back()]);
+                        layout->pathHashes.push_back(format::hashPath(object->getName(), parentPath));
+                    }
+                    if (layout->columns && language->classExists(object->getClassName())) {
+                        compileObjectColumns(object, nodeIndex, openNodes.empty() ? format::NO_PARENT : openNodes.back(), layout);
+                    }
+                }
+
+                if (instancing) {
+                    auto prototype = writtenPrototypes.find(object);
+                    if (prototype != writtenPrototypes.end()) {
+                        prototype->second.offset = binary.size() - codeBegin;
+                        prototype->second.node = nodeIndex;
+                    }
+                }
 
-            if (object->getSourceFileID() == 0) {
                 // Insert Object Creation Instruction
-                std::vector<uint8_t> compiledObjectCreation = compileObjectCreation(object);
-                binary.insert(binary.end(), compiledObjectCreation.begin(), compiledObjectCreation.end());
+                compileObjectCreation(binary, object, layout);
 
                 // Check for children, attributes or template tag
-                auto children = object->getObjects();
-                auto attributes = object->getAttributes();
                 // We check if the last element in template node is the same as the current node, if not, this is not a template node
                 bool isTemplate = templateNode.empty() ? false : templateNode.at(templateNode.size()-1) == object;
 
                 // should we have a SCOPE_ENTER? Yes but only if the object has children, attributes or is a template node
-                bool shouldEnterScope = false;
-                if (!children.empty() || !attributes.empty() || isTemplate) {
-                    shouldEnterScope = true;
-                    // Also enter scope, we will use shouldEnterScope to see if we should close it at the end
-                    binary.push_back(INST_SCOPE_ENTER);
+                // The scope is closed in `onExit` once all the children are compiled
+                if (object->_getChildren().empty() && object->_getAttributes().empty() && !isTemplate) {
+                    return traversal::action::SKIP_CHILDREN;
+                }
+                binary.push_back(INST_SCOPE_ENTER);
+                if (sizedScopes) {
+                    openScopes.push_back(binary.size());
+                    binary.insert(binary.end(), format::SCOPE_SIZE_SIZE, 0);
+                }
+                if (deltaValues) {
+                    layout->deltas.enterScope();
                 }
 
                 // Set as Template Node
@@ -1584,265 +3193,254 @@ namespace eclang {
                     binary.push_back(INST_MARK_TEMPLATE);
                 }
 
+                // Instances of prototypes written before only have the attributes they change,
+                // followed by an INSTANCE instruction that copies the rest and the children
+                std::vector<std::string> own;
+                const WrittenPrototype* prototype = instancing && !isTemplate ? writtenPrototype(object, own) : nullptr;
+                if (prototype != nullptr) {
+                    compileObjectAttributes(binary, object, layout, &own);
+                    binary.push_back(INST_INSTANCE);
+                    format::putVarint(binary, prototype->offset);
+                    format::putVarint(binary, prototype->size);
+                    format::putVarint(binary, prototype->nodeCount);
+                    copyNodes(object, nodeIndex, prototype->node + 1);
+                    openNodes.push_back(nodeIndex);
+                    if (deduplicate) {
+                        openChildren.push_back(NO_CHILDREN);
+                    }
+                    step.children = &noChildren;
+                    return traversal::action::VISIT_CHILDREN;
+                }
+
                 // Register attributes
-                if (!attributes.empty()) {
-                    auto attributes = object->getAttributes();
-                    for (std::string attribute : attributes) {
-                        // Getting the attribute might fail if the attribute is not registered for that class
-                        // or if the class is not registered in that language. In any of those cases we save
-                        // the attribute as a custom attribute (save INST_ATTR_CUSTOM and a STRING)
-                        try {
-                            uint8_t attributeID = language->getAttributeID(object->getClassName(), attribute);
-                            // Save instruction and attribute ID
-                            binary.push_back(INST_ATTRIBUTE);
-                            binary.push_back(attributeID);
-                            // Save value (shit)
-                            // TODO: Do something with this shit (figure out a cleaner way that doesn't involve filling a switch with 23 elements by hand)
-                            uint8_t objectAttributeID = object->getIDOf(attribute);
-                            switch (language->getAttributeType(object->getClassName(), attribute)) {
-                            case type::INT8: {
-                                auto vector = numberToBytes(object->getInt8Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::INT16: {
-                                auto vector = numberToBytes(object->getInt16Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::INT32: {
-                                auto vector = numberToBytes(object->getInt32Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::INT64: {
-                                auto vector = numberToBytes(object->getInt64Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::UINT8: {
-                                auto vector = numberToBytes(object->getUint8Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::UINT16: {
-                                auto vector = numberToBytes(object->getUint16Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::UINT32: {
-                                auto vector = numberToBytes(object->getUint32Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::UINT64: {
-                                auto vector = numberToBytes(object->getUint64Of(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::FLOAT: {
-                                auto vector = numberToBytes(object->getFloatOf(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::DOUBLE: {
-                                auto vector = numberToBytes(object->getDoubleOf(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::STRING: {
-                                auto vector = compileString(object->getStringOf(objectAttributeID));
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::STR_MD: {
-                                auto vector = compileString(object->getStringOf(objectAttributeID), true);
-                                binary.insert(binary.end(), vector.begin(), vector.end());
-                            }   break;
-                            case type::VEC2I: {
-                                vec2i v = object->getVec2iOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                            }   break;
-                            case type::VEC3I: {
-                                vec3i v = object->getVec3iOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                            }   break;
-                            case type::VEC4I: {
-                                vec4i v = object->getVec4iOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                auto num4 = numberToBytes(v.w);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                                binary.insert(binary.end(), num4.begin(), num4.end());
-                            }   break;
-                            case type::VEC2L: {
-                                vec2l v = object->getVec2lOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                            }   break;
-                            case type::VEC3L: {
-                                vec3l v = object->getVec3lOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                            }   break;
-                            case type::VEC4L: {
-                                vec4l v = object->getVec4lOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                auto num4 = numberToBytes(v.w);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                                binary.insert(binary.end(), num4.begin(), num4.end());
-                            }   break;
-                            case type::VEC2F: {
-                                vec2f v = object->getVec2fOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                            }   break;
-                            case type::VEC3F: {
-                                vec3f v = object->getVec3fOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                            }   break;
-                            case type::VEC4F: {
-                                vec4f v = object->getVec4fOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                auto num4 = numberToBytes(v.w);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                                binary.insert(binary.end(), num4.begin(), num4.end());
-                            }   break;
-                            case type::VEC2D: {
-                                vec2d v = object->getVec2dOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                            }   break;
-                            case type::VEC3D: {
-                                vec3d v = object->getVec3dOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                            }   break;
-                            case type::VEC4D: {
-                                vec4d v = object->getVec4dOf(objectAttributeID);
-                                auto num1 = numberToBytes(v.x);
-                                auto num2 = numberToBytes(v.y);
-                                auto num3 = numberToBytes(v.z);
-                                auto num4 = numberToBytes(v.w);
-                                binary.insert(binary.end(), num1.begin(), num1.end());
-                                binary.insert(binary.end(), num2.begin(), num2.end());
-                                binary.insert(binary.end(), num3.begin(), num3.end());
-                                binary.insert(binary.end(), num4.begin(), num4.end());
-                            }   break;
-                            }
-                        } catch (...) {
-                            // Uh oh! This instruction wasn't registered for this class (or the class wasn't registered) (probably)
-                            // This part maaaayyyy be called if something above fails but it's probably not a problem (it would indeed be a problem)
-                            // TODO: Fix this entire function, it's hacky and ugly as hell (more information in comment above and other TODOs)
-                            // Save instruction and attribute ID
-                            binary.push_back(INST_ATTRIBUTE);
-                            binary.push_back(INST_ATTR_CUSTOM);
-                            auto attributeName = compileString(attribute);
-                            binary.insert(binary.end(), attributeName.begin(), attributeName.end());
-                            // Calling getStringOf() on an attribute that is not a String or Markdown String returns whatever the value is (even vectors) as a String
-                            auto valueString = compileString(object->getStringOf(object->getIDOf(attribute)));
-                            binary.insert(binary.end(), valueString.begin(), valueString.end());
+                compileObjectAttributes(binary, object, layout);
+
+                openNodes.push_back(nodeIndex);
+                // Children that were written before are copied. The first ones are kept
+                if (deduplicate) {
+                    if (!object->_getChildren().empty() && hashes.at(object).childrenClonable) {
+                        if (cloneChildren(object, nodeIndex)) {
+                            step.children = &noChildren;
+                            openChildren.push_back(NO_CHILDREN);
+                        } else {
+                            openChildren.push_back(binary.size() - codeBegin);
                         }
+                    } else {
+                        openChildren.push_back(NO_CHILDREN);
+                    }
+                }
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [&](traversal::Step& step) {
+                // The children of a Template Node are added in place, there's no scope to close
+                if (step.object->getSourceFileID() != 0) {
+                    return;
+                }
+                if (deduplicate) {
+                    const uint64_t childrenOffset = openChildren.back();
+                    openChildren.pop_back();
+                    if (childrenOffset != NO_CHILDREN) {
+                        const uint32_t nodeIndex = openNodes.back();
+                        writtenChildren[hashes.at(step.object).children].push_back({step.object, childrenOffset, binary.size() - codeBegin - childrenOffset, nodeIndex + 1, uint32_t(layout->nodes.size() - nodeIndex - 1)});
+                    }
+                }
+                binary.push_back(INST_SCOPE_EXIT);
+                if (deltaValues) {
+                    layout->deltas.exitScope();
+                }
+                if (sizedScopes) {
+                    const size_t sizePosition = openScopes.back();
+                    openScopes.pop_back();
+                    const uint32_t scopeSize = binary.size() - (sizePosition + format::SCOPE_SIZE_SIZE);
+                    for (size_t b = 0; b < format::SCOPE_SIZE_SIZE; b++) {
+                        binary[sizePosition + b] = uint8_t(scopeSize >> (b*8));
                     }
-                } // register attributes
-
-                // If this object has children
-                if (!children.empty()) {
-                    // We need to pass the children directly to this function (recursively).
-                    // This already takes care of things like includes and templates.
-                    auto compiledChildren = compileObjects(children);
-                    binary.insert(binary.end(), compiledChildren.begin(), compiledChildren.end());
                 }
 
-                // Close scope
-                if (shouldEnterScope) {
-                    binary.push_back(INST_SCOPE_EXIT);
+                const uint32_t nodeIndex = openNodes.back();
+                openNodes.pop_back();
+                if (layout != nullptr) {
+                    layout->nodes[nodeIndex].subtreeSize = layout->nodes.size() - nodeIndex;
+                }
+                if (instancing) {
+                    auto prototype = writtenPrototypes.find(step.object);
+                    if (prototype != writtenPrototypes.end()) {
+                        prototype->second.size = binary.size() - codeBegin - prototype->second.offset;
+                        prototype->second.nodeCount = layout->nodes.size() - nodeIndex;
+                    }
+                }
+            }
+        );
+    }
+    /**
+        Takes a pointer to an instance of Object and appends the ATTRIBUTE instructions
+        for all of its attributes (or only the ones in `names`, in that order).
+        The strings are written as the flags of the Layout specify (if any).
+    */
+    void EcLang::compileObjectAttributes(std::vector<uint8_t>& binary, Object* object, format::Layout* layout, const std::vector<std::string>* names) {
+        // Bytes written for values that can't be read from the attribute
+        static const uint8_t zeros[sizeof(vec4d)] = {};
+
+        // With the DELTA flag, values are written as the difference with the previous sibling
+        const bool deltaValues = layout != nullptr && (layout->flags & format::flag::DELTA);
+        alignas(8) uint8_t delta[format::MAX_VALUE_SIZE];
+
+        // Writes the value of a registered attribute
+        auto compileValue = [&](const std::string& attribute, uint32_t classID, uint8_t attributeID, type::Type attributeType) {
+            uint8_t objectAttributeID = object->getIDOf(attribute);
+            if (attributeType == type::STRING || attributeType == type::STR_MD) {
+                compileString(binary, object->getStringOf(objectAttributeID), attributeType == type::STR_MD, layout);
+                return;
+            }
+            Attribute* objectAttribute = object->_getAttributes().at(objectAttributeID);
+            // Quantized values are lossy, so they're never padded nor stored as differences
+            const format::QuantizedAttribute* quantized = layout != nullptr ? format::findQuantized(layout->quantized, classID, attributeID) : nullptr;
+            if (quantized != nullptr) {
+                const void* value = objectAttribute->getType() == attributeType ? objectAttribute->getRawValue() : zeros;
+                format::quantizeValue(binary, attributeType, static_cast<const uint8_t*>(value != nullptr ? value : zeros), *quantized);
+                return;
+            }
+            // Integers are stored as varints if the VARINT flag is set
+            if (layout != nullptr && (layout->flags & format::flag::VARINT) && format::varintLayout(attributeType).count > 0) {
+                // An attribute holding another type is read as zeros
+                const void* value = objectAttribute->getType() == attributeType ? objectAttribute->getRawValue() : zeros;
+                if (value == nullptr) {
+                    value = zeros;
+                }
+                if (deltaValues) {
+                    format::subtractDelta(attributeType, static_cast<const uint8_t*>(value), layout->deltas.previous(classID, attributeID), delta);
+                    value = delta;
                 }
+                format::putVarintValue(binary, attributeType, value);
+                return;
+            }
+            // Numbers and vectors are written as they're stored in memory, the same bytes
+            // the getters (getInt32Of(), getVec3fOf()...) read. With the ALIGNED flag they
+            // start at a multiple of their alignment (`binary` starts with the file)
+            if (layout != nullptr) {
+                binary.insert(binary.end(), format::alignmentPadding(binary.size(), attributeType, layout->flags), 0);
+            }
+            const type::Type storedType = objectAttribute->getType();
+            const void* value = (storedType == type::STRING || storedType == type::STR_MD) ? nullptr : objectAttribute->getRawValue();
+            const uint8_t* bytes = static_cast<const uint8_t*>(value != nullptr ? value : zeros);
+            if (deltaValues) {
+                format::subtractDelta(attributeType, bytes, layout->deltas.previous(classID, attributeID), delta);
+                bytes = delta;
+            }
+            binary.insert(binary.end(), bytes, bytes + type::sizeOf(attributeType));
+        };
 
-            } else {
-                // Templates exist and require extra code. If the file is a template we need to get its Template Node
-                // and run `compileObject()` for every child Node with a File ID of 0
-                const uint8_t fileID = object->getSourceFileID();
-                const std::string filenameWithType = includedFilenames.at(fileID);
-                const std::string filename = filenameWithType.substr(1);
-
-                // 't' for template, 'i' for include
-                if (filenameWithType.at(0) == 't') {
-                    // Create the instruction
-                    binary.push_back(INST_TEMPLATE);
-                    auto compiledFilename = compileString(filename);
-                    binary.insert(binary.end(), compiledFilename.begin(), compiledFilename.end());
-
-                    // we get the Template Node and run this function on its children
-                    // INFO: There can be only one Template included so it's OK (albeit a bit hacky) to just read the Temaplate Node object saved into this object
-                    // We then IGNORE all the remaining nodes
-                    // INFO: We are IGNORING all nodes that come after the Template node.
-                    // This is fine because anything below a Template inclusion goes into its Template Node
-                    auto compiledChildren = compileObjects(externalTemplateNode.at(externalTemplateNode.size()-1)->getObjects());
-                    binary.insert(binary.end(), compiledChildren.begin(), compiledChildren.end());
-                    // We break from the entire loop in order to ignore everything after #template
+        auto attributes = names != nullptr ? *names : object->getAttributes();
+        size_t first = 0;
+        // With the ATTRIBUTE_BITMAP flag, the registered attributes are written with a single
+        // ATTRIBUTES instruction if they're in the order of the class and before the custom ones.
+        // If not, they're written one by one so that they're loaded in the same order
+        if (layout != nullptr && (layout->flags & format::flag::ATTRIBUTE_BITMAP) && language->classExists(object->getClassName())) {
+            const uint32_t classID = language->getClassID(object->getClassName());
+            const std::vector<std::string>& classAttributes = language->getAttributes(classID);
+            uint8_t bitmap[format::MAX_BITMAP_SIZE] = {};
+            size_t registered = 0;
+            int lastID = -1;
+            bool ordered = classAttributes.size() <= format::MAX_BITMAP_SIZE*8;
+            for (; ordered && registered < attributes.size(); registered++) {
+                auto found = std::find(classAttributes.begin(), classAttributes.end(), attributes[registered]);
+                if (found == classAttributes.end()) {
                     break;
                 }
-                else {
-                    // First, create the instruction
-                    binary.push_back(INST_INCLUDE);
-                    auto compiledFilename = compileString(filename);
-                    binary.insert(binary.end(), compiledFilename.begin(), compiledFilename.end());
-
-                    // Now we just need to continue until we find an object with a different File ID
-                    // We start from this object and continue until we see a different File ID or the vector exits normally
-                    // We then set `i` to be the same as `objectEvaluating` so that we can continue the function normally
-                    for (size_t objectEvaluating = i; objectEvaluating < objects.size(); objectEvaluating++) {
-                        Object* eval = objects.at(objectEvaluating);
-                        if (eval->getSourceFileID() == fileID) {
-                            continue;
-                        }
-                        // The file ID changed! We don't know if we included another file or we're at File ID 0
-                        // but we don't care, we'll take care of that in the next iteration of the main loop.
-                        i = objectEvaluating-1;
-                        break;
-                    }
-                    // The next iteration of this main loop will be AFTER all the included Nodes
+                const int id = found - classAttributes.begin();
+                ordered = id > lastID;
+                lastID = id;
+                bitmap[id / 8] |= uint8_t(1 << (id % 8));
+            }
+            for (size_t a = registered; ordered && a < attributes.size(); a++) {
+                ordered = std::find(classAttributes.begin(), classAttributes.end(), attributes[a]) == classAttributes.end();
+            }
+            // A bitmap is 1 byte for the instruction and 1 for every 8 attributes of the class, ATTRIBUTE
+            // instructions are 2 bytes per attribute set. We write whatever is smaller
+            const size_t bitmapSize = (classAttributes.size() + 7) / 8;
+            if (ordered && registered > 0 && 1 + bitmapSize <= 2*registered) {
+                binary.push_back(INST_ATTRIBUTES);
+                binary.insert(binary.end(), bitmap, bitmap + bitmapSize);
+                for (; first < registered; first++) {
+                    const uint8_t attributeID = std::find(classAttributes.begin(), classAttributes.end(), attributes[first]) - classAttributes.begin();
+                    compileValue(attributes[first], classID, attributeID, language->getAttributeType(classID, attributeID));
                 }
             }
         }
 
-        return binary;
+        for (size_t a = first; a < attributes.size(); a++) {
+            const std::string& attribute = attributes[a];
+            // Getting the attribute might fail if the attribute is not registered for that class
+            // or if the class is not registered in that language. In any of those cases we save
+            // the attribute as a custom attribute (save INST_ATTR_CUSTOM and a STRING)
+            try {
+                uint8_t attributeID = language->getAttributeID(object->getClassName(), attribute);
+                // Save instruction and attribute ID
+                binary.push_back(INST_ATTRIBUTE);
+                binary.push_back(attributeID);
+                // Save value
+                compileValue(attribute, language->getClassID(object->getClassName()), attributeID, language->getAttributeType(object->getClassName(), attribute));
+            } catch (...) {
+                // Uh oh! This instruction wasn't registered for this class (or the class wasn't registered) (probably)
+                // This part maaaayyyy be called if something above fails but it's probably not a problem (it would indeed be a problem)
+                // TODO: Fix this entire function, it's hacky and ugly as hell (more information in comment above and other TODOs)
+                // Save instruction and attribute ID
+                binary.push_back(INST_ATTRIBUTE);
+                binary.push_back(INST_ATTR_CUSTOM);
+                compileString(binary, attribute, false, layout);
+                // Calling getStringOf() on an attribute that is not a String or Markdown String returns whatever the value is (even vectors) as a String
+                compileString(binary, object->getStringOf(object->getIDOf(attribute)), false, layout);
+            }
+        }
     }
     /**
-        Takes a pointer to an instance of Object and returns the CREATE instruction
-        for it.
+        Takes a pointer to an instance of Object of a registered class and adds a row
+        with the values of its attributes to the table of its class in the Layout.
     */
-    std::vector<uint8_t> EcLang::compileObjectCreation(Object* object) {
-        std::vector<uint8_t> binary;
-
+    void EcLang::compileObjectColumns(Object* object, uint32_t nodeIndex, uint32_t parentIndex, format::Layout* layout) {
+        const uint32_t classID = language->getClassID(object->getClassName());
+        format::Table& table = layout->table(classID);
+        const size_t row = table.nodes.size();
+        table.nodes.push_back(nodeIndex);
+        table.parents.push_back(parentIndex);
+
+        const std::vector<std::string>& classAttributes = language->getAttributes(classID);
+        for (const std::string& attribute : object->getAttributes()) {
+            auto found = std::find(classAttributes.begin(), classAttributes.end(), attribute);
+            if (found == classAttributes.end()) {
+                // Custom attributes only have instructions
+                continue;
+            }
+            const uint32_t attributeID = found - classAttributes.begin();
+            const type::Type attributeType = language->getAttributeType(classID, std::string_view(attribute));
+            Attribute* objectAttribute = object->_getAttributes().at(object->getIDOf(attribute));
+            const type::Type storedType = objectAttribute->getType();
+            format::Column& column = table.column(attributeID, attributeType);
+
+            // Rows without a value are left empty (zeros, or empty strings)
+            if (attributeType == type::STRING || attributeType == type::STR_MD) {
+                column.offsets.resize(row, column.characters.size());
+                column.offsets.push_back(column.characters.size());
+                column.characters += object->getStringOf(object->getIDOf(attribute));
+            } else {
+                // An attribute holding another type is left empty
+                if (storedType != attributeType || objectAttribute->getRawValue() == nullptr) {
+                    continue;
+                }
+                const size_t size = type::sizeOf(attributeType);
+                const uint8_t* bytes = static_cast<const uint8_t*>(objectAttribute->getRawValue());
+                column.values.resize(row * size, 0);
+                column.values.insert(column.values.end(), bytes, bytes + size);
+            }
+            column.validity.resize(row / 8 + 1, 0);
+            column.validity[row / 8] |= uint8_t(1 << (row % 8));
+        }
+    }
+    /**
+        Takes a pointer to an instance of Object and appends the CREATE instruction
+        for it. The strings are written as the flags of the Layout specify (if any).
+    */
+    void EcLang::compileObjectCreation(std::vector<uint8_t>& binary, Object* object, format::Layout* layout) {
         // Add object creation instruction for this object
         binary.push_back(INST_CREATE);
 
@@ -1856,168 +3454,101 @@ namespace eclang {
             // TODO: Parser should give a warning when unregistered classes are used
             binary.push_back(INST_ATTR_CUSTOM);
             // Insert STRING with Class Name
-            std::vector<uint8_t> className = compileString(object->getClassName());
-            binary.insert(binary.end(), className.begin(), className.end());
+            compileString(binary, object->getClassName(), false, layout);
         }
 
         // Add Object Name to Binary
-        std::vector<uint8_t> objectName = compileString(object->getName());
-        binary.insert(binary.end(), objectName.begin(), objectName.end());
-
-        return binary;
+        compileString(binary, object->getName(), false, layout);
     }
 
     /**
-        Takes a pointer to an instance of Object and returns its decompiled code.
-        This function is recursive and will produce the decompiled code for setting
-        the attributes, setting the template tag and creating children objects
+        Takes an array of Objects and returns their decompiled code.
+        The whole tree is walked (without recursion) and this function will produce the
+        decompiled code for setting the attributes, setting the template tag and creating children objects
     */
-    std::string EcLang::decompileObjects(std::vector<Object*> objects, uint8_t tabs) {
+    std::string EcLang::decompileObjects(const std::vector<Object*>& objects, uint8_t tabs) {
         std::string decompiled;
         // Tabulation. 1 tab = 4 spaces
-        std::string spacing = "";
-        for (uint8_t i = 0; i < tabs; i++) {
-            spacing += "    ";
-        }
+        // Goes up when we enter the scope of an object and down when we leave it
+        std::string spacing(tabs*4, ' ');
+
+        traversal::walk(objects,
+            [&](traversal::Step& step) -> uint8_t {
+                Object* object = step.object;
+
+                if (object->getSourceFileID() != 0) {
+                    // Templates exist and require extra code. If the file is a template we need to get its Template Node
+                    // and decompile every child Node of it instead of the included nodes
+                    const uint8_t fileID = object->getSourceFileID();
+                    const std::string filenameWithType = includedFilenames.at(fileID);
+                    const std::string filename = filenameWithType.substr(1);
+
+                    // 't' for template, 'i' for include
+                    if (filenameWithType.at(0) == 't') {
+                        decompiled += spacing + "#template-dyn \"" + filename + "\"\n";
+
+                        // INFO: See compileObjects() for more information about why we do this
+                        // The children of the Template Node stay at the same indentation level
+                        step.children = &externalTemplateNode.at(externalTemplateNode.size()-1)->_getChildren();
+                        return traversal::action::VISIT_CHILDREN | traversal::action::STOP_SIBLINGS;
+                    }
 
-        for (size_t i = 0; i < objects.size(); i++) {
-            Object* object = objects.at(i);
+                    // All the consecutive nodes that come from the same included file are
+                    // replaced by a single #include-dyn
+                    if (step.index > 0 && step.siblings->at(step.index-1)->getSourceFileID() == fileID) {
+                        return traversal::action::SKIP_CHILDREN;
+                    }
+                    decompiled += spacing + "#include-dyn \"" + filename + "\"\n";
+                    return traversal::action::SKIP_CHILDREN;
+                }
 
-            if (object->getSourceFileID() == 0) {
                 // Insert Object Creation Instruction
                 decompiled += spacing + object->getClassName() + " " + object->getName();
 
                 // Check for children, attributes or template tag
-                auto children = object->getObjects();
-                auto attributes = object->getAttributes();
                 // We check if the last element in template node is the same as the current node, if not, this is not a template node
                 bool isTemplate = templateNode.empty() ? false : templateNode.at(templateNode.size()-1) == object;
 
                 // should we have a SCOPE_ENTER? Yes but only if the object has children, attributes or is a template node
-                bool shouldEnterScope = false;
-                if (!children.empty() || !attributes.empty() || isTemplate) {
-                    shouldEnterScope = true;
-                    // Also enter scope, we will use shouldEnterScope to see if we should close it at the end
-                    decompiled += " {\n";
+                // The scope is closed in `onExit` once all the children are decompiled
+                if (object->_getChildren().empty() && object->_getAttributes().empty() && !isTemplate) {
+                    decompiled += ";\n";
+                    return traversal::action::SKIP_CHILDREN;
                 }
+                decompiled += " {\n";
+                spacing += "    ";
 
                 // Set as Template Node
                 if (isTemplate) {
-                    decompiled += spacing + "    #template\n";
+                    decompiled += spacing + "#template\n";
                 }
 
                 // Register attributes
-                if (!attributes.empty()) {
-                    auto attributes = object->getAttributes();
-                    for (std::string attribute : attributes) {
-                        std::string value;
-                        if (language->getAttributeType(object->getClassName(), attribute) == type::STRING) {
-                            value = "\""+object->getStringOf(object->getIDOf(attribute))+"\"";
-                        } else if (language->getAttributeType(object->getClassName(), attribute) == type::STR_MD) {
-                            value = "`"+object->getStringOf(object->getIDOf(attribute))+"`";
-                        } else {
-                            value = object->getStringOf(object->getIDOf(attribute));
-                        }
-                        decompiled += spacing + "    " + attribute + " = " + value + ";\n";
+                auto attributes = object->getAttributes();
+                for (std::string attribute : attributes) {
+                    std::string value;
+                    if (language->getAttributeType(object->getClassName(), attribute) == type::STRING) {
+                        value = "\""+object->getStringOf(object->getIDOf(attribute))+"\"";
+                    } else if (language->getAttributeType(object->getClassName(), attribute) == type::STR_MD) {
+                        value = "`"+object->getStringOf(object->getIDOf(attribute))+"`";
+                    } else {
+                        value = object->getStringOf(object->getIDOf(attribute));
                     }
-                } // register attributes
-
-                // If this object has children
-                if (!children.empty()) {
-                    // We need to pass the children directly to this function (recursively).
-                    // This already takes care of things like includes and templates.
-                    std::string decompiledChildren = decompileObjects(children, tabs+1);
-                    decompiled += decompiledChildren;
+                    decompiled += spacing + attribute + " = " + value + ";\n";
                 }
 
-                // Close scope
-                if (shouldEnterScope) {
-                    decompiled += spacing + "}\n";
-                } else {
-                    decompiled += ";\n";
-                }
-
-            } else {
-                // Templates exist and require extra code. If the file is a template we need to get its Template Node
-                // and run `compileObject()` for every child Node with a File ID of 0
-                const uint8_t fileID = object->getSourceFileID();
-                const std::string filenameWithType = includedFilenames.at(fileID);
-                const std::string filename = filenameWithType.substr(1);
-
-                // 't' for template, 'i' for include
-                if (filenameWithType.at(0) == 't') {
-                    decompiled += spacing + "#template-dyn \"" + filename + "\"\n";
-
-                    // INFO: See compileObjects() for more information about why we do this
-                    std::string decompiledChildren = decompileObjects(externalTemplateNode.at(externalTemplateNode.size()-1)->getObjects(), tabs);
-                    decompiled += decompiledChildren;
-                    // We break from the entire loop in order to ignore everything after #template
-                    break;
-                }
-                else {
-                    // First, create the instruction
-                    decompiled += spacing += "#include-dyn \"" + filename + "\"";
-
-                    // Now we just need to continue until we find an object with a different File ID
-                    // We start from this object and continue until we see a different File ID or the vector exits normally
-                    // We then set `i` to be the same as `objectEvaluating` so that we can continue the function normally
-                    for (size_t objectEvaluating = i; objectEvaluating < objects.size(); objectEvaluating++) {
-                        Object* eval = objects.at(objectEvaluating);
-                        if (eval->getSourceFileID() == fileID) {
-                            continue;
-                        }
-                        // The file ID changed! We don't know if we included another file or we're at File ID 0
-                        // but we don't care, we'll take care of that in the next iteration of the main loop.
-                        i = objectEvaluating-1;
-                        break;
-                    }
-                    // The next iteration of this main loop will be AFTER all the included Nodes
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [&](traversal::Step& step) {
+                // The children of a Template Node are added in place, there's no scope to close
+                if (step.object->getSourceFileID() != 0) {
+                    return;
                 }
+                spacing.resize(spacing.size()-4);
+                decompiled += spacing + "}\n";
             }
-        }
+        );
 
         return decompiled;
     }
-
-    /**
-        Converts a number to an array of bytes
-    */
-    std::vector<uint8_t> EcLang::numberToBytes(int8_t number) {
-        return {*reinterpret_cast<uint8_t*>(&number)};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(int16_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(int32_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(int64_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(uint8_t number) {
-        return {*reinterpret_cast<uint8_t*>(&number)};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(uint16_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(uint32_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(uint64_t number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(float number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3]};
-    }
-    std::vector<uint8_t> EcLang::numberToBytes(double number) {
-        uint8_t* data = reinterpret_cast<uint8_t*>(&number);
-        return {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
-    }
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace eclang {
     /**
@@ -13,9 +15,9 @@ namespace eclang {
     */
     Language::Language(std::string name, std::string sourceFileExtension, std::string compiledFileExtension, std::vector<uint8_t> identifierBytes) {
         // Save Strings
-        this->name = name;
-        this->sourceFileExtension = sourceFileExtension;
-        this->compiledFileExtension = compiledFileExtension;
+        this->name = std::move(name);
+        this->sourceFileExtension = std::move(sourceFileExtension);
+        this->compiledFileExtension = std::move(compiledFileExtension);
 
         // If a 0 is found in the identifierBytes vector, throw error
         if (std::find(identifierBytes.begin(), identifierBytes.end(), uint8_t(0)) != identifierBytes.end()) {
@@ -23,7 +25,7 @@ namespace eclang {
         }
 
         // Save bytes
-        this->identifierBytes = identifierBytes;
+        this->identifierBytes = std::move(identifierBytes);
     }
     /**
         Language constructor with the name of the language and the file extensions.
@@ -33,11 +35,12 @@ namespace eclang {
         This version allows you to put classes directly, creating the entire language object in one single file
     */
     Language::Language(std::string name, std::string sourceFileExtension, std::string compiledFileExtension, std::vector<uint8_t> identifierBytes, std::vector<Class> classes)
-    : Language(name, sourceFileExtension, compiledFileExtension, identifierBytes) {
+    : Language(std::move(name), std::move(sourceFileExtension), std::move(compiledFileExtension), std::move(identifierBytes)) {
         // Add Class array
-        this->classes = classes;
+        this->classes = std::move(classes);
         // Populate Class String Array
-        for (Class c : classes) {
+        classesStr.reserve(this->classes.size());
+        for (Class& c : this->classes) {
             classesStr.push_back(c.getName());
         }
     }
@@ -48,26 +51,26 @@ namespace eclang {
         Returns the name of the language. The name is used to select
         the language when creating an EcLang object
     */
-    std::string Language::getName() {
+    const std::string& Language::getName() {
         return name;
     }
     /**
         Returns the file extension of source files (uncompiled code) for this language.
     */
-    std::string Language::getExtensionSource() {
+    const std::string& Language::getExtensionSource() {
         return sourceFileExtension;
     }
     /**
         Returns the file extension of compiled files for this language
     */
-    std::string Language::getExtensionCompiled() {
+    const std::string& Language::getExtensionCompiled() {
         return compiledFileExtension;
     }
     /**
         Returns the first bytes of compiled files that use this language.
         They are used to identify the language of a compiled EcLang file.
     */
-    std::vector<uint8_t> Language::getIdentifierBytes() {
+    const std::vector<uint8_t>& Language::getIdentifierBytes() {
         return identifierBytes;
     }
 
@@ -77,8 +80,8 @@ namespace eclang {
         Registers a class into the language.
     */
     void Language::registerClass(Class c) {
-        classes.push_back(c);
         classesStr.push_back(c.getName());
+        classes.push_back(std::move(c));
     }
 
     // Classes
@@ -86,7 +89,7 @@ namespace eclang {
     /**
         Returns a list of all registered classes in the language
     */
-    std::vector<std::string> Language::getClasses() {
+    const std::vector<std::string>& Language::getClasses() {
         return classesStr;
     }
     /**
@@ -98,13 +101,13 @@ namespace eclang {
     /**
         Returns true if a class with the name specified exists
     */
-    bool Language::classExists(std::string name) {
+    bool Language::classExists(std::string_view name) {
         return std::find(classesStr.begin(), classesStr.end(), name) != classesStr.end();
     }
     /**
         Returns the class name from its ID
     */
-    std::string Language::getClassName(uint32_t id) {
+    const std::string& Language::getClassName(uint32_t id) {
         if (!classExists(id)) {
             throw std::runtime_error("ECLANG_ERROR: Tried to get name of a class with invalid ID ("+std::to_string(id)+").");
         }
@@ -113,40 +116,49 @@ namespace eclang {
     /**
         Returns the ID of the class from its name
     */
-    uint32_t Language::getClassID(std::string name) {
+    uint32_t Language::getClassID(std::string_view name) {
         auto iterator = std::find(classesStr.begin(), classesStr.end(), name);
         if (iterator == classesStr.end()) {
-            throw std::runtime_error("ECLANG_ERROR: Tried to get the ID of a class with unregistered name ("+name+").");
+            throw std::runtime_error("ECLANG_ERROR: Tried to get the ID of a class with unregistered name ("+std::string(name)+").");
         }
         return iterator - classesStr.begin();
     }
+    /**
+        Returns the class with the ID specified
+    */
+    Class& Language::getClass(uint32_t id) {
+        if (!classExists(id)) {
+            throw std::runtime_error("ECLANG_ERROR: Tried to get a class with invalid ID ("+std::to_string(id)+").");
+        }
+        return classes[id];
+    }
 
     // Attributes from classes
     // -----------------------
     /**
         Takes the ID of the Class and returns all attributes
     */
-    std::vector<std::string> Language::getAttributes(uint32_t classID) {
+    const std::vector<std::string>& Language::getAttributes(uint32_t classID) {
         return classes.at(classID).getAttributes();
     }
     /**
         Takes the name of the Class and returns all attributes
     */
-    std::vector<std::string> Language::getAttributes(std::string className) {
+    const std::vector<std::string>& Language::getAttributes(std::string_view className) {
         return classes.at(getClassID(className)).getAttributes();
     }
     /**
         Takes the ID of the class and the ID of an attribute
         and returns the name of the attribute
     */
-    std::string Language::getAttributeName(uint32_t classID, uint32_t attributeID) {
+    const std::string& Language::getAttributeName(uint32_t classID, uint32_t attributeID) {
         return classes.at(classID).getAttributeName(attributeID);
     }
     /**
         Takes the name of the class and the ID of an attribute
         and returns the name of the attribute
     */
-    std::string Language::getAttributeName(std::string className, uint32_t attributeID) {
+    const std::string& Language::getAttributeName(std::string_view className, uint32_t attributeID) {
         return classes.at(getClassID(className)).getAttributeName(attributeID);
     }
 
@@ -154,14 +166,14 @@ namespace eclang {
         Takes the ID of the class and the name of an attribute
         and returns the ID of the attribute
     */
-    uint32_t Language::getAttributeID(uint32_t classID, std::string attributeName) {
+    uint32_t Language::getAttributeID(uint32_t classID, std::string_view attributeName) {
         return classes.at(classID).getAttributeID(attributeName);
     }
     /**
         Takes the name of the class and the name of an attribute
         and returns the ID of the attribute
     */
-    uint32_t Language::getAttributeID(std::string className, std::string attributeName) {
+    uint32_t Language::getAttributeID(std::string_view className, std::string_view attributeName) {
         return classes.at(getClassID(className)).getAttributeID(attributeName);
     }
 
@@ -176,21 +188,76 @@ namespace eclang {
         Takes the ID of the class and the name of an attribute
         and returns the data type of the attribute
     */
-    type::Type Language::getAttributeType(uint32_t classID, std::string attributeName) {
+    type::Type Language::getAttributeType(uint32_t classID, std::string_view attributeName) {
         return classes.at(classID).getAttributeType(attributeName);
     }
     /**
         Takes the name of the class and the ID of an attribute
         and returns the data type of the attribute
     */
-    type::Type Language::getAttributeType(std::string className, uint32_t attributeID) {
+    type::Type Language::getAttributeType(std::string_view className, uint32_t attributeID) {
         return classes.at(getClassID(className)).getAttributeType(attributeID);
     }
     /**
         Takes the name of the class and the name of an attribute
         and returns the data type of the attribute
     */
-    type::Type Language::getAttributeType(std::string className, std::string attributeName) {
+    type::Type Language::getAttributeType(std::string_view className, std::string_view attributeName) {
         return classes.at(getClassID(className)).getAttributeType(attributeName);
     }
-}
\ No newline at end of file
+
+    /**
+        Takes the ID of the class and the ID of an attribute and returns the
+        default value of the attribute (nullptr if it doesn't have one, see Class::getDefault())
+    */
+    Attribute* Language::getAttributeDefault(uint32_t classID, uint32_t attributeID) {
+        return classes.at(classID).getDefault(attributeID);
+    }
+    /**
+        Takes the name of the class and the name of an attribute and returns the
+        default value of the attribute (nullptr if it doesn't have one, see Class::getDefault())
+    */
+    Attribute* Language::getAttributeDefault(std::string_view className, std::string_view attributeName) {
+        Class& c = classes.at(getClassID(className));
+        return c.getDefault(c.getAttributeID(attributeName));
+    }
+
+    /**
+        Returns a hash of the classes, attributes, types and default values of the
+        language in the order they were registered (which determines their IDs).
+    */
+    uint64_t Language::getFingerprint() {
+        // 64 bit FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](uint8_t byte) {
+            hash ^= byte;
+            hash *= 1099511628211ull;
+        };
+        auto addString = [&add](const std::string& string) {
+            for (char c : string) add(uint8_t(c));
+            add(0); // separator, so that "ab"+"c" and "a"+"bc" are different
+        };
+
+        for (Class& c : classes) {
+            addString(c.getName());
+            const std::vector<std::string>& attributes = c.getAttributes();
+            for (uint32_t a = 0; a < attributes.size(); a++) {
+                addString(attributes[a]);
+                add(uint8_t(c.getAttributeType(a)));
+                // Files don't store values equal to the default, so changing it changes the files.
+                // Attributes without a default hash as they did before defaults existed
+                if (Attribute* value = c.getDefault(a)) {
+                    add(0xFE);
+                    if (value->getType() == type::STRING || value->getType() == type::STR_MD) {
+                        addString(value->getString());
+                    } else {
+                        const uint8_t* bytes = static_cast<const uint8_t*>(value->getRawValue());
+                        for (size_t b = 0; b < type::sizeOf(value->getType()); b++) add(bytes[b]);
+                    }
+                }
+            }
+            add(0xFF); // end of class
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,1043 @@
+#include "classes/mappedDocument.hpp"
+#include "classes/attribute.hpp"
+#include "classes/language.hpp"
+#include "util/binaryFormat.hpp"
+#include "util/globalConfig.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace eclang {
+    namespace {
+        /**
+            Reads the instructions of a mapped file without reading past the end
+            of the DATA section
+        */
+        struct CodeReader {
+            const uint8_t* data;
+            size_t position;
+            size_t end;
+            // String table of the file (empty if the strings are stored in the instructions)
+            const std::vector<std::string_view>* strings;
+            // Flags of the file (see util/binaryFormat.hpp)
+            uint16_t flags;
+
+            bool atEnd() const {
+                return position >= end;
+            }
+            uint8_t peek() const {
+                if (atEnd()) corrupted();
+                return data[position];
+            }
+            uint8_t byte() {
+                uint8_t b = peek();
+                position++;
+                return b;
+            }
+            // Returns a pointer to the value and skips it
+            const uint8_t* skip(size_t count) {
+                if (end - position < count) corrupted();
+                const uint8_t* value = data + position;
+                position += count;
+                return value;
+            }
+            // Reads a STRING (prefix, characters and terminator or prefix and index in
+            // the string table) and returns the characters
+            std::string_view string() {
+                position++; // Skip prefix
+                if (flags & format::flag::STRING_TABLE) {
+                    uint64_t string;
+                    if (flags & format::flag::VARINT) {
+                        string = varint();
+                    } else {
+                        string = format::getU32(skip(4));
+                    }
+                    if (string >= strings->size()) corrupted();
+                    return (*strings)[string];
+                }
+                if (atEnd()) corrupted();
+                const void* terminator = std::memchr(data + position, 0, end - position);
+                if (terminator == nullptr) corrupted();
+                size_t length = static_cast<const uint8_t*>(terminator) - (data + position);
+                std::string_view value(reinterpret_cast<const char*>(data + position), length);
+                position += length + 1;
+                return value;
+            }
+            // Reads a LEB128 integer
+            uint64_t varint() {
+                uint64_t value;
+                const uint8_t* next = format::getVarint(data + position, data + end, value);
+                if (next == nullptr) corrupted();
+                position = next - data;
+                return value;
+            }
+            // Returns a pointer to a value stored as varints and skips it
+            const uint8_t* skipVarints(type::Type type) {
+                alignas(8) uint8_t value[sizeof(vec4l)];
+                const uint8_t* start = data + position;
+                const uint8_t* next = format::getVarintValue(start, data + end, type, value);
+                if (next == nullptr) corrupted();
+                position = next - data;
+                return start;
+            }
+            [[noreturn]] static void corrupted() {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read mapped file. The instructions are corrupted.");
+            }
+        };
+
+        /**
+            The CREATE instruction of a node. `reader` is left after it
+        */
+        struct Creation {
+            bool isCustom;
+            uint8_t classID;
+            std::string_view customClass;
+            std::string_view name;
+        };
+        /**
+            Resizes `buffer` to keep `size` bytes starting at an address aligned to
+            format::MAX_VALUE_ALIGNMENT (like the start of a mapped file) and returns it
+        */
+        uint8_t* alignedStorage(std::vector<uint8_t>& buffer, size_t size) {
+            buffer.resize(size + format::MAX_VALUE_ALIGNMENT);
+            const size_t misalignment = reinterpret_cast<uintptr_t>(buffer.data()) % format::MAX_VALUE_ALIGNMENT;
+            return buffer.data() + (format::MAX_VALUE_ALIGNMENT - misalignment) % format::MAX_VALUE_ALIGNMENT;
+        }
+
+        Creation readCreation(CodeReader& reader) {
+            if (reader.byte() != INST_CREATE) CodeReader::corrupted();
+            Creation creation {false, 0, {}, {}};
+            creation.classID = reader.byte();
+            if (creation.classID == INST_ATTR_CUSTOM) {
+                creation.isCustom = true;
+                creation.customClass = reader.string();
+            }
+            creation.name = reader.string();
+            return creation;
+        }
+    }
+
+    // MAPPED NODE
+    // -----------
+
+    MappedNode::MappedNode(const MappedDocument* document, uint32_t index) : document(document), index(index) {}
+
+    /**
+        Returns the name of the node
+    */
+    std::string_view MappedNode::getName() const {
+        CodeReader reader {document->data, document->codeBegin + document->nodeOffset(index), document->codeEnd, &document->strings, document->flags};
+        return readCreation(reader).name;
+    }
+    /**
+        Returns the name of the class of the node
+    */
+    std::string_view MappedNode::getClassName() const {
+        CodeReader reader {document->data, document->codeBegin + document->nodeOffset(index), document->codeEnd, &document->strings, document->flags};
+        Creation creation = readCreation(reader);
+        if (creation.isCustom) {
+            return creation.customClass;
+        }
+        return document->language->getClassName(creation.classID);
+    }
+
+    /**
+        Returns the node that contains this one (nothing for nodes in the root)
+    */
+    std::optional<MappedNode> MappedNode::getParent() const {
+        uint32_t parent = document->nodeParent(index);
+        if (parent == format::NO_PARENT) {
+            return std::nullopt;
+        }
+        return MappedNode(document, parent);
+    }
+    /**
+        Returns the number of children of this node
+    */
+    size_t MappedNode::getObjectCount() const {
+        size_t count = 0;
+        const uint32_t end = index + document->nodeSubtreeSize(index);
+        for (uint32_t child = index + 1; child < end; child += document->nodeSubtreeSize(child)) {
+            count++;
+        }
+        return count;
+    }
+    /**
+        Returns all children of this node.
+        The vector may be empty
+    */
+    std::vector<MappedNode> MappedNode::getObjects() const {
+        std::vector<MappedNode> children;
+        const uint32_t end = index + document->nodeSubtreeSize(index);
+        for (uint32_t child = index + 1; child < end; child += document->nodeSubtreeSize(child)) {
+            children.push_back(MappedNode(document, child));
+        }
+        return children;
+    }
+    /**
+        Returns the node with the name specified (or the path to it,
+        relative to this node) if it exists
+    */
+    std::optional<MappedNode> MappedNode::getObject(std::string_view name) const {
+        return document->findSibling(index + 1, index + document->nodeSubtreeSize(index), name);
+    }
+
+    /**
+        Calls `visit(attributeName, type, value, text)` for every attribute of this node
+        until it returns true. `text` is the value of strings (empty for other types).
+        Custom attributes are reported as STRING. The attributes of instances (INSTANCES)
+        are visited first, followed by the ones they get from their prototypes
+    */
+    template<class Visit>
+    void MappedNode::forEachAttribute(Visit visit) const {
+        CodeReader reader {document->data, document->codeBegin + document->nodeOffset(index), document->codeEnd, &document->strings, document->flags};
+        Creation creation = readCreation(reader);
+        // Names visited, so that the attributes an instance changes hide the ones of its prototype
+        std::vector<std::string_view> visited;
+        const bool instanced = reader.flags & format::flag::INSTANCES;
+
+        Language* language = document->language;
+        // Reads the value of a registered attribute and visits it
+        auto visitValue = [&](uint8_t attributeID) {
+            type::Type attributeType = language->getAttributeType(creation.classID, attributeID);
+            const std::string& attributeName = language->getAttributeName(creation.classID, attributeID);
+            const uint8_t* value;
+            std::string_view text;
+            size_t size = type::sizeOf(attributeType);
+            if (size == 0) {
+                text = reader.string();
+                value = reinterpret_cast<const uint8_t*>(text.data());
+            } else if (const format::QuantizedAttribute* quantized = format::findQuantized(document->quantized, creation.classID, attributeID)) {
+                if (format::quantizedComponents(attributeType) == 0) {
+                    CodeReader::corrupted();
+                }
+                value = reader.skip(format::quantizedSize(attributeType, *quantized));
+            } else if ((reader.flags & format::flag::VARINT) && format::varintLayout(attributeType).count > 0) {
+                value = reader.skipVarints(attributeType);
+            } else {
+                // Values of ALIGNED files are preceded by padding (the reader starts at the start of the file)
+                reader.skip(format::alignmentPadding(reader.position, attributeType, reader.flags));
+                value = reader.skip(size);
+            }
+            if (std::find(visited.begin(), visited.end(), std::string_view(attributeName)) != visited.end()) {
+                return false;
+            }
+            if (instanced) {
+                visited.push_back(attributeName);
+            }
+            return visit(std::string_view(attributeName), attributeType, value, text);
+        };
+
+        while (true) {
+            // Attributes are only written after SCOPE_ENTER (and MARK_TEMPLATE)
+            if (reader.atEnd() || reader.peek() != INST_SCOPE_ENTER) {
+                return;
+            }
+            reader.byte();
+            if (reader.flags & format::flag::SIZED_SCOPES) {
+                reader.skip(format::SCOPE_SIZE_SIZE);
+            }
+            if (!reader.atEnd() && reader.peek() == INST_MARK_TEMPLATE) {
+                reader.byte();
+            }
+
+            // Attributes set with a bitmap (ATTRIBUTE_BITMAP) come before the others
+            if (!reader.atEnd() && reader.peek() == INST_ATTRIBUTES) {
+                reader.byte();
+                if (creation.isCustom) {
+                    CodeReader::corrupted();
+                }
+                const size_t attributeCount = language->getAttributes(creation.classID).size();
+                const size_t bitmapSize = (attributeCount + 7) / 8;
+                const uint8_t* bitmap = reader.skip(bitmapSize);
+                for (size_t id = 0; id < bitmapSize * 8; id++) {
+                    if (!(bitmap[id / 8] & (1 << (id % 8)))) {
+                        continue;
+                    }
+                    if (id >= attributeCount) {
+                        CodeReader::corrupted();
+                    }
+                    if (visitValue(uint8_t(id))) return;
+                }
+            }
+            while (!reader.atEnd() && reader.peek() == INST_ATTRIBUTE) {
+                reader.byte();
+                uint8_t attributeID = reader.byte();
+                if (attributeID == INST_ATTR_CUSTOM) {
+                    std::string_view attributeName = reader.string();
+                    std::string_view text = reader.string();
+                    if (std::find(visited.begin(), visited.end(), attributeName) != visited.end()) {
+                        continue;
+                    }
+                    if (instanced) {
+                        visited.push_back(attributeName);
+                    }
+                    if (visit(attributeName, type::STRING, reinterpret_cast<const uint8_t*>(text.data()), text)) return;
+                    continue;
+                }
+                if (creation.isCustom) {
+                    CodeReader::corrupted();
+                }
+                if (visitValue(attributeID)) return;
+            }
+
+            // Instances continue with the attributes of their prototype, which is always written before
+            if (!instanced || reader.atEnd() || reader.peek() != INST_INSTANCE) {
+                return;
+            }
+            const size_t instance = reader.position;
+            reader.byte();
+            const uint64_t offset = reader.varint();
+            if (offset >= instance - document->codeBegin) {
+                CodeReader::corrupted();
+            }
+            reader.position = document->codeBegin + offset;
+            Creation prototype = readCreation(reader);
+            if (prototype.isCustom != creation.isCustom || (creation.isCustom ? prototype.customClass != creation.customClass : prototype.classID != creation.classID)) {
+                CodeReader::corrupted();
+            }
+        }
+    }
+
+    /**
+        Returns the names of all the attributes set in this node
+    */
+    std::vector<std::string_view> MappedNode::getAttributes() const {
+        std::vector<std::string_view> attributes;
+        forEachAttribute([&](std::string_view name, type::Type, const uint8_t*, std::string_view) {
+            attributes.push_back(name);
+            return false;
+        });
+        return attributes;
+    }
+    /**
+        Returns true if the attribute is set in this node
+    */
+    bool MappedNode::hasAttribute(std::string_view attribute) const {
+        type::Type attributeType;
+        return _findValue(attribute, attributeType) != nullptr;
+    }
+    /**
+        Returns the data type of the attribute.
+        Throws a runtime error if the attribute is not set and doesn't have a default value
+    */
+    type::Type MappedNode::getTypeOf(std::string_view attribute) const {
+        type::Type attributeType;
+        if (_findValue(attribute, attributeType) == nullptr) {
+            if (Attribute* defaultValue = _findDefault(attribute)) {
+                return defaultValue->getType();
+            }
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" is not set in \""+std::string(getName())+"\".");
+        }
+        return attributeType;
+    }
+    /**
+        Returns the value of a String or Markdown String attribute (its default value
+        if it's not set). Throws a runtime error if the attribute is not set and doesn't
+        have a default value or is not a string
+    */
+    std::string_view MappedNode::getStringOf(std::string_view attribute) const {
+        bool found = false;
+        type::Type attributeType;
+        std::string_view value;
+        forEachAttribute([&](std::string_view name, type::Type t, const uint8_t*, std::string_view text) {
+            if (name != attribute) return false;
+            found = true;
+            attributeType = t;
+            value = text;
+            return true;
+        });
+        Attribute* defaultValue = found ? nullptr : _findDefault(attribute);
+        if (defaultValue != nullptr) {
+            found = true;
+            attributeType = defaultValue->getType();
+            if (attributeType == type::STRING || attributeType == type::STR_MD) {
+                value = *static_cast<const std::string*>(defaultValue->getRawValue());
+            }
+        }
+        if (!found) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" is not set in \""+std::string(getName())+"\".");
+        }
+        if (attributeType != type::STRING && attributeType != type::STR_MD) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" is not a String.");
+        }
+        return value;
+    }
+
+    /**
+        Copies the value of a number or vector attribute to `value`, which has
+        `size` bytes. Attributes that aren't set read their default value. Throws a runtime
+        error if the attribute is not set and doesn't have one or `size` is not the size of
+        the attribute. In files compiled with delta values the previous siblings of the node
+        are read too. Quantized attributes are converted back to their type
+    */
+    void MappedNode::_readValue(std::string_view attribute, void* value, size_t size) const {
+        // Copies the default value of the attribute when it's not set
+        auto readDefault = [&]() {
+            Attribute* defaultValue = _findDefault(attribute);
+            if (defaultValue == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" is not set in \""+std::string(getName())+"\".");
+            }
+            if (type::sizeOf(defaultValue->getType()) != size) {
+                throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be read as a value of "+std::to_string(size)+" bytes.");
+            }
+            std::memcpy(value, defaultValue->getRawValue(), size);
+        };
+
+        // Quantized values are never stored as differences
+        if (!(document->flags & format::flag::DELTA) || document->findQuantized(getClassName(), attribute) != nullptr) {
+            if (!_readStoredValue(attribute, value, size)) {
+                readDefault();
+            }
+            return;
+        }
+
+        // The value is the sum of the differences stored in this node and its previous
+        // siblings of the same class
+        CodeReader reader {document->data, _getPosition(), document->codeEnd, &document->strings, document->flags};
+        const Creation creation = readCreation(reader);
+        alignas(8) uint8_t sum[format::MAX_VALUE_SIZE] = {};
+        alignas(8) uint8_t delta[format::MAX_VALUE_SIZE];
+        type::Type attributeType = type::STRING;
+        bool found = false;
+        const uint32_t parent = document->nodeParent(index);
+        for (uint32_t sibling = parent == format::NO_PARENT ? 0 : parent + 1; sibling <= index; sibling += std::max<uint32_t>(document->nodeSubtreeSize(sibling), 1)) {
+            MappedNode node(document, sibling);
+            if (sibling != index) {
+                CodeReader siblingReader {document->data, node._getPosition(), document->codeEnd, &document->strings, document->flags};
+                const Creation siblingCreation = readCreation(siblingReader);
+                if (siblingCreation.isCustom || creation.isCustom || siblingCreation.classID != creation.classID) {
+                    continue;
+                }
+            }
+            if (node._readStoredValue(attribute, delta, size)) {
+                attributeType = node.getTypeOf(attribute);
+                format::addDelta(attributeType, delta, sum);
+                found = sibling == index;
+            }
+        }
+        if (!found) {
+            readDefault();
+            return;
+        }
+        std::memcpy(value, sum, size);
+    }
+    /**
+        Like _readValue() but copies the value as it's stored: the difference with the
+        previous sibling in files compiled with delta values. Returns false if the
+        attribute is not set
+    */
+    bool MappedNode::_readStoredValue(std::string_view attribute, void* value, size_t size) const {
+        type::Type attributeType;
+        const uint8_t* found = _findValue(attribute, attributeType);
+        if (found == nullptr) {
+            return false;
+        }
+        if (type::sizeOf(attributeType) != size) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be read as a value of "+std::to_string(size)+" bytes.");
+        }
+        if (const format::QuantizedAttribute* quantized = document->findQuantized(getClassName(), attribute)) {
+            format::dequantizeValue(found, attributeType, *quantized, static_cast<uint8_t*>(value));
+            return true;
+        }
+        if ((document->flags & format::flag::VARINT) && format::varintLayout(attributeType).count > 0) {
+            // Checked while finding it
+            format::getVarintValue(found, document->data + document->codeEnd, attributeType, value);
+            return true;
+        }
+        std::memcpy(value, found, size);
+        return true;
+    }
+    /**
+        Returns a pointer to the value of a number or vector attribute of `size` bytes
+        in the file. Throws a runtime error if it can't be read in place (see getReferenceOf())
+    */
+    const uint8_t* MappedNode::_referValue(std::string_view attribute, size_t size) const {
+        if (!(document->flags & format::flag::ALIGNED)) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be referenced. The file wasn't compiled with aligned values.");
+        }
+        if (document->flags & format::flag::DELTA) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be referenced. The file stores the differences between values.");
+        }
+        type::Type attributeType;
+        const uint8_t* found = _findValue(attribute, attributeType);
+        if (found == nullptr) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" is not set in \""+std::string(getName())+"\".");
+        }
+        if (type::sizeOf(attributeType) != size) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be read as a value of "+std::to_string(size)+" bytes.");
+        }
+        if ((document->flags & format::flag::VARINT) && format::varintLayout(attributeType).count > 0) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be referenced. It's stored as varints.");
+        }
+        if (document->findQuantized(getClassName(), attribute) != nullptr) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be referenced. It's stored with less precision.");
+        }
+        // Mapped files start at a page boundary and files read into memory are
+        // stored aligned too (see alignedStorage()), so this is only a safety check
+        if (reinterpret_cast<uintptr_t>(found) % format::valueAlignment(attributeType) != 0) {
+            throw std::runtime_error("ECLANG_ERROR: Attribute \""+std::string(attribute)+"\" can't be referenced. The file isn't aligned in memory.");
+        }
+        return found;
+    }
+    /**
+        Returns a pointer to the value of the attribute in the file and sets
+        its type. Returns nullptr if the attribute is not set.
+        Strings point to their first character (use getStringOf() to get their length),
+        integers stored as varints and quantized values to their first byte (use getValueOf()).
+    */
+    const uint8_t* MappedNode::_findValue(std::string_view attribute, type::Type& attributeType) const {
+        const uint8_t* found = nullptr;
+        forEachAttribute([&](std::string_view name, type::Type t, const uint8_t* value, std::string_view) {
+            if (name != attribute) return false;
+            found = value;
+            attributeType = t;
+            return true;
+        });
+        return found;
+    }
+    /**
+        Returns the default value of the attribute in the class of this node (see
+        Class::getDefault()) or nullptr if it doesn't have one
+    */
+    Attribute* MappedNode::_findDefault(std::string_view attribute) const {
+        Language* language = document->language;
+        std::string_view className = getClassName();
+        if (!language->classExists(className)) {
+            return nullptr;
+        }
+        Class& nodeClass = language->getClass(language->getClassID(className));
+        if (!nodeClass.hasDefaults() || !nodeClass.attributeExists(attribute)) {
+            return nullptr;
+        }
+        return nodeClass.getDefault(nodeClass.getAttributeID(attribute));
+    }
+    /**
+        Returns the position of this node in the node table of the file
+    */
+    uint32_t MappedNode::_getIndex() const {
+        return index;
+    }
+    /**
+        Returns the position of the CREATE instruction of this node in the file
+    */
+    uint64_t MappedNode::_getPosition() const {
+        return document->codeBegin + document->nodeOffset(index);
+    }
+    /**
+        Returns the number of nodes in the subtree of this node (this one included)
+    */
+    uint32_t MappedNode::_getSubtreeSize() const {
+        return document->nodeSubtreeSize(index);
+    }
+    /**
+        Returns the position in the file of the end of the instructions of this node
+        and all of its subtree (after its SCOPE_EXIT). Throws a runtime error if the
+        file wasn't compiled with sized scopes and the node has a scope
+    */
+    uint64_t MappedNode::_getEnd() const {
+        const size_t begin = document->codeBegin + document->nodeOffset(index);
+        CodeReader reader {document->data, begin, document->codeEnd, &document->strings, document->flags};
+        readCreation(reader);
+
+        // Nodes without attributes or children are only a CREATE instruction
+        if (!reader.atEnd() && reader.peek() == INST_SCOPE_ENTER) {
+            if (!(document->flags & format::flag::SIZED_SCOPES)) {
+                throw std::runtime_error("ECLANG_ERROR: The scopes of the file don't have sizes so \""+std::string(getName())+"\" can't be read alone. Compile the file again.");
+            }
+            reader.byte();
+            uint32_t scopeSize = format::getU32(reader.skip(format::SCOPE_SIZE_SIZE));
+            reader.skip(scopeSize);
+        }
+        return reader.position;
+    }
+
+    // MAPPED DOCUMENT
+    // ---------------
+
+    /**
+        Maps the compiled file. The file path may be an alias.
+        Throws a runtime error if the file can't be mapped, it's not a version 2
+        compiled file or its language isn't registered.
+    */
+    MappedDocument::MappedDocument(std::string filepath) {
+        if (config::filepathIsAlias(filepath)) {
+            filepath = config::filepathGetFor(filepath);
+        }
+
+        #ifndef _WIN32
+        int file = open(filepath.c_str(), O_RDONLY);
+        if (file < 0) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't load file \""+filepath+"\". No such fie or directory");
+        }
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            close(file);
+            throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". The file is empty or can't be read.");
+        }
+        size = info.st_size;
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping keeps the file open
+        close(file);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\".");
+        }
+        data = static_cast<const uint8_t*>(mapping);
+        #else
+        // No memory mapping: read the whole file instead
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't load file \""+filepath+"\". No such fie or directory");
+        }
+        size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        uint8_t* storage = alignedStorage(buffer, size);
+        file.read(reinterpret_cast<char*>(storage), size);
+        data = storage;
+        #endif
+
+        try {
+            // Find the language from the identifier bytes
+            for (Language& languageChecking : config::getLanguages()) {
+                const std::vector<uint8_t>& identifierBytes = languageChecking.getIdentifierBytes();
+                if (size > identifierBytes.size() && data[identifierBytes.size()] == 0 &&
+                    std::memcmp(data, identifierBytes.data(), identifierBytes.size()) == 0) {
+                    language = &languageChecking;
+                    break;
+                }
+            }
+            if (language == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". The language of the file couldn't be determined.");
+            }
+
+            const size_t start = language->getIdentifierBytes().size() + 1;
+            if (!format::isVersioned(data, size, start)) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". Only version 2 compiled files can be mapped, compile it again.");
+            }
+            // Compressed files can't be read in place: keep the decompressed file instead
+            if (format::isCompressed(data, size, start)) {
+                std::vector<uint8_t> decompressed = format::decompressContainer(data, size, start);
+                unmap();
+                size = decompressed.size();
+                // Aligned values must be aligned in memory too
+                if (reinterpret_cast<uintptr_t>(decompressed.data()) % format::MAX_VALUE_ALIGNMENT == 0) {
+                    buffer = std::move(decompressed);
+                    data = buffer.data();
+                } else {
+                    uint8_t* storage = alignedStorage(buffer, decompressed.size());
+                    std::memcpy(storage, decompressed.data(), decompressed.size());
+                    data = storage;
+                }
+            }
+            format::Container container = format::readContainer(data, size, start);
+            if (container.header.fingerprint != language->getFingerprint()) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". It was compiled with a different version of the language \""+language->getName()+"\".");
+            }
+
+            const format::SectionEntry* nodeSection = container.find(format::section::NODES);
+            nodes = data + nodeSection->offset;
+            nodeCount = container.header.nodeCount;
+            const format::SectionEntry* code = container.find(format::section::DATA);
+            codeBegin = code->offset;
+            codeEnd = code->offset + code->size;
+            const format::SectionEntry* pathSection = container.find(format::section::PATHS);
+            if (pathSection != nullptr) {
+                if (pathSection->size < 4) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". The PATHS section is corrupted.");
+                }
+                pathSlotCount = format::getU32(data + pathSection->offset);
+                if (pathSlotCount == 0 || (pathSlotCount & (pathSlotCount - 1)) != 0 || (pathSection->size - 4) / format::PATH_SLOT_SIZE != pathSlotCount) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't map file \""+filepath+"\". The PATHS section is corrupted.");
+                }
+                paths = data + pathSection->offset + 4;
+            }
+            const format::SectionEntry* columnSection = container.find(format::section::COLUMNS);
+            if (columnSection != nullptr) {
+                columnsOffset = columnSection->offset;
+                columnsSize = columnSection->size;
+            }
+
+            format::Encoding encoding = format::readEncoding(data, container);
+            flags = encoding.flags;
+            strings = std::move(encoding.strings);
+            quantized = std::move(encoding.quantized);
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+    /**
+        Unmaps the file
+    */
+    MappedDocument::~MappedDocument() {
+        unmap();
+    }
+
+    /**
+        Returns the number of nodes in the file (all levels)
+    */
+    size_t MappedDocument::getNodeCount() const {
+        return nodeCount;
+    }
+    /**
+        Returns the nodes in the root of the file
+    */
+    std::vector<MappedNode> MappedDocument::getAllObjects() const {
+        std::vector<MappedNode> roots;
+        for (uint32_t node = 0; node < nodeCount; node += nodeSubtreeSize(node)) {
+            roots.push_back(MappedNode(this, node));
+        }
+        return roots;
+    }
+    /**
+        Returns the node with the name (or path: node1/node2/node3) specified
+        if it exists
+    */
+    std::optional<MappedNode> MappedDocument::getObject(std::string_view name) const {
+        if (paths != nullptr) {
+            return findPath(name);
+        }
+        return findSibling(0, nodeCount, name);
+    }
+    /**
+        Returns the node at the position specified of the node table
+    */
+    MappedNode MappedDocument::getNode(uint32_t index) const {
+        if (index >= nodeCount) {
+            throw std::runtime_error("ECLANG_ERROR: Node "+std::to_string(index)+" doesn't exist. The file has "+std::to_string(nodeCount)+" nodes.");
+        }
+        return MappedNode(this, index);
+    }
+    /**
+        Returns the table of the class specified if the file has one (see MappedTable).
+        Throws a runtime error if the COLUMNS section is corrupted or this machine is big endian
+    */
+    std::optional<MappedTable> MappedDocument::getTable(std::string_view className) const {
+        if (columnsSize == 0 || !language->classExists(className)) {
+            return std::nullopt;
+        }
+        if (!format::isLittleEndian()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read the table of \""+std::string(className)+"\". Columns are stored in little endian and this machine is big endian.");
+        }
+        const uint32_t classID = language->getClassID(className);
+        format::TableEntry entry;
+        if (!format::readTable(data, {format::section::COLUMNS, columnsOffset, columnsSize}, classID, entry)) {
+            return std::nullopt;
+        }
+
+        const std::vector<std::string>& attributes = language->getAttributes(classID);
+        MappedTable table(this, language->getClassName(classID), entry.rowCount, data + entry.nodes, data + entry.parents);
+        table.columns.reserve(entry.columns.size());
+        for (const format::ColumnEntry& column : entry.columns) {
+            if (column.attribute >= attributes.size() || column.type != language->getAttributeType(classID, column.attribute)) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+            }
+            table.columns.push_back(MappedColumn(attributes[column.attribute], static_cast<type::Type>(column.type), entry.rowCount, data + column.validity, data + column.values, column.valuesSize));
+        }
+        return table;
+    }
+    /**
+        Returns the language of the file
+    */
+    Language* MappedDocument::getLanguage() const {
+        return language;
+    }
+
+    /**
+        Returns the flags of the file (see util/binaryFormat.hpp)
+    */
+    uint16_t MappedDocument::_getFlags() const {
+        return flags;
+    }
+    /**
+        Returns the strings of the string table of the file (empty if the
+        file doesn't have a string table)
+    */
+    const std::vector<std::string_view>& MappedDocument::_getStrings() const {
+        return strings;
+    }
+    /**
+        Returns the attributes stored with less precision (empty if the file
+        wasn't compiled with quantized attributes)
+    */
+    const std::vector<format::QuantizedAttribute>& MappedDocument::_getQuantized() const {
+        return quantized;
+    }
+    /**
+        Returns the contents of the file (mapped or read into memory). The instructions
+        are between the positions _getCodeBegin() and _getCodeEnd()
+    */
+    const uint8_t* MappedDocument::_getData() const {
+        return data;
+    }
+    size_t MappedDocument::_getCodeBegin() const {
+        return codeBegin;
+    }
+    size_t MappedDocument::_getCodeEnd() const {
+        return codeEnd;
+    }
+
+    // Unmaps the file if it's mapped (and not read into `buffer`)
+    void MappedDocument::unmap() {
+        #ifndef _WIN32
+        if (buffer.empty() && data != nullptr) {
+            munmap(const_cast<uint8_t*>(data), size);
+            data = nullptr;
+        }
+        #endif
+    }
+    // Node table entry `index`
+    uint64_t MappedDocument::nodeOffset(uint32_t index) const {
+        uint64_t offset = format::getU64(nodes + index*format::NODE_ENTRY_SIZE);
+        if (offset >= codeEnd - codeBegin) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read mapped file. The NODES section is corrupted.");
+        }
+        return offset;
+    }
+    uint32_t MappedDocument::nodeSubtreeSize(uint32_t index) const {
+        uint32_t subtreeSize = format::getU32(nodes + index*format::NODE_ENTRY_SIZE + 12);
+        // A node always contains itself. This also prevents endless loops in corrupted files
+        if (subtreeSize == 0 || subtreeSize > nodeCount - index) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read mapped file. The NODES section is corrupted.");
+        }
+        return subtreeSize;
+    }
+    uint32_t MappedDocument::nodeParent(uint32_t index) const {
+        uint32_t parent = format::getU32(nodes + index*format::NODE_ENTRY_SIZE + 8);
+        // Parents are always before their children
+        if (parent != format::NO_PARENT && parent >= index) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read mapped file. The NODES section is corrupted.");
+        }
+        return parent;
+    }
+    /**
+        Returns the node with the name specified among the nodes in [first, end)
+        that are siblings (each one after the subtree of the previous one)
+    */
+    std::optional<MappedNode> MappedDocument::findSibling(uint32_t first, uint32_t end, std::string_view name) const {
+        // Walk the path one level at a time
+        size_t start = 0;
+        while (true) {
+            size_t indexOfSlash = name.find_first_of('/', start);
+            std::string_view node = name.substr(start, (indexOfSlash == std::string_view::npos) ? std::string_view::npos : indexOfSlash - start);
+
+            uint32_t found = end;
+            for (uint32_t sibling = first; sibling < end; sibling += nodeSubtreeSize(sibling)) {
+                if (MappedNode(this, sibling).getName() == node) {
+                    found = sibling;
+                    break;
+                }
+            }
+            if (found == end) {
+                return std::nullopt;
+            }
+            if (indexOfSlash == std::string_view::npos) {
+                return MappedNode(this, found);
+            }
+            // Continue with the children of the node found
+            first = found + 1;
+            end = found + nodeSubtreeSize(found);
+            start = indexOfSlash + 1;
+        }
+    }
+    /**
+        Returns the node with the path specified using the PATHS section
+    */
+    std::optional<MappedNode> MappedDocument::findPath(std::string_view path) const {
+        const uint64_t hash = format::hashPath(path);
+        uint32_t slot = hash & (pathSlotCount - 1);
+        // The table is never full, but a corrupted one could be
+        for (uint32_t probe = 0; probe < pathSlotCount; probe++) {
+            const uint8_t* entry = paths + size_t(slot) * format::PATH_SLOT_SIZE;
+            uint32_t node = format::getU32(entry + 4);
+            if (node == format::NO_NODE) {
+                return std::nullopt;
+            }
+            if (format::getU32(entry) == uint32_t(hash >> 32) && node < nodeCount && hasPath(node, path)) {
+                return MappedNode(this, node);
+            }
+            slot = (slot + 1) & (pathSlotCount - 1);
+        }
+        return std::nullopt;
+    }
+    /**
+        Returns true if the path of the node is the one specified
+    */
+    bool MappedDocument::hasPath(uint32_t index, std::string_view path) const {
+        // Compare the names from the node to the root
+        size_t end = path.size();
+        while (true) {
+            size_t indexOfSlash = path.find_last_of('/', end == 0 ? 0 : end - 1);
+            size_t start = (indexOfSlash == std::string_view::npos || end == 0) ? 0 : indexOfSlash + 1;
+            if (MappedNode(this, index).getName() != path.substr(start, end - start)) {
+                return false;
+            }
+            uint32_t parent = nodeParent(index);
+            if (start == 0) {
+                return parent == format::NO_PARENT;
+            }
+            if (parent == format::NO_PARENT) {
+                return false;
+            }
+            index = parent;
+            end = start - 1;
+        }
+    }
+    /**
+        Returns how the attribute of the class is quantized or nullptr if it isn't
+    */
+    const format::QuantizedAttribute* MappedDocument::findQuantized(std::string_view className, std::string_view attribute) const {
+        if (quantized.empty() || !language->classExists(className)) {
+            return nullptr;
+        }
+        const uint32_t classID = language->getClassID(className);
+        const std::vector<std::string>& attributes = language->getAttributes(classID);
+        auto found = std::find(attributes.begin(), attributes.end(), attribute);
+        if (found == attributes.end()) {
+            return nullptr;
+        }
+        return format::findQuantized(quantized, classID, found - attributes.begin());
+    }
+    /**
+        Returns the name of the attribute
+    */
+    std::string_view MappedColumn::getName() const {
+        return name;
+    }
+    /**
+        Returns the data type of the attribute
+    */
+    type::Type MappedColumn::getType() const {
+        return type;
+    }
+    /**
+        Returns the number of rows of the column
+    */
+    size_t MappedColumn::getRowCount() const {
+        return rowCount;
+    }
+    /**
+        Returns true if the object of the row sets the attribute.
+        Throws a runtime error if the row doesn't exist
+    */
+    bool MappedColumn::isSet(size_t row) const {
+        if (row >= rowCount) {
+            throw std::runtime_error("ECLANG_ERROR: Row "+std::to_string(row)+" doesn't exist. The column has "+std::to_string(rowCount)+" rows.");
+        }
+        return (validity[row / 8] >> (row % 8)) & 1;
+    }
+    /**
+        Returns the bits that tell which rows set the attribute (one bit per row,
+        the lowest bit of the first byte is the first row)
+    */
+    const uint8_t* MappedColumn::getValidity() const {
+        return validity;
+    }
+    /**
+        Returns the value of a String or Markdown String column at the row specified.
+        Throws a runtime error if the column doesn't hold strings or the row doesn't exist
+    */
+    std::string_view MappedColumn::getString(size_t row) const {
+        if (type != type::STRING && type != type::STR_MD) {
+            throw std::runtime_error("ECLANG_ERROR: Column \""+std::string(name)+"\" doesn't hold strings.");
+        }
+        if (row >= rowCount) {
+            throw std::runtime_error("ECLANG_ERROR: Row "+std::to_string(row)+" doesn't exist. The column has "+std::to_string(rowCount)+" rows.");
+        }
+        // The offsets of the rows are followed by the characters
+        const uint64_t charactersBegin = (uint64_t(rowCount) + 1) * 4;
+        const uint32_t begin = format::getU32(values + row*4);
+        const uint32_t end = format::getU32(values + (row + 1)*4);
+        if (begin > end || end > valuesSize - charactersBegin) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+        }
+        return std::string_view(reinterpret_cast<const char*>(values + charactersBegin + begin), end - begin);
+    }
+    /**
+        Returns a pointer to the values of a number or vector column with values of
+        `size` bytes. Throws a runtime error if they can't be read (see getValues())
+    */
+    const uint8_t* MappedColumn::_getValues(size_t size) const {
+        if (type == type::STRING || type == type::STR_MD) {
+            throw std::runtime_error("ECLANG_ERROR: Column \""+std::string(name)+"\" holds strings, use getString() to read them.");
+        }
+        if (size != type::sizeOf(type)) {
+            throw std::runtime_error("ECLANG_ERROR: The values of column \""+std::string(name)+"\" are "+std::to_string(type::sizeOf(type))+" bytes, not "+std::to_string(size)+".");
+        }
+        return values;
+    }
+    MappedColumn::MappedColumn(std::string_view name, type::Type type, size_t rowCount, const uint8_t* validity, const uint8_t* values, uint64_t valuesSize) :
+        name(name), type(type), rowCount(rowCount), validity(validity), values(values), valuesSize(valuesSize) {}
+
+    /**
+        Returns the name of the class
+    */
+    std::string_view MappedTable::getClassName() const {
+        return className;
+    }
+    /**
+        Returns the number of rows (objects of the class)
+    */
+    size_t MappedTable::getRowCount() const {
+        return rowCount;
+    }
+    /**
+        Returns the index in the node table of the object of every row
+        (see MappedDocument::getNode())
+    */
+    const uint32_t* MappedTable::getNodes() const {
+        return reinterpret_cast<const uint32_t*>(nodes);
+    }
+    /**
+        Returns the index in the node table of the parent of the object of every
+        row (0xFFFFFFFF for objects in the root)
+    */
+    const uint32_t* MappedTable::getParents() const {
+        return reinterpret_cast<const uint32_t*>(parents);
+    }
+    /**
+        Returns the node of the object at the row specified.
+        Throws a runtime error if the row doesn't exist
+    */
+    MappedNode MappedTable::getNode(size_t row) const {
+        if (row >= rowCount) {
+            throw std::runtime_error("ECLANG_ERROR: Row "+std::to_string(row)+" doesn't exist. The table has "+std::to_string(rowCount)+" rows.");
+        }
+        return document->getNode(format::getU32(nodes + row*4));
+    }
+    /**
+        Returns the column of the attribute specified if any object of the class sets it
+    */
+    std::optional<MappedColumn> MappedTable::getColumn(std::string_view attribute) const {
+        for (const MappedColumn& column : columns) {
+            if (column.getName() == attribute) {
+                return column;
+            }
+        }
+        return std::nullopt;
+    }
+    /**
+        Returns all the columns of the table
+    */
+    const std::vector<MappedColumn>& MappedTable::getColumns() const {
+        return columns;
+    }
+    MappedTable::MappedTable(const MappedDocument* document, std::string_view className, size_t rowCount, const uint8_t* nodes, const uint8_t* parents) :
+        document(document), className(className), rowCount(rowCount), nodes(nodes), parents(parents) {}
+}
@@ -1,20 +1,32 @@
 #include "classes/object.hpp"
 #include "classes/attribute.hpp"
+#include "classes/class.hpp"
+#include "util/traversal.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace eclang {
     /**
-        Constructs the Object object with the class name and the object's name
+        Constructs the Object object with the class name and the object's name.
+        The strings are not copied: they're handles of the string table of the
+        EcLang object that creates this object (see StringTable::intern()) and
+        must outlive it.
+        `defaults` are the default values of the registered class of the object
+        (see Class::_getDefaults()), nullptr if it doesn't have any.
     */
-    Object::Object(std::string className, std::string name, uint8_t sourceFileID) {
-        // Copy data to object
+    Object::Object(const std::string* className, const std::string* name, uint8_t sourceFileID, std::shared_ptr<ClassDefaults> defaults) {
+        // Keep the handles of the interned strings
         this->className = className;
         this->name = name;
         this->sourceFileID = sourceFileID;
+        this->defaults = std::move(defaults);
     }
     /**
         Delete all the registered Attributes
@@ -23,19 +35,43 @@ namespace eclang {
         for (Attribute* a : attributes) {
             delete a;
         }
-        // It's recursin' time!
-        for (Object* o : children) {
-            delete o;
-        }
+        // Delete all the descendants without recursion. Every object is deleted after
+        // its own children and its list is cleared first, so its destructor only
+        // has to delete its attributes.
+        traversal::walk(children,
+            [](traversal::Step&) { return traversal::action::VISIT_CHILDREN; },
+            [](traversal::Step& step) {
+                step.object->children.clear();
+                delete step.object;
+            }
+        );
     }
 
     /**
         Adds an attribute. This attribute must contain data.
+        Attributes equal to the default value of their class are deleted instead.
         Do not call this manually.
     */
     void Object::_addAttribute(Attribute* a) {
+        uint32_t classAttributeID;
+        Attribute* defaultValue = defaultOf(a->getName(), classAttributeID);
+        if (defaultValue != nullptr && a->hasSameValue(*defaultValue)) {
+            delete a;
+            return;
+        }
         attributes.push_back(a);
     }
+    /**
+        Adds an array of attributes (see _addAttribute()), allocating the space
+        for all of them at once.
+        Do not call this manually.
+    */
+    void Object::_addAttributes(const std::vector<Attribute*>& a) {
+        attributes.reserve(attributes.size() + a.size());
+        for (Attribute* attribute : a) {
+            _addAttribute(attribute);
+        }
+    }
     /**
         Adds an Object object as a child of this object.
         Do not call this manually.
@@ -47,35 +83,157 @@ namespace eclang {
         Adds an array of Objects as children of this object.
         Do not call this manually.
     */
-    void Object::_addChildren(std::vector<Object*> o) {
+    void Object::_addChildren(const std::vector<Object*>& o) {
         children.insert(children.end(), o.begin(), o.end());
     }
+    /**
+        Allocates space for the number of children specified.
+        Do not call this manually.
+    */
+    void Object::_reserveChildren(size_t count) {
+        children.reserve(count);
+    }
+    /**
+        Returns a copy of this object, its attributes and all of its children
+        (copied too). The copies point to the same interned strings and belong
+        to the file specified (see getSourceFileID()).
+        Do not call this manually.
+    */
+    Object* Object::_copy(uint8_t sourceFileID) {
+        Object* root = nullptr;
+        // Copy of the object being visited at every depth (the parent of the next copies)
+        std::vector<Object*> copies;
+        const std::vector<Object*> roots {this};
+        traversal::walk(roots,
+            [&](traversal::Step& step) {
+                Object* object = step.object;
+                Object* copy = new Object(object->className, object->name, sourceFileID, object->defaults);
+                copy->attributes.reserve(object->attributes.size());
+                for (Attribute* a : object->attributes) {
+                    copy->attributes.push_back(new Attribute(*a));
+                }
+                copy->children.reserve(object->children.size());
+                if (step.depth == 0) {
+                    root = copy;
+                } else {
+                    copies[step.depth-1]->children.push_back(copy);
+                }
+                copies.resize(step.depth);
+                copies.push_back(copy);
+                return traversal::action::VISIT_CHILDREN;
+            },
+            [](traversal::Step&) {}
+        );
+        return root;
+    }
+    /**
+        Makes this object an instance of the prototype (an object of the same class):
+        it gets copies of the attributes of the prototype it doesn't set and of its
+        children (after its own). The attributes keep the order of the prototype,
+        followed by the ones the prototype doesn't have.
+        Do not call this manually.
+    */
+    void Object::_instantiate(Object* prototype) {
+        std::vector<Attribute*> own = std::move(attributes);
+        attributes.clear();
+        attributes.reserve(prototype->attributes.size() + own.size());
+        for (Attribute* a : prototype->attributes) {
+            auto set = std::find_if(own.begin(), own.end(), [&](Attribute* o) { return o != nullptr && o->getName() == a->getName(); });
+            if (set == own.end()) {
+                attributes.push_back(new Attribute(*a));
+                continue;
+            }
+            attributes.push_back(*set);
+            *set = nullptr;
+        }
+        for (Attribute* a : own) {
+            if (a != nullptr) {
+                attributes.push_back(a);
+            }
+        }
+        children.reserve(children.size() + prototype->children.size());
+        for (Object* child : prototype->children) {
+            children.push_back(child->_copy(sourceFileID));
+        }
+    }
+    /**
+        Moves the attributes of `overrides` into this object. They replace the ones
+        with the same name, or remove them if they're equal to their default value.
+        Do not call this manually.
+    */
+    void Object::_override(Object& overrides) {
+        for (Attribute* a : overrides.attributes) {
+            auto set = std::find_if(attributes.begin(), attributes.end(), [&](Attribute* o) { return o->getName() == a->getName(); });
+            if (set == attributes.end()) {
+                _addAttribute(a);
+                continue;
+            }
+            delete *set;
+            uint32_t classAttributeID;
+            Attribute* defaultValue = defaultOf(a->getName(), classAttributeID);
+            if (defaultValue != nullptr && a->hasSameValue(*defaultValue)) {
+                attributes.erase(set);
+                delete a;
+            } else {
+                *set = a;
+            }
+        }
+        overrides.attributes.clear();
+    }
+    /**
+        Returns a reference to the children of this object.
+        Used internally to walk the tree without copying vectors.
+    */
+    const std::vector<Object*>& Object::_getChildren() {
+        return children;
+    }
+    /**
+        Returns a reference to the attributes of this object.
+        Used internally to read values without copying vectors.
+    */
+    const std::vector<Attribute*>& Object::_getAttributes() {
+        return attributes;
+    }
+    /**
+        Returns the interned name of this object. Objects from the same
+        EcLang with the same name return the same pointer.
+    */
+    const std::string* Object::_getNameHandle() {
+        return name;
+    }
+    /**
+        Returns the interned class name of this object. Objects from the same
+        EcLang with the same class return the same pointer.
+    */
+    const std::string* Object::_getClassHandle() {
+        return className;
+    }
 
     /**
         Returns the name of the object
     */
-    std::string Object::getName() {
-        return name;
+    const std::string& Object::getName() {
+        return *name;
     }
     /**
         Returns the name of the class.
     */
-    std::string Object::getClassName() {
-        return className;
+    const std::string& Object::getClassName() {
+        return *className;
     }
 
     /**
         Returns all children of this object.
         The vector may be empty
     */
-    std::vector<Object*> Object::getObjects() {
+    const std::vector<Object*>& Object::getObjects() {
         return children;
     }
     /**
         Returns the Object objects with the class name specified
         from the current file as a vector.
     */
-    std::vector<Object*> Object::getObjectsByClass(std::string className) {
+    std::vector<Object*> Object::getObjectsByClass(std::string_view className) {
         std::vector<Object*> objsWithClass;
         for (Object* o : children) {
             if (o->getClassName() == className) {
@@ -88,28 +246,33 @@ namespace eclang {
         Returns the Object object with the name specified.
         The pointer returned may be nullptr.
     */
-    Object* Object::getObject(std::string name) {
-        // Is this a path?
-        size_t indexOfSlash = name.find_first_of('/');
-        if (indexOfSlash != std::string::npos) {
-            std::string firstNode = name.substr(0, indexOfSlash);
-            for (Object* o : children) {
-                if (o->getName() == firstNode) {
-                    // Get Node by path from Object (This is recursive)
-                    return o->getObject(name.substr(indexOfSlash+1));
+    Object* Object::getObject(std::string_view name) {
+        // Go down one level for every node in the path (node1/node2/node3)
+        Object* current = this;
+        size_t start = 0;
+        while (current != nullptr) {
+            size_t indexOfSlash = name.find_first_of('/', start);
+            std::string_view node = name.substr(start, (indexOfSlash == std::string_view::npos) ? std::string_view::npos : indexOfSlash - start);
+
+            Object* next = nullptr;
+            for (Object* o : current->children) {
+                if (*o->name == node) {
+                    next = o;
+                    break;
                 }
             }
-        } else {
-            for (Object* o : children) {
-                if (o->getName() == name) {
-                    return o;
-                }
+            // This was the last node in the path
+            if (indexOfSlash == std::string_view::npos) {
+                return next;
             }
+            current = next;
+            start = indexOfSlash+1;
         }
         return nullptr;
     }
     /**
-        Returns the names of all registered attributes
+        Returns the names of all the attributes set in this object (attributes
+        that have the default value of their class aren't included)
     */
     std::vector<std::string> Object::getAttributes() {
         std::vector<std::string> attributesStr;
@@ -121,9 +284,18 @@ namespace eclang {
 
     /**
         Returns the ID of the attribute.
-        This ID is required to use the other methods
+        This ID is required to use the other methods.
+        Attributes that aren't set but have a default value in the class of
+        the object also have an ID, which reads the default value.
+
+        Attributes set have the IDs 0, 1, 2... in the order they were set.
+        Default values have the ID UINT8_MAX-1 minus the ID of the attribute
+        in the class (254, 253, 252...), so their ID doesn't change when other
+        attributes are set and reads the value set if the attribute is set later.
+        A default value whose ID would be the ID of an attribute set doesn't
+        have an ID (-1 is returned).
     */
-    uint8_t Object::getIDOf(std::string attribute) {
+    uint8_t Object::getIDOf(std::string_view attribute) {
         // If for whatever reason we have too many attributes throw error
         checkAttributesNumber();
 
@@ -134,6 +306,11 @@ namespace eclang {
                 return i;
             }
         }
+        // Default values count down from UINT8_MAX-1 by their ID in the class
+        uint32_t classAttributeID;
+        if (defaultOf(attribute, classAttributeID) != nullptr && classAttributeID < UINT8_MAX - attributes.size()) {
+            return UINT8_MAX - 1 - classAttributeID;
+        }
         // If we didn't find it, return invalid ID
         return -1;
     }
@@ -152,7 +329,7 @@ namespace eclang {
         the same type that you need/expect
     */
     type::Type Object::getTypeOf(uint8_t attribute) {
-        return attributes.at(attribute)->getType();
+        return attributeAt(attribute)->getType();
     }
 
     
@@ -161,77 +338,77 @@ namespace eclang {
 
     // Int
     int8_t Object::getInt8Of(uint8_t attribute) {
-        return attributes.at(attribute)->getInt8();
+        return attributeAt(attribute)->getInt8();
     }
     int16_t Object::getInt16Of(uint8_t attribute) {
-        return attributes.at(attribute)->getInt16();
+        return attributeAt(attribute)->getInt16();
     }
     int32_t Object::getInt32Of(uint8_t attribute) {
-        return attributes.at(attribute)->getInt32();
+        return attributeAt(attribute)->getInt32();
     }
     int64_t Object::getInt64Of(uint8_t attribute) {
-        return attributes.at(attribute)->getInt64();
+        return attributeAt(attribute)->getInt64();
     }
     // Uint
     uint8_t Object::getUint8Of(uint8_t attribute) {
-        return attributes.at(attribute)->getUint8();
+        return attributeAt(attribute)->getUint8();
     }
     uint16_t Object::getUint16Of(uint8_t attribute) {
-        return attributes.at(attribute)->getUint16();
+        return attributeAt(attribute)->getUint16();
     }
     uint32_t Object::getUint32Of(uint8_t attribute) {
-        return attributes.at(attribute)->getUint32();
+        return attributeAt(attribute)->getUint32();
     }
     uint64_t Object::getUint64Of(uint8_t attribute) {
-        return attributes.at(attribute)->getUint64();
+        return attributeAt(attribute)->getUint64();
     }
     // Decimal
     float Object::getFloatOf(uint8_t attribute) {
-        return attributes.at(attribute)->getFloat();
+        return attributeAt(attribute)->getFloat();
     }
     double Object::getDoubleOf(uint8_t attribute) {
-        return attributes.at(attribute)->getDouble();
+        return attributeAt(attribute)->getDouble();
     }
     // Strings
     std::string Object::getStringOf(uint8_t attribute) { // Used for String and Markdown Strings. The only difference between strings and MD strings is how the program interprets them
-        return attributes.at(attribute)->getString();
+        return attributeAt(attribute)->getString();
     }
     // Vectors
     vec2i Object::getVec2iOf(uint8_t attribute) { // int
-        return attributes.at(attribute)->getVec2i();
+        return attributeAt(attribute)->getVec2i();
     }
     vec3i Object::getVec3iOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec3i();
+        return attributeAt(attribute)->getVec3i();
     }
     vec4i Object::getVec4iOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec4i();
+        return attributeAt(attribute)->getVec4i();
     }
     vec2l Object::getVec2lOf(uint8_t attribute) { // long
-        return attributes.at(attribute)->getVec2l();
+        return attributeAt(attribute)->getVec2l();
     }
     vec3l Object::getVec3lOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec3l();
+        return attributeAt(attribute)->getVec3l();
     }
     vec4l Object::getVec4lOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec4l();
+        return attributeAt(attribute)->getVec4l();
     }
     vec2f Object::getVec2fOf(uint8_t attribute) { // float
-        return attributes.at(attribute)->getVec2f();
+        return attributeAt(attribute)->getVec2f();
     }
     vec3f Object::getVec3fOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec3f();
+        return attributeAt(attribute)->getVec3f();
     }
     vec4f Object::getVec4fOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec4f();
+        return attributeAt(attribute)->getVec4f();
     }
     vec2d Object::getVec2dOf(uint8_t attribute) { // double
-        return attributes.at(attribute)->getVec2d();
+        return attributeAt(attribute)->getVec2d();
     }
     vec3d Object::getVec3dOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec3d();
+        return attributeAt(attribute)->getVec3d();
     }
     vec4d Object::getVec4dOf(uint8_t attribute) {
-        return attributes.at(attribute)->getVec4d();
+        return attributeAt(attribute)->getVec4d();
     }
 
 
@@ -243,9 +420,49 @@ namespace eclang {
     void Object::checkAttributesNumber() {
         if (attributes.size() > UINT8_MAX) {
             throw std::runtime_error(
-                "ECLANG_ERROR: Too many attributes found on \""+name+"\" class."
+                "ECLANG_ERROR: Too many attributes found on \""+*name+"\" class."
                 "("+std::to_string(attributes.size())+" attributes. Maximum is "+std::to_string(UINT8_MAX)+")"
             );
         }
     }
+    /**
+        Returns the attribute with the ID specified (see getIDOf()): a set attribute
+        or a default value of the class. Throws an out of range error if there isn't one
+    */
+    Attribute* Object::attributeAt(uint8_t attribute) {
+        if (attribute < attributes.size()) {
+            return attributes[attribute];
+        }
+        // Default values have the ID UINT8_MAX-1 minus their ID in the class
+        const uint32_t classAttributeID = UINT8_MAX - 1 - uint32_t(attribute);
+        if (defaults == nullptr || attribute == UINT8_MAX || classAttributeID >= defaults->attributes.size()
+            || defaults->attributes[classAttributeID].getRawValue() == nullptr) {
+            throw std::out_of_range("ECLANG_ERROR: Invalid attribute ID ("+std::to_string(attribute)+") in \""+*name+"\".");
+        }
+        // The attribute may have been set after its ID was returned
+        const std::string& name = defaults->names[classAttributeID];
+        for (Attribute* a : attributes) {
+            if (a->getName() == name) {
+                return a;
+            }
+        }
+        return &defaults->attributes[classAttributeID];
+    }
+    /**
+        Returns the default value of the attribute in the class of the object and sets
+        `classAttributeID` to the ID of the attribute in the class. Returns nullptr
+        if the attribute doesn't have a default value
+    */
+    Attribute* Object::defaultOf(std::string_view attribute, uint32_t& classAttributeID) {
+        if (defaults == nullptr) {
+            return nullptr;
+        }
+        auto iterator = std::find(defaults->names.begin(), defaults->names.end(), attribute);
+        if (iterator == defaults->names.end()) {
+            return nullptr;
+        }
+        classAttributeID = iterator - defaults->names.begin();
+        Attribute& defaultValue = defaults->attributes[classAttributeID];
+        return defaultValue.getRawValue() != nullptr ? &defaultValue : nullptr;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,1076 @@
+#include "binaryFormat.hpp"
+#include "compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace eclang::format {
+    /**
+        Returns the section of the type specified or nullptr if the file
+        doesn't have it
+    */
+    const SectionEntry* Container::find(uint32_t type) const {
+        for (const SectionEntry& s : sections) {
+            if (s.type == type) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+        Returns the index of the string in `strings`, adding it if it's not there
+    */
+    uint32_t Layout::addString(const std::string& string) {
+        auto it = stringIndices.find(string);
+        if (it != stringIndices.end()) {
+            return it->second;
+        }
+        uint32_t index = strings.size();
+        strings.push_back(string);
+        stringIndices.emplace(string, index);
+        return index;
+    }
+    /**
+        Returns the table of the class, adding it if it's not there
+    */
+    Table& Layout::table(uint32_t classID) {
+        auto it = tableIndices.find(classID);
+        if (it != tableIndices.end()) {
+            return tables[it->second];
+        }
+        tableIndices.emplace(classID, tables.size());
+        tables.push_back({classID, {}, {}, {}});
+        return tables.back();
+    }
+    /**
+        Returns the column of the attribute, adding it if it's not there
+    */
+    Column& Table::column(uint32_t attribute, type::Type type) {
+        for (Column& c : columns) {
+            if (c.attribute == attribute) {
+                return c;
+            }
+        }
+        columns.push_back({attribute, type, {}, {}, {}, {}});
+        return columns.back();
+    }
+    /**
+        Returns the value of the key (MAX_VALUE_SIZE bytes), adding it as 0s if it's not there
+    */
+    uint8_t* DeltaScope::find(uint32_t key) {
+        if (hint < keys.size() && keys[hint] == key) {
+            return values[hint++].data();
+        }
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) {
+                hint = i + 1;
+                return values[i].data();
+            }
+        }
+        keys.push_back(key);
+        values.push_back({});
+        hint = keys.size();
+        return values.back().data();
+    }
+
+    DeltaContext::DeltaContext() : scopes(1) {}
+    /**
+        Starts with the values of the previous siblings of the first object
+    */
+    DeltaContext::DeltaContext(const DeltaScope& previous) : scopes(1, previous) {}
+    /**
+        Called for every SCOPE_ENTER and SCOPE_EXIT instruction
+    */
+    void DeltaContext::enterScope() {
+        if (open == scopes.size()) {
+            scopes.emplace_back();
+        } else {
+            scopes[open].keys.clear();
+            scopes[open].values.clear();
+        }
+        open++;
+    }
+    void DeltaContext::exitScope() {
+        if (open > 1) {
+            open--;
+        }
+    }
+    /**
+        Returns the previous value of an attribute of the object whose scope is open
+        (MAX_VALUE_SIZE bytes, 0s if none of its previous siblings of its class set it)
+    */
+    uint8_t* DeltaContext::previous(uint32_t classID, uint8_t attributeID) {
+        return scopes[open >= 2 ? open - 2 : 0].find(deltaKey(classID, attributeID));
+    }
+
+    /**
+        Appends the numbers to the buffer in little endian
+    */
+    void putU16(std::vector<uint8_t>& buffer, uint16_t value) {
+        for (int i = 0; i < 2; i++) buffer.push_back(uint8_t(value >> (i*8)));
+    }
+    void putU32(std::vector<uint8_t>& buffer, uint32_t value) {
+        for (int i = 0; i < 4; i++) buffer.push_back(uint8_t(value >> (i*8)));
+    }
+    void putU64(std::vector<uint8_t>& buffer, uint64_t value) {
+        for (int i = 0; i < 8; i++) buffer.push_back(uint8_t(value >> (i*8)));
+    }
+    /**
+        Reads little endian numbers. The caller checks the bounds
+    */
+    uint16_t getU16(const uint8_t* data) {
+        return uint16_t(data[0] | (data[1] << 8));
+    }
+    uint32_t getU32(const uint8_t* data) {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; i--) value = (value << 8) | data[i];
+        return value;
+    }
+    uint64_t getU64(const uint8_t* data) {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; i--) value = (value << 8) | data[i];
+        return value;
+    }
+
+    /**
+        How a value of a type is stored with the VARINT flag: the number of
+        integers (`count`, 0 for types stored as they are), the size of each one
+        in memory and whether they're zigzag-encoded (signed)
+    */
+    VarintLayout varintLayout(type::Type type) {
+        switch (type) {
+        case type::INT16:  return {1, 2, true};
+        case type::INT32:  return {1, 4, true};
+        case type::INT64:  return {1, 8, true};
+        case type::UINT16: return {1, 2, false};
+        case type::UINT32: return {1, 4, false};
+        case type::UINT64: return {1, 8, false};
+        case type::VEC2I:  return {2, 4, true};
+        case type::VEC3I:  return {3, 4, true};
+        case type::VEC4I:  return {4, 4, true};
+        case type::VEC2L:  return {2, 8, true};
+        case type::VEC3L:  return {3, 8, true};
+        case type::VEC4L:  return {4, 8, true};
+        default:           return {0, 0, false};
+        }
+    }
+
+    /**
+        Returns the alignment of a value of the type in ALIGNED files: the biggest power
+        of two (up to MAX_VALUE_ALIGNMENT) that divides its size. 1 for strings
+    */
+    size_t valueAlignment(type::Type type) {
+        const size_t size = type::sizeOf(type);
+        if (size == 0) {
+            return 1;
+        }
+        return std::min(size & (~size + 1), MAX_VALUE_ALIGNMENT);
+    }
+    /**
+        Returns the number of padding bytes written before a value of the type that
+        would start at `position` (from the start of the file) in a file with the flags
+        specified. 0 if the file isn't ALIGNED or the value is a string or varints
+    */
+    size_t alignmentPadding(uint64_t position, type::Type type, uint16_t flags) {
+        if (!(flags & flag::ALIGNED) || ((flags & flag::VARINT) && varintLayout(type).count > 0)) {
+            return 0;
+        }
+        const size_t alignment = valueAlignment(type);
+        return (alignment - position % alignment) % alignment;
+    }
+    /**
+        Returns true if this machine stores numbers in little endian, the order
+        of the values of ALIGNED files
+    */
+    bool isLittleEndian() {
+        const uint16_t one = 1;
+        uint8_t first;
+        std::memcpy(&first, &one, 1);
+        return first == 1;
+    }
+
+    namespace {
+        /**
+            Adds (or subtracts) the components of two values of the type that are integers
+            of `Width` bytes, wrapping around
+        */
+        template<class Width>
+        void combineIntegers(size_t count, const uint8_t* a, const uint8_t* b, uint8_t* result, bool subtract) {
+            for (size_t i = 0; i < count; i++) {
+                Width x, y;
+                std::memcpy(&x, a + i*sizeof(Width), sizeof(Width));
+                std::memcpy(&y, b + i*sizeof(Width), sizeof(Width));
+                Width z = subtract ? Width(x - y) : Width(x + y);
+                std::memcpy(result + i*sizeof(Width), &z, sizeof(Width));
+            }
+        }
+        /**
+            Combines a value with the previous one (see the DELTA flag): `a - b` (or `a + b`)
+            for integers and `a ^ b` for floats and doubles
+        */
+        void combineDelta(type::Type type, const uint8_t* a, const uint8_t* b, uint8_t* result, bool subtract) {
+            switch (type) {
+            case type::INT8: case type::UINT8:
+                combineIntegers<uint8_t>(1, a, b, result, subtract); break;
+            case type::INT16: case type::UINT16:
+                combineIntegers<uint16_t>(1, a, b, result, subtract); break;
+            case type::INT32: case type::UINT32:
+                combineIntegers<uint32_t>(1, a, b, result, subtract); break;
+            case type::INT64: case type::UINT64:
+                combineIntegers<uint64_t>(1, a, b, result, subtract); break;
+            case type::VEC2I: case type::VEC3I: case type::VEC4I:
+                combineIntegers<uint32_t>(type::sizeOf(type) / 4, a, b, result, subtract); break;
+            case type::VEC2L: case type::VEC3L: case type::VEC4L:
+                combineIntegers<uint64_t>(type::sizeOf(type) / 8, a, b, result, subtract); break;
+            default:
+                for (size_t i = 0; i < type::sizeOf(type); i++) {
+                    result[i] = a[i] ^ b[i];
+                }
+                break;
+            }
+        }
+    }
+    namespace {
+        /**
+            Converts a float to the nearest half float (IEEE 754 binary16). Numbers too big
+            become infinity and numbers too small become 0
+        */
+        uint16_t floatToHalf(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, 4);
+            const uint32_t sign = (bits >> 16) & 0x8000;
+            const uint32_t exponent = (bits >> 23) & 0xFF;
+            uint32_t mantissa = bits & 0x7FFFFF;
+            // Infinity and NaN
+            if (exponent == 0xFF) {
+                return uint16_t(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+            }
+            const int halfExponent = int(exponent) - 127 + 15;
+            if (halfExponent >= 31) {
+                return uint16_t(sign | 0x7C00);
+            }
+            // Subnormal halves (or 0)
+            if (halfExponent <= 0) {
+                if (halfExponent < -10) {
+                    return uint16_t(sign);
+                }
+                mantissa |= 0x800000;
+                const uint32_t shift = 14 - halfExponent;
+                uint32_t half = mantissa >> shift;
+                const uint32_t rest = mantissa & ((1u << shift) - 1);
+                const uint32_t halfway = 1u << (shift - 1);
+                if (rest > halfway || (rest == halfway && (half & 1))) {
+                    half++;
+                }
+                return uint16_t(sign | half);
+            }
+            // Round to nearest even. A carry into the exponent is still right
+            uint32_t half = (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+            const uint32_t rest = mantissa & 0x1FFF;
+            if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+                half++;
+            }
+            return uint16_t(sign | half);
+        }
+        /**
+            Converts a half float to a float (exactly)
+        */
+        float halfToFloat(uint16_t half) {
+            const uint32_t sign = uint32_t(half & 0x8000) << 16;
+            uint32_t exponent = (half >> 10) & 0x1F;
+            uint32_t mantissa = half & 0x3FF;
+            uint32_t bits;
+            if (exponent == 0x1F) {
+                bits = sign | 0x7F800000 | (mantissa << 13);
+            } else if (exponent != 0) {
+                bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            } else if (mantissa == 0) {
+                bits = sign;
+            } else {
+                // Subnormal: shift the mantissa until it has the implicit 1
+                exponent = 113;
+                while (!(mantissa & 0x400)) {
+                    mantissa <<= 1;
+                    exponent--;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+            }
+            float value;
+            std::memcpy(&value, &bits, 4);
+            return value;
+        }
+        // Largest integer of a fixed-point format
+        uint32_t fixedSteps(uint32_t format) {
+            return format == QUANTIZE_FIXED8 ? 0xFF : 0xFFFF;
+        }
+        // True if the components of the type are doubles (DOUBLE and double vectors)
+        bool hasDoubles(type::Type type) {
+            return type == type::DOUBLE || type == type::VEC2D || type == type::VEC3D || type == type::VEC4D;
+        }
+    }
+    /**
+        Returns the number of components of a type that can be quantized (FLOAT and DOUBLE
+        and their vectors), 0 for any other type
+    */
+    size_t quantizedComponents(type::Type type) {
+        switch (type) {
+        case type::FLOAT: case type::DOUBLE: return 1;
+        case type::VEC2F: case type::VEC2D: return 2;
+        case type::VEC3F: case type::VEC3D: return 3;
+        case type::VEC4F: case type::VEC4D: return 4;
+        default:          return 0;
+        }
+    }
+    /**
+        Returns the size of a value of the type quantized as specified
+    */
+    size_t quantizedSize(type::Type type, const QuantizedAttribute& quantized) {
+        return quantizedComponents(type) * (quantized.format == QUANTIZE_FIXED8 ? 1 : 2);
+    }
+    /**
+        Appends the value (a number or vector of the type specified, as stored in memory)
+        quantized as specified: every component is converted to a half float or mapped from
+        [min, max] (clamped) to the integers of 8 or 16 bits, in little endian
+    */
+    void quantizeValue(std::vector<uint8_t>& buffer, type::Type type, const uint8_t* value, const QuantizedAttribute& quantized) {
+        const bool doubles = hasDoubles(type);
+        for (size_t i = 0; i < quantizedComponents(type); i++) {
+            double component;
+            if (doubles) {
+                std::memcpy(&component, value + i*8, 8);
+            } else {
+                float f;
+                std::memcpy(&f, value + i*4, 4);
+                component = f;
+            }
+            if (quantized.format == QUANTIZE_HALF) {
+                putU16(buffer, floatToHalf(float(component)));
+                continue;
+            }
+            // NaN becomes `min`
+            const double steps = fixedSteps(quantized.format);
+            double normalized = (component - quantized.min) / (double(quantized.max) - quantized.min);
+            normalized = normalized > 0 ? std::min(normalized, 1.0) : 0;
+            const uint32_t fixed = uint32_t(normalized * steps + 0.5);
+            if (quantized.format == QUANTIZE_FIXED8) {
+                buffer.push_back(uint8_t(fixed));
+            } else {
+                putU16(buffer, uint16_t(fixed));
+            }
+        }
+    }
+    /**
+        Converts a value written by quantizeValue() back to the type (as stored in memory)
+    */
+    void dequantizeValue(const uint8_t* data, type::Type type, const QuantizedAttribute& quantized, uint8_t* value) {
+        const bool doubles = hasDoubles(type);
+        const double scale = (double(quantized.max) - quantized.min) / fixedSteps(quantized.format);
+        for (size_t i = 0; i < quantizedComponents(type); i++) {
+            double component;
+            switch (quantized.format) {
+            case QUANTIZE_HALF:   component = halfToFloat(getU16(data + i*2)); break;
+            case QUANTIZE_FIXED8: component = quantized.min + data[i] * scale; break;
+            default:              component = quantized.min + getU16(data + i*2) * scale; break;
+            }
+            if (doubles) {
+                std::memcpy(value + i*8, &component, 8);
+            } else {
+                const float f = float(component);
+                std::memcpy(value + i*4, &f, 4);
+            }
+        }
+    }
+    /**
+        Replaces `previous` (a number or vector of the type specified, as stored in memory) by
+        `value` and writes the difference between them (see the DELTA flag) into `delta`
+    */
+    void subtractDelta(type::Type type, const uint8_t* value, uint8_t* previous, uint8_t* delta) {
+        combineDelta(type, value, previous, delta, true);
+        std::memcpy(previous, value, type::sizeOf(type));
+    }
+    /**
+        Adds a difference written by subtractDelta() to `previous`, which becomes the value
+    */
+    void addDelta(type::Type type, const uint8_t* delta, uint8_t* previous) {
+        combineDelta(type, previous, delta, previous, false);
+    }
+
+    /**
+        Appends an unsigned LEB128 integer to the buffer
+    */
+    void putVarint(std::vector<uint8_t>& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        buffer.push_back(uint8_t(value));
+    }
+    /**
+        Reads the LEB128 integer at `data` without reading past `end`.
+        Returns the position after it or nullptr if it's truncated or too long
+    */
+    const uint8_t* getVarint(const uint8_t* data, const uint8_t* end, uint64_t& value) {
+        if (data >= end) {
+            return nullptr;
+        }
+        // Most IDs and values are small
+        if (data[0] < 0x80) {
+            value = data[0];
+            return data + 1;
+        }
+        // With 8 bytes available, numbers of up to 56 bits are decoded without
+        // a loop: find the last byte with the continuation bits and pack the
+        // 7 bit groups together
+        if (end - data >= 8) {
+            uint64_t word = getU64(data);
+            uint64_t stops = ~word & 0x8080808080808080ull;
+            if (stops != 0) {
+                // Bytes up to the first one without the continuation bit
+                uint64_t bytes = ((stops & (~stops + 1)) << 1) - 1;
+                size_t length = ((bytes & 0x0101010101010101ull) * 0x0101010101010101ull) >> 56;
+                word &= bytes & 0x7f7f7f7f7f7f7f7full;
+                word = ((word & 0x7f007f007f007f00ull) >> 1) | (word & 0x007f007f007f007full);
+                word = ((word & 0x3fff00003fff0000ull) >> 2) | (word & 0x00003fff00003fffull);
+                word = ((word & 0x0fffffff00000000ull) >> 4) | (word & 0x000000000fffffffull);
+                value = word;
+                return data + length;
+            }
+        }
+        value = 0;
+        for (size_t i = 0; i < MAX_VARINT_SIZE && data + i < end; i++) {
+            // The 10th byte can only hold the last bit of a 64 bit number
+            if (i == MAX_VARINT_SIZE - 1 && data[i] > 1) {
+                return nullptr;
+            }
+            value |= uint64_t(data[i] & 0x7f) << (7*i);
+            if (data[i] < 0x80) {
+                return data + i + 1;
+            }
+        }
+        return nullptr;
+    }
+    /**
+        Appends the value (a number or vector of the type specified, as stored in
+        memory) as varints. The type must have a VarintLayout with count > 0
+    */
+    void putVarintValue(std::vector<uint8_t>& buffer, type::Type type, const void* value) {
+        VarintLayout layout = varintLayout(type);
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        for (size_t i = 0; i < layout.count; i++) {
+            const uint8_t* component = bytes + i*layout.width;
+            if (layout.isSigned) {
+                int64_t number;
+                switch (layout.width) {
+                case 2: { int16_t n; std::memcpy(&n, component, 2); number = n; } break;
+                case 4: { int32_t n; std::memcpy(&n, component, 4); number = n; } break;
+                default: std::memcpy(&number, component, 8); break;
+                }
+                // Zigzag: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+                putVarint(buffer, (uint64_t(number) << 1) ^ uint64_t(number >> 63));
+            } else {
+                uint64_t number = 0;
+                std::memcpy(&number, component, layout.width); // Little endian
+                putVarint(buffer, number);
+            }
+        }
+    }
+    /**
+        Reads a value written by putVarintValue() into `value` (as stored in memory).
+        Returns the position after it or nullptr if it's truncated or a number doesn't
+        fit in the type
+    */
+    const uint8_t* getVarintValue(const uint8_t* data, const uint8_t* end, type::Type type, void* value) {
+        VarintLayout layout = varintLayout(type);
+        uint8_t* bytes = static_cast<uint8_t*>(value);
+        for (size_t i = 0; i < layout.count; i++) {
+            uint64_t encoded;
+            data = getVarint(data, end, encoded);
+            if (data == nullptr) {
+                return nullptr;
+            }
+            uint8_t* component = bytes + i*layout.width;
+            if (layout.isSigned) {
+                int64_t number = int64_t(encoded >> 1) ^ -int64_t(encoded & 1);
+                switch (layout.width) {
+                case 2: {
+                    if (number < INT16_MIN || number > INT16_MAX) return nullptr;
+                    int16_t n = int16_t(number);
+                    std::memcpy(component, &n, 2);
+                } break;
+                case 4: {
+                    if (number < INT32_MIN || number > INT32_MAX) return nullptr;
+                    int32_t n = int32_t(number);
+                    std::memcpy(component, &n, 4);
+                } break;
+                default: std::memcpy(component, &number, 8); break;
+                }
+            } else {
+                if (layout.width < 8 && (encoded >> (layout.width*8)) != 0) {
+                    return nullptr;
+                }
+                std::memcpy(component, &encoded, layout.width); // Little endian
+            }
+        }
+        return data;
+    }
+
+    /**
+        Returns the FNV-1a hash of a path, continuing from the hash of the
+        path before it. The path of a node is hashed as
+        hashPath(name, hashPath("/", hash of the path of its parent))
+    */
+    uint64_t hashPath(std::string_view path, uint64_t hash) {
+        return hashBytes(path.data(), path.size(), hash);
+    }
+    /**
+        Returns the FNV-1a hash of `size` bytes, continuing from the hash of the data
+        before them (see hashPath())
+    */
+    uint64_t hashBytes(const void* data, size_t size, uint64_t hash) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+        Returns true if the data at `start` (the position after the identifier
+        bytes and their terminator) is a version 2 (or later) file
+    */
+    bool isVersioned(const uint8_t* data, size_t size, size_t start) {
+        return start < size && data[start] == FORMAT_MARKER;
+    }
+    /**
+        Reads and checks the header and the section table that start at `start`.
+        Throws a runtime error if the file is truncated, has a version or flags we
+        don't support or a section is out of bounds.
+    */
+    Container readContainer(const uint8_t* data, size_t size, size_t start) {
+        return readContainer(data, size, start, size);
+    }
+    /**
+        Reads and checks the header and the section table like readContainer(), but
+        `data` only needs to contain them: the sections are checked against `fileSize`
+        (the size of the whole file or UINT64_MAX if it's read from a stream).
+    */
+    Container readContainer(const uint8_t* data, size_t size, size_t start, uint64_t fileSize) {
+        if (!isVersioned(data, size, start) || size - start < HEADER_SIZE) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The header is missing or incomplete.");
+        }
+        Container container;
+        const uint8_t* h = data + start + 1; // Skip marker
+        container.header.version = h[0];
+        container.header.flags = getU16(h + 1);
+        container.header.fingerprint = getU64(h + 3);
+        container.header.nodeCount = getU32(h + 11);
+        container.header.attributeCount = getU32(h + 15);
+        container.header.stringCount = getU32(h + 19);
+        container.header.sectionCount = getU32(h + 23);
+
+        if (container.header.version != FORMAT_VERSION) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unsupported format version ("+std::to_string(container.header.version)+").");
+        }
+        if ((container.header.flags & ~SUPPORTED_FLAGS) != 0) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Unsupported format flags ("+std::to_string(container.header.flags)+").");
+        }
+        if ((container.header.flags & flag::ALIGNED) && !isLittleEndian()) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Its values are stored in little endian and this machine is big endian.");
+        }
+
+        // Section table
+        size_t tableStart = start + HEADER_SIZE;
+        if ((size - tableStart) / SECTION_ENTRY_SIZE < container.header.sectionCount) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The section table is incomplete.");
+        }
+        container.sections.reserve(container.header.sectionCount);
+        for (uint32_t i = 0; i < container.header.sectionCount; i++) {
+            const uint8_t* e = data + tableStart + i*SECTION_ENTRY_SIZE;
+            SectionEntry entry {getU32(e), getU64(e + 4), getU64(e + 12)};
+            if (entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. Section "+std::to_string(entry.type)+" is out of bounds.");
+            }
+            container.sections.push_back(entry);
+        }
+
+        // Every file needs its code. The other sections are checked when they're used
+        if (container.find(section::DATA) == nullptr) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The DATA section is missing.");
+        }
+        const SectionEntry* nodes = container.find(section::NODES);
+        if (nodes == nullptr || nodes->size / NODE_ENTRY_SIZE != container.header.nodeCount) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The NODES section doesn't match the header.");
+        }
+
+        return container;
+    }
+    namespace {
+        // Number of sections written for a Layout: DATA, STRINGS, NODES, INCLUDES and PATHS, COLUMNS and QUANTIZATION if requested
+        uint32_t sectionCount(const Layout& layout) {
+            return 4 + (layout.pathIndex ? 1 : 0) + (layout.columns ? 1 : 0) + (layout.quantized.empty() ? 0 : 1);
+        }
+        // Appends 0s until the size of the file is a multiple of MAX_VALUE_ALIGNMENT
+        void alignFile(std::vector<uint8_t>& file) {
+            file.resize((file.size() + MAX_VALUE_ALIGNMENT - 1) / MAX_VALUE_ALIGNMENT * MAX_VALUE_ALIGNMENT, 0);
+        }
+        /**
+            Appends the COLUMNS section (see the top of binaryFormat.hpp). The file must
+            end at a multiple of MAX_VALUE_ALIGNMENT
+        */
+        void writeColumns(std::vector<uint8_t>& file, const std::vector<Table>& tables) {
+            // Every array of the section in the order they're written. Columns are
+            // completed up to the number of rows of their table
+            std::vector<std::vector<uint8_t>> arrays;
+            for (const Table& t : tables) {
+                const size_t rows = t.nodes.size();
+                arrays.emplace_back();
+                for (uint32_t node : t.nodes) {
+                    putU32(arrays.back(), node);
+                }
+                arrays.emplace_back();
+                for (uint32_t parent : t.parents) {
+                    putU32(arrays.back(), parent);
+                }
+                for (const Column& c : t.columns) {
+                    std::vector<uint8_t> validity = c.validity;
+                    validity.resize((rows + 7) / 8, 0);
+                    arrays.push_back(std::move(validity));
+                    std::vector<uint8_t> values;
+                    if (c.type == type::STRING || c.type == type::STR_MD) {
+                        for (uint32_t offset : c.offsets) {
+                            putU32(values, offset);
+                        }
+                        for (size_t row = c.offsets.size(); row <= rows; row++) {
+                            putU32(values, c.characters.size());
+                        }
+                        values.insert(values.end(), c.characters.begin(), c.characters.end());
+                    } else {
+                        values = c.values;
+                        values.resize(rows * type::sizeOf(c.type), 0);
+                    }
+                    arrays.push_back(std::move(values));
+                }
+            }
+
+            // The entries go first, then the arrays (aligned)
+            size_t position = 4;
+            for (const Table& t : tables) {
+                position += TABLE_ENTRY_SIZE + t.columns.size()*COLUMN_ENTRY_SIZE;
+            }
+            std::vector<size_t> positions;
+            for (const std::vector<uint8_t>& array : arrays) {
+                position = (position + MAX_VALUE_ALIGNMENT - 1) / MAX_VALUE_ALIGNMENT * MAX_VALUE_ALIGNMENT;
+                positions.push_back(position);
+                position += array.size();
+            }
+
+            const size_t begin = file.size();
+            putU32(file, tables.size());
+            size_t next = 0;
+            for (const Table& t : tables) {
+                putU32(file, t.classID);
+                putU32(file, t.nodes.size());
+                putU32(file, t.columns.size());
+                putU64(file, positions[next]);
+                putU64(file, positions[next + 1]);
+                next += 2;
+                for (const Column& c : t.columns) {
+                    putU32(file, c.attribute);
+                    putU32(file, c.type);
+                    putU64(file, positions[next]);
+                    putU64(file, positions[next + 1]);
+                    putU64(file, arrays[next + 1].size());
+                    next += 2;
+                }
+            }
+            for (size_t a = 0; a < arrays.size(); a++) {
+                file.resize(begin + positions[a], 0);
+                file.insert(file.end(), arrays[a].begin(), arrays[a].end());
+            }
+        }
+    }
+    /**
+        Starts a version 2 file in `file`: writes the identifier bytes and leaves room
+        for the header and the section table. The compiled instructions are appended
+        after them and the file is completed with finishContainer().
+        Returns the position of the first instruction.
+    */
+    size_t beginContainer(std::vector<uint8_t>& file, const std::vector<uint8_t>& identifierBytes, const Layout& layout) {
+        file.insert(file.end(), identifierBytes.begin(), identifierBytes.end());
+        file.push_back(0);
+        file.insert(file.end(), HEADER_SIZE + sectionCount(layout)*SECTION_ENTRY_SIZE, 0);
+        // The QUANTIZATION section goes before the instructions (see finishContainer())
+        if (!layout.quantized.empty()) {
+            putU32(file, layout.quantized.size());
+            for (const QuantizedAttribute& q : layout.quantized) {
+                uint32_t min, max;
+                std::memcpy(&min, &q.min, 4);
+                std::memcpy(&max, &q.max, 4);
+                putU32(file, q.classID);
+                putU32(file, q.attributeID);
+                putU32(file, q.format);
+                putU32(file, min);
+                putU32(file, max);
+            }
+        }
+        return file.size();
+    }
+    /**
+        Completes a file started with beginContainer(): appends the tables of the Layout
+        after the instructions (everything from `codeBegin`) and writes the header
+        and the section table.
+    */
+    void finishContainer(std::vector<uint8_t>& file, uint64_t fingerprint, const Layout& layout, size_t codeBegin) {
+        std::vector<SectionEntry> sections;
+        sections.push_back({section::DATA, codeBegin, file.size() - codeBegin});
+        // The QUANTIZATION section was written by beginContainer(), between the section table and the instructions
+        size_t tableEnd = codeBegin;
+        if (!layout.quantized.empty()) {
+            const size_t size = 4 + layout.quantized.size()*QUANTIZED_ENTRY_SIZE;
+            tableEnd -= size;
+            sections.push_back({section::QUANTIZATION, tableEnd, size});
+        }
+
+        // The tables are written right after the instructions
+        size_t begin = file.size();
+        for (const std::string& s : layout.strings) {
+            putU32(file, s.size());
+            file.insert(file.end(), s.begin(), s.end());
+        }
+        sections.push_back({section::STRINGS, begin, file.size() - begin});
+
+        begin = file.size();
+        for (const NodeEntry& n : layout.nodes) {
+            putU64(file, n.offset);
+            putU32(file, n.parent);
+            putU32(file, n.subtreeSize);
+        }
+        sections.push_back({section::NODES, begin, file.size() - begin});
+
+        // Hash table of the paths, at most 3/4 full so that probes are short
+        if (layout.pathIndex) {
+            begin = file.size();
+            uint32_t slotCount = 1;
+            while (size_t(slotCount) * 3 < layout.pathHashes.size() * 4 + 1) {
+                slotCount *= 2;
+            }
+            std::vector<uint32_t> slots(slotCount, NO_NODE);
+            for (uint32_t node = 0; node < layout.pathHashes.size(); node++) {
+                uint32_t slot = layout.pathHashes[node] & (slotCount - 1);
+                while (slots[slot] != NO_NODE) {
+                    slot = (slot + 1) & (slotCount - 1);
+                }
+                slots[slot] = node;
+            }
+            putU32(file, slotCount);
+            for (uint32_t node : slots) {
+                putU32(file, node == NO_NODE ? 0 : uint32_t(layout.pathHashes[node] >> 32));
+                putU32(file, node);
+            }
+            sections.push_back({section::PATHS, begin, file.size() - begin});
+        }
+
+        begin = file.size();
+        for (const IncludeEntry& i : layout.includes) {
+            file.push_back(i.kind);
+            putU32(file, i.string);
+            putU32(file, i.parent);
+            putU64(file, i.offset);
+        }
+        sections.push_back({section::INCLUDES, begin, file.size() - begin});
+
+        // Columns of the classes, aligned so that they can be read in place
+        if (layout.columns) {
+            alignFile(file);
+            begin = file.size();
+            writeColumns(file, layout.tables);
+            sections.push_back({section::COLUMNS, begin, file.size() - begin});
+        }
+
+        // Header and section table, in the room left by beginContainer()
+        std::vector<uint8_t> header;
+        header.reserve(HEADER_SIZE + sections.size()*SECTION_ENTRY_SIZE);
+        header.push_back(FORMAT_MARKER);
+        header.push_back(FORMAT_VERSION);
+        putU16(header, layout.flags);
+        putU64(header, fingerprint);
+        putU32(header, layout.nodes.size());
+        putU32(header, layout.attributeCount);
+        putU32(header, layout.strings.size());
+        putU32(header, sections.size());
+        for (const SectionEntry& entry : sections) {
+            putU32(header, entry.type);
+            putU64(header, entry.offset);
+            putU64(header, entry.size);
+        }
+        std::copy(header.begin(), header.end(), file.begin() + (tableEnd - header.size()));
+    }
+
+    /**
+        Returns true if the data at `start` is a version 2 file with the COMPRESSED flag
+    */
+    bool isCompressed(const uint8_t* data, size_t size, size_t start) {
+        return isVersioned(data, size, start) && size - start >= 4 && (getU16(data + start + 2) & flag::COMPRESSED);
+    }
+    /**
+        Returns the file (a version 2 file whose identifier ends at `start`)
+        with everything after the identifier compressed. Blocks are compressed
+        in parallel. `level` goes from 1 (fastest) to compression::MAX_LEVEL (smallest)
+    */
+    std::vector<uint8_t> compressContainer(const std::vector<uint8_t>& file, size_t start, int level) {
+        const uint8_t* data = file.data() + start;
+        const size_t size = file.size() - start;
+        const size_t blockCount = (size + compression::BLOCK_SIZE - 1) / compression::BLOCK_SIZE;
+
+        std::vector<std::vector<uint8_t>> blocks(blockCount);
+        compression::forEachBlock(blockCount, [&](size_t i) {
+            size_t offset = i * compression::BLOCK_SIZE;
+            blocks[i] = compression::compressBlock(data + offset, std::min(compression::BLOCK_SIZE, size - offset), level);
+            return true;
+        });
+
+        std::vector<uint8_t> binary(file.begin(), file.begin() + start);
+        binary.push_back(FORMAT_MARKER);
+        binary.push_back(FORMAT_VERSION);
+        putU16(binary, getU16(data + 2) | flag::COMPRESSED);
+        putU64(binary, size);
+        putU32(binary, blockCount);
+        // Blocks that don't get smaller are stored as they are
+        for (size_t i = 0; i < blockCount; i++) {
+            size_t rawSize = std::min(compression::BLOCK_SIZE, size - i * compression::BLOCK_SIZE);
+            if (blocks[i].size() >= rawSize) {
+                putU32(binary, uint32_t(rawSize) | 0x80000000u);
+            } else {
+                putU32(binary, blocks[i].size());
+            }
+        }
+        for (size_t i = 0; i < blockCount; i++) {
+            size_t offset = i * compression::BLOCK_SIZE;
+            size_t rawSize = std::min(compression::BLOCK_SIZE, size - offset);
+            if (blocks[i].size() >= rawSize) {
+                binary.insert(binary.end(), data + offset, data + offset + rawSize);
+            } else {
+                binary.insert(binary.end(), blocks[i].begin(), blocks[i].end());
+            }
+        }
+        return binary;
+    }
+    /**
+        Returns the decompressed version of a COMPRESSED file (the identifier is kept).
+        Blocks are decompressed in parallel.
+        Throws a runtime error if the file is corrupted.
+    */
+    std::vector<uint8_t> decompressContainer(const uint8_t* data, size_t size, size_t start) {
+        if (!isCompressed(data, size, start) || size - start < COMPRESSED_HEADER_SIZE) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. The header is missing or incomplete.");
+        }
+        const uint8_t* h = data + start + 1; // Skip marker
+        if (h[0] != FORMAT_VERSION) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. Unsupported format version ("+std::to_string(h[0])+").");
+        }
+        const uint64_t uncompressedSize = getU64(h + 3);
+        const uint32_t blockCount = getU32(h + 11);
+        const size_t tableStart = start + COMPRESSED_HEADER_SIZE;
+        // Every block but the last one has BLOCK_SIZE bytes
+        const uint64_t maxSize = uint64_t(blockCount) * compression::BLOCK_SIZE;
+        if ((size - tableStart) / 4 < blockCount || uncompressedSize > maxSize || maxSize - uncompressedSize >= compression::BLOCK_SIZE) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. The block table is corrupted.");
+        }
+
+        // Find where every block starts
+        std::vector<size_t> offsets(blockCount);
+        size_t offset = tableStart + size_t(blockCount) * 4;
+        for (uint32_t i = 0; i < blockCount; i++) {
+            offsets[i] = offset;
+            uint32_t blockSize = getU32(data + tableStart + i*4) & 0x7FFFFFFFu;
+            if (blockSize > size - offset) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. Block "+std::to_string(i)+" is out of bounds.");
+            }
+            offset += blockSize;
+        }
+
+        std::vector<uint8_t> binary(start + uncompressedSize);
+        std::memcpy(binary.data(), data, start);
+        uint8_t* output = binary.data() + start;
+        bool succeeded = compression::forEachBlock(blockCount, [&](size_t i) {
+            uint32_t entry = getU32(data + tableStart + i*4);
+            size_t outputOffset = i * compression::BLOCK_SIZE;
+            size_t outputSize = std::min<uint64_t>(compression::BLOCK_SIZE, uncompressedSize - outputOffset);
+            if (entry & 0x80000000u) {
+                if ((entry & 0x7FFFFFFFu) != outputSize) return false;
+                std::memcpy(output + outputOffset, data + offsets[i], outputSize);
+                return true;
+            }
+            return compression::decompressBlock(data + offsets[i], entry, output + outputOffset, outputSize);
+        });
+        if (!succeeded) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. The compressed data is corrupted.");
+        }
+        // The data can't be compressed again
+        if (isCompressed(binary.data(), binary.size(), start)) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compressed file. The compressed data is corrupted.");
+        }
+        return binary;
+    }
+
+    /**
+        Returns the Encoding of a file: its flags, its strings if they're stored in a
+        table, its quantized attributes and its DATA section. Throws a runtime error if
+        the STRINGS or QUANTIZATION sections are corrupted.
+    */
+    Encoding readEncoding(const uint8_t* data, const Container& container) {
+        Encoding encoding;
+        encoding.flags = container.header.flags;
+        if (const SectionEntry* code = container.find(section::DATA)) {
+            encoding.code = data;
+            encoding.codeBegin = code->offset;
+            encoding.codeEnd = code->offset + code->size;
+        }
+        if (encoding.flags & flag::QUANTIZED) {
+            const SectionEntry* section = container.find(section::QUANTIZATION);
+            if (section == nullptr) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The QUANTIZATION section is missing.");
+            }
+            encoding.quantized = readQuantized(data + section->offset, section->size);
+        }
+        if (!(encoding.flags & flag::STRING_TABLE)) {
+            return encoding;
+        }
+
+        const SectionEntry* section = container.find(section::STRINGS);
+        if (section == nullptr) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The STRINGS section is missing.");
+        }
+        encoding.strings = readStrings(data + section->offset, section->size, container.header.stringCount);
+        return encoding;
+    }
+    /**
+        Reads the QUANTIZATION section of a file. Throws a runtime error if it's corrupted
+    */
+    std::vector<QuantizedAttribute> readQuantized(const uint8_t* data, uint64_t size) {
+        if (size < 4 || (size - 4) / QUANTIZED_ENTRY_SIZE != getU32(data) || (size - 4) % QUANTIZED_ENTRY_SIZE != 0) {
+            throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The QUANTIZATION section is corrupted.");
+        }
+        std::vector<QuantizedAttribute> quantized;
+        const uint32_t count = getU32(data);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t* e = data + 4 + i*QUANTIZED_ENTRY_SIZE;
+            QuantizedAttribute q {getU32(e), getU32(e + 4), getU32(e + 8), 0, 0};
+            const uint32_t min = getU32(e + 12), max = getU32(e + 16);
+            std::memcpy(&q.min, &min, 4);
+            std::memcpy(&q.max, &max, 4);
+            // Fixed-point formats need a range (NaNs fail too)
+            if (q.format > QUANTIZE_FIXED16 || (q.format != QUANTIZE_HALF && !(q.min < q.max))) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The QUANTIZATION section is corrupted.");
+            }
+            quantized.push_back(q);
+        }
+        return quantized;
+    }
+    /**
+        Reads `count` strings of a STRINGS section of `size` bytes. The views point
+        into `data`. Throws a runtime error if the section is corrupted.
+    */
+    std::vector<std::string_view> readStrings(const uint8_t* data, uint64_t size, uint32_t count) {
+        std::vector<std::string_view> strings;
+        // Every string takes 4 bytes at least, don't trust the header more than the section
+        strings.reserve(std::min<uint64_t>(count, size / 4));
+        uint64_t position = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (size - position < 4) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The STRINGS section is corrupted.");
+            }
+            uint32_t length = getU32(data + position);
+            position += 4;
+            if (size - position < length) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The STRINGS section is corrupted.");
+            }
+            strings.emplace_back(reinterpret_cast<const char*>(data + position), length);
+            position += length;
+        }
+        return strings;
+    }
+    /**
+        Reads the entry of the table of the class specified in a COLUMNS section and
+        returns true, or false if the class doesn't have a table. The positions of the
+        entry are made relative to the start of the file. Throws a runtime error if
+        the section is corrupted.
+    */
+    bool readTable(const uint8_t* data, const SectionEntry& section, uint32_t classID, TableEntry& table) {
+        const uint8_t* s = data + section.offset;
+        const uint64_t size = section.size;
+        // Checks that `count` bytes at `position` (of the section) are in the section
+        auto check = [&](uint64_t position, uint64_t count) {
+            if (position > size || count > size - position) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+            }
+        };
+        // Arrays are aligned so that they can be read in place
+        auto checkArray = [&](uint64_t position, uint64_t count) {
+            check(position, count);
+            if ((section.offset + position) % MAX_VALUE_ALIGNMENT != 0) {
+                throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+            }
+        };
+        check(0, 4);
+        const uint32_t tableCount = getU32(s);
+        uint64_t position = 4;
+        for (uint32_t t = 0; t < tableCount; t++) {
+            check(position, TABLE_ENTRY_SIZE);
+            const uint8_t* e = s + position;
+            const uint32_t columnCount = getU32(e + 8);
+            position += TABLE_ENTRY_SIZE;
+            check(position, uint64_t(columnCount) * COLUMN_ENTRY_SIZE);
+            if (getU32(e) != classID) {
+                position += uint64_t(columnCount) * COLUMN_ENTRY_SIZE;
+                continue;
+            }
+
+            table.classID = classID;
+            table.rowCount = getU32(e + 4);
+            table.nodes = getU64(e + 12);
+            table.parents = getU64(e + 20);
+            const uint64_t rows = table.rowCount;
+            checkArray(table.nodes, rows * 4);
+            checkArray(table.parents, rows * 4);
+            table.nodes += section.offset;
+            table.parents += section.offset;
+            table.columns.clear();
+            table.columns.reserve(columnCount);
+            for (uint32_t c = 0; c < columnCount; c++) {
+                const uint8_t* ce = s + position + c*COLUMN_ENTRY_SIZE;
+                ColumnEntry column = {getU32(ce), getU32(ce + 4), getU64(ce + 8), getU64(ce + 16), getU64(ce + 24)};
+                checkArray(column.validity, (rows + 7) / 8);
+                checkArray(column.values, column.valuesSize);
+                if (column.type == type::STRING || column.type == type::STR_MD) {
+                    if (column.valuesSize < (rows + 1) * 4) {
+                        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+                    }
+                } else if (column.type > type::VEC4D || column.valuesSize != rows * type::sizeOf(static_cast<type::Type>(column.type))) {
+                    throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The COLUMNS section is corrupted.");
+                }
+                column.validity += section.offset;
+                column.values += section.offset;
+                table.columns.push_back(column);
+            }
+            return true;
+        }
+        return false;
+    }
+    /**
+        Reads the node table of a file
+    */
+    std::vector<NodeEntry> readNodes(const uint8_t* data, const SectionEntry& section, uint32_t count) {
+        std::vector<NodeEntry> nodes;
+        nodes.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t* e = data + section.offset + i*NODE_ENTRY_SIZE;
+            nodes.push_back({getU64(e), getU32(e + 8), getU32(e + 12)});
+        }
+        return nodes;
+    }
+}
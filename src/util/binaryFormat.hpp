@@ -0,0 +1,618 @@
+#pragma once
+
+// eclang
+#include "classes/attribute.hpp"
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Instructions of the compiled code (stored in the DATA section of v2 files)
+#define INST_CREATE         uint8_t(0x01)
+#define INST_ATTRIBUTE      uint8_t(0x02)
+#define INST_SCOPE_ENTER    uint8_t(0x03)
+#define INST_SCOPE_EXIT     uint8_t(0x04)
+#define INST_INCLUDE        uint8_t(0x05)
+#define INST_TEMPLATE       uint8_t(0x06)
+#define INST_MARK_TEMPLATE  uint8_t(0x07)
+#define INST_ATTRIBUTES     uint8_t(0x08)
+#define INST_CLONE          uint8_t(0x09)
+#define INST_INSTANCE       uint8_t(0x0A)
+
+// When creating an object or attribute during compilation,
+// we might find a custom class or attribute. In this case
+// we enter INST_ATTR_CUSTOM (255) as an attribute followed
+// by a STRING.
+#define INST_ATTR_CUSTOM    uint8_t(255)
+
+/**
+    Layout of compiled files.
+
+    LEGACY (version 1)
+    The identifier bytes of the language, a 0 and the instructions.
+
+    VERSION 2
+    The identifier bytes of the language and a 0 followed by:
+    - FORMAT_MARKER (a byte that can't start an instruction)
+    - Header:
+        - uint8_t  version
+        - uint16_t flags
+        - uint64_t fingerprint of the language (Language::getFingerprint())
+        - uint32_t number of nodes in the NODES section
+        - uint32_t number of attributes in the DATA section
+        - uint32_t number of strings in the STRINGS section
+        - uint32_t number of sections
+    - Section table: one SectionEntry (type, offset and size) per section.
+      Offsets are from the start of the file.
+    - The sections, in any order (the compiler writes DATA first).
+
+    All the numbers in the header, section table and tables are little endian. Values of
+    attributes are stored as they are in memory (little endian in ALIGNED files).
+
+    FLAGS
+    Options used when compiling the file that change how the instructions are stored:
+    - STRING_TABLE: Every STRING in the instructions is stored once in the STRINGS section.
+      The instructions contain the prefix of the STRING (0 or 1) and the index of the
+      string in the table (uint32_t) instead of the characters and the terminator.
+    - VARINT: Integers bigger than a byte (INT16 to UINT64 and the components of
+      integer vectors) are stored as LEB128 variable-length integers. Signed values are
+      zigzag-encoded first so that small negative numbers are short too. The indices of
+      the string table (if any) are stored as varints too.
+    - SIZED_SCOPES: Every SCOPE_ENTER is followed by the size in bytes (uint32_t) of the
+      scope: everything after the size up to its SCOPE_EXIT (included). Readers can
+      skip the attributes and children of a node by jumping over the scope.
+    - ALIGNED: Values stored with their size in memory (numbers and vectors, but not the
+      integers stored as varints) start at a position of the file that is a multiple of
+      their alignment (see valueAlignment(): 16 bytes for vec4f and vec4i, 32 for vec4d...).
+      They're preceded by the 0s needed (see alignmentPadding()). Values are little endian,
+      so a file mapped into memory (which starts at a page boundary) can be read in place.
+    - ATTRIBUTE_BITMAP: Objects of registered classes whose attributes are in the order of
+      their class set them with one ATTRIBUTES instruction instead of one ATTRIBUTE per
+      attribute (custom attributes still use ATTRIBUTE, after it). ATTRIBUTES takes a
+      bitmap of (number of attributes of the class + 7) / 8 bytes, where bit `id % 8` of
+      byte `id / 8` is set for every attribute set, followed by the values of those
+      attributes in order of ID (stored like the values of ATTRIBUTE).
+    - DELTA: Numbers and vectors of registered attributes are stored as the difference with
+      the value of the same attribute in the previous sibling of the same class that sets it
+      (0 if there's none). Siblings are the objects created between the same SCOPE_ENTER and
+      SCOPE_EXIT (or in the root). Integers (and the components of integer vectors) store their
+      wrapping difference and floats and doubles the XOR of their bits, so the values keep their
+      size (or are still varints with VARINT) and the instructions are read as before. Readers
+      add every difference to the previous value (see DeltaContext).
+    - QUANTIZED: The attributes listed in the QUANTIZATION section (floats, doubles and float
+      and double vectors) store every component with less precision: as a half float
+      (QUANTIZE_HALF, 2 bytes) or as a fixed-point number between the `min` and `max` of the
+      attribute (QUANTIZE_FIXED8 and QUANTIZE_FIXED16, 1 and 2 bytes). They're never padded
+      (ALIGNED) or stored as differences (DELTA). See quantizeValue().
+    - DEDUPLICATED: The children of an object that are exactly the same as the children of an
+      object before it (same classes, names, attributes and children) are replaced by a CLONE
+      instruction. CLONE takes three LEB128 varints: the position of the first instruction of
+      the children of the earlier object (from the start of DATA), the size in bytes of their
+      instructions (up to its SCOPE_EXIT, not included) and the number of objects they create.
+      They're created in the scope of the CLONE, which is the last instruction of that scope.
+      Their instructions start a scope, so they don't depend on where they're run (their DELTA
+      values are differences with their own siblings). The NODES section has an entry for every
+      object created by CLONE, with the offset of the object it copies.
+    - INSTANCES: Objects declared as instances of an earlier object (`#instance`) that only
+      change some of its attributes are written as a CREATE, a scope with the attributes they
+      change or add and an INSTANCE instruction (the last one of the scope). INSTANCE takes the
+      same three varints as CLONE, for the whole prototype: the position of its CREATE, the size
+      of its instructions (up to its SCOPE_EXIT, included) and the number of objects it creates
+      (itself included). The object in scope gets the attributes of the prototype it doesn't set
+      and copies of its children. The NODES section has an entry for every copy, with the offset
+      of the object it copies. Files with DELTA values don't have instances.
+    - COMPRESSED: Everything after the identifier is compressed (see util/compression.hpp).
+      The marker, version and flags are followed by:
+        - uint64_t size of the uncompressed data
+        - uint32_t number of blocks
+        - uint32_t compressed size of every block (the highest bit is set if the
+          block is stored without compression)
+        - The blocks
+      The uncompressed data is a version 2 file without the COMPRESSED flag (starting
+      with the FORMAT_MARKER). Compressed files are decompressed before being read.
+
+    SECTIONS
+    - STRINGS:  uint32_t length and the characters of every string (no terminator).
+    - NODES:    One NodeEntry per object of this file in the order they're created.
+    - DATA:     The instructions (same as the legacy format).
+    - INCLUDES: One IncludeEntry per INCLUDE and TEMPLATE instruction.
+    - PATHS:    Optional hash table of the paths of the nodes (node1/node2/node3):
+                uint32_t number of slots (a power of two) and, for every slot, the
+                highest 32 bits of the hashPath() of a path (uint32_t) and the index of
+                its node in the NODES section (uint32_t, NO_NODE if the slot is empty).
+                Paths are found by linear probing from slot `hash & (slots - 1)`. Readers
+                must check the path of the node found, different paths may have the same hash.
+    - COLUMNS:  Optional copy of the attributes of the nodes of every registered class, stored
+                by attribute instead of by node (custom classes and attributes aren't stored).
+                It starts at a multiple of MAX_VALUE_ALIGNMENT and contains the number of tables
+                (uint32_t) followed by every table: its TableEntry and the ColumnEntry of each
+                of its columns (one per attribute set in any of its nodes). The arrays they point
+                to come after them, each one at a multiple of MAX_VALUE_ALIGNMENT. Offsets are
+                from the start of the section and everything is little endian.
+                - nodes:    Index in NODES of the node of every row (uint32_t), in the order of NODES.
+                - parents:  Index in NODES of the parent of the node of every row (uint32_t, NO_PARENT).
+                - validity: Bit `row % 8` of byte `row / 8` is set if the row has the attribute.
+                - values:   Numbers and vectors: one value per row (0s if it's not set).
+                            Strings: the offset (uint32_t) of every row in the characters and the
+                            end of the last one, followed by the characters.
+    - QUANTIZATION: Attributes stored with less precision (QUANTIZED flag): uint32_t number of
+                attributes and one QuantizedAttribute (classID, attributeID and format as
+                uint32_t and min and max as floats) per attribute. The compiler writes it right
+                before DATA so that streams have it before the instructions.
+*/
+namespace eclang::format {
+    // Byte after the identifier of version 2 (and later) files.
+    // Legacy files have an instruction (or nothing) there
+    constexpr uint8_t FORMAT_MARKER = 0xEC;
+    constexpr uint8_t FORMAT_VERSION = 2;
+
+    // Value of `parent` in the node and include tables for nodes in the root
+    constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+    // Node of the empty slots of the PATHS section
+    constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+    // Hash of the empty path (see hashPath())
+    constexpr uint64_t PATH_HASH_BASIS = 14695981039346656037ull;
+
+    namespace flag {
+        enum Flag : uint16_t {
+            STRING_TABLE = 1 << 0,
+            VARINT = 1 << 1,
+            COMPRESSED = 1 << 2,
+            SIZED_SCOPES = 1 << 3,
+            ALIGNED = 1 << 4,
+            ATTRIBUTE_BITMAP = 1 << 5,
+            DELTA = 1 << 6,
+            QUANTIZED = 1 << 7,
+            DEDUPLICATED = 1 << 8,
+            INSTANCES = 1 << 9
+        };
+    }
+    // Flags this version of the library can read (COMPRESSED files are read with
+    // decompressContainer() first)
+    constexpr uint16_t SUPPORTED_FLAGS = flag::STRING_TABLE | flag::VARINT | flag::SIZED_SCOPES | flag::ALIGNED | flag::ATTRIBUTE_BITMAP | flag::DELTA | flag::QUANTIZED | flag::DEDUPLICATED | flag::INSTANCES;
+    // Values are never aligned to more than this (vec4d, vec4l)
+    constexpr size_t MAX_VALUE_ALIGNMENT = 32;
+    // Size of the biggest value (vec4d, vec4l)
+    constexpr size_t MAX_VALUE_SIZE = 32;
+    // Size of the bitmap of ATTRIBUTES for a class with the most attributes possible
+    // (IDs are a byte and INST_ATTR_CUSTOM is never a registered attribute)
+    constexpr size_t MAX_BITMAP_SIZE = 32;
+
+    // Longest LEB128 encoding of a 64 bit integer
+    constexpr size_t MAX_VARINT_SIZE = 10;
+    // CLONE and INSTANCE instructions read again inside the instructions read again for
+    // another one (DEDUPLICATED, INSTANCES). Deeper ones mean the file is corrupted
+    constexpr uint32_t MAX_CLONE_DEPTH = 256;
+
+    namespace section {
+        enum Type : uint32_t {
+            STRINGS = 1,
+            NODES = 2,
+            DATA = 3,
+            INCLUDES = 4,
+            PATHS = 5,
+            COLUMNS = 6,
+            QUANTIZATION = 7
+        };
+    }
+
+    // Sizes of the fixed parts of the file
+    constexpr size_t HEADER_SIZE = 1 + 1 + 2 + 8 + 4 + 4 + 4 + 4; // Marker included
+    constexpr size_t SECTION_ENTRY_SIZE = 4 + 8 + 8;
+    constexpr size_t NODE_ENTRY_SIZE = 8 + 4 + 4;
+    constexpr size_t INCLUDE_ENTRY_SIZE = 1 + 4 + 4 + 8;
+    constexpr size_t SCOPE_SIZE_SIZE = 4;
+    constexpr size_t PATH_SLOT_SIZE = 4 + 4;
+    constexpr size_t TABLE_ENTRY_SIZE = 4 + 4 + 4 + 8 + 8;
+    constexpr size_t COLUMN_ENTRY_SIZE = 4 + 4 + 8 + 8 + 8;
+    constexpr size_t QUANTIZED_ENTRY_SIZE = 4 + 4 + 4 + 4 + 4;
+    constexpr size_t COMPRESSED_HEADER_SIZE = 1 + 1 + 2 + 8 + 4; // Marker included
+
+    struct Header {
+        uint8_t version = FORMAT_VERSION;
+        uint16_t flags = 0;
+        uint64_t fingerprint = 0;
+        uint32_t nodeCount = 0;
+        uint32_t attributeCount = 0;
+        uint32_t stringCount = 0;
+        uint32_t sectionCount = 0;
+    };
+    struct SectionEntry {
+        uint32_t type;
+        uint64_t offset;
+        uint64_t size;
+    };
+    struct NodeEntry {
+        uint64_t offset; // Position of the CREATE instruction in the DATA section
+        uint32_t parent; // Index of the parent node or NO_PARENT
+        uint32_t subtreeSize; // Number of nodes in the subtree (this one included)
+    };
+    struct IncludeEntry {
+        uint8_t kind; // 'i' for includes and 't' for templates
+        uint32_t string; // Index of the file name in the STRINGS section
+        uint32_t parent; // Index of the node it's included in or NO_PARENT
+        uint64_t offset; // Position of the instruction in the DATA section
+    };
+    enum QuantizeFormat : uint32_t {
+        QUANTIZE_HALF = 0,
+        QUANTIZE_FIXED8 = 1,
+        QUANTIZE_FIXED16 = 2
+    };
+    struct QuantizedAttribute {
+        uint32_t classID;
+        uint32_t attributeID;
+        uint32_t format; // QuantizeFormat
+        float min; // Range of the fixed-point formats
+        float max;
+    };
+
+    struct ColumnEntry {
+        uint32_t attribute; // ID of the attribute in its class
+        uint32_t type; // type::Type of the attribute
+        uint64_t validity; // Position of the validity bitmap
+        uint64_t values; // Position of the values
+        uint64_t valuesSize; // Size of the values in bytes
+    };
+    struct TableEntry {
+        uint32_t classID;
+        uint32_t rowCount; // Number of nodes of the class
+        uint64_t nodes; // Position of the indices of the nodes
+        uint64_t parents; // Position of the indices of their parents
+        std::vector<ColumnEntry> columns; // Stored right after the TableEntry (their count is stored after `rowCount`)
+    };
+
+    /**
+        A column of a Table while it's being built. Rows after the last
+        one set are added when the file is written
+    */
+    struct Column {
+        uint32_t attribute;
+        type::Type type;
+        std::vector<uint8_t> validity;
+        std::vector<uint8_t> values; // Numbers and vectors
+        std::vector<uint32_t> offsets; // Strings: start of every row in `characters`
+        std::string characters;
+    };
+    /**
+        The nodes of a class and their attributes, written in the COLUMNS section
+    */
+    struct Table {
+        uint32_t classID;
+        std::vector<uint32_t> nodes;
+        std::vector<uint32_t> parents;
+        std::vector<Column> columns;
+
+        /**
+            Returns the column of the attribute, adding it if it's not there
+        */
+        Column& column(uint32_t attribute, type::Type type);
+    };
+
+    /**
+        Last value of every attribute set by the objects of a scope of a DELTA file,
+        by class and attribute (see deltaKey())
+    */
+    struct DeltaScope {
+        std::vector<uint32_t> keys;
+        std::vector<std::array<uint8_t, MAX_VALUE_SIZE>> values;
+
+        /**
+            Returns the value of the key (MAX_VALUE_SIZE bytes), adding it as 0s if it's not there
+        */
+        uint8_t* find(uint32_t key);
+
+    private:
+        // Position of the last key found: objects of the same class set their attributes
+        // in the same order, so the next one is usually right after it
+        size_t hint = 0;
+    };
+    inline uint32_t deltaKey(uint32_t classID, uint8_t attributeID) {
+        return (classID << 8) | attributeID;
+    }
+    /**
+        Previous values of the attributes in every open scope of a DELTA file, used to write
+        and read the differences. The attributes of an object are inside its own scope, so their
+        previous values are the ones of the scope that contains it.
+    */
+    class DeltaContext {
+    public:
+        DeltaContext();
+        /**
+            Starts with the values of the previous siblings of the first object
+        */
+        DeltaContext(const DeltaScope& previous);
+
+        /**
+            Called for every SCOPE_ENTER and SCOPE_EXIT instruction
+        */
+        void enterScope();
+        void exitScope();
+        /**
+            Returns the previous value of an attribute of the object whose scope is open
+            (MAX_VALUE_SIZE bytes, 0s if none of its previous siblings of its class set it)
+        */
+        uint8_t* previous(uint32_t classID, uint8_t attributeID);
+
+    private:
+        // Scopes are reused to keep their memory: the first `open` are the open ones
+        // and the first one is the root
+        std::vector<DeltaScope> scopes;
+        size_t open = 1;
+    };
+
+    /**
+        Tables filled while compiling the objects of a file
+    */
+    struct Layout {
+        uint16_t flags = 0;
+        std::vector<NodeEntry> nodes;
+        std::vector<IncludeEntry> includes;
+        std::vector<std::string> strings;
+        uint32_t attributeCount = 0;
+        // Write the PATHS section. `pathHashes` has the hash of the path of every node
+        bool pathIndex = false;
+        std::vector<uint64_t> pathHashes;
+        // Values of the previous siblings of the attributes written (DELTA)
+        DeltaContext deltas;
+        // Write the QUANTIZATION section and store these attributes with less precision
+        std::vector<QuantizedAttribute> quantized;
+        // Write the COLUMNS section with a Table for every class with nodes
+        bool columns = false;
+        std::vector<Table> tables;
+
+        /**
+            Returns the index of the string in `strings`, adding it if it's not there
+        */
+        uint32_t addString(const std::string& string);
+        /**
+            Returns the table of the class, adding it if it's not there
+        */
+        Table& table(uint32_t classID);
+
+    private:
+        // Position of every string in `strings`
+        std::unordered_map<std::string, uint32_t> stringIndices;
+        // Position of the table of every class in `tables`
+        std::unordered_map<uint32_t, size_t> tableIndices;
+    };
+
+    /**
+        What's needed to read the instructions of a file: its flags and,
+        if it has a string table, the strings (pointing into the file)
+    */
+    struct Encoding {
+        uint16_t flags = 0;
+        std::vector<std::string_view> strings;
+        // Position in the file of the first byte of the buffer the instructions are
+        // read from (values of ALIGNED files are aligned to positions in the file)
+        uint64_t fileOffset = 0;
+        // Values of the previous siblings of the first object read, when the instructions
+        // start in the middle of a scope of a DELTA file (see DeltaContext)
+        DeltaScope previous;
+        // Attributes stored with less precision (QUANTIZED)
+        std::vector<QuantizedAttribute> quantized;
+        // Position of the DATA section in the buffer the instructions are read from (in
+        // the file for streams), where the positions of CLONE and INSTANCE start, and the
+        // buffer itself. `code` is nullptr if the instructions are read from a stream
+        const uint8_t* code = nullptr;
+        uint64_t codeBegin = 0;
+        uint64_t codeEnd = 0;
+    };
+
+    /**
+        Returns how the attribute of the class is quantized or nullptr if it isn't
+    */
+    inline const QuantizedAttribute* findQuantized(const std::vector<QuantizedAttribute>& quantized, uint32_t classID, uint32_t attributeID) {
+        for (const QuantizedAttribute& q : quantized) {
+            if (q.classID == classID && q.attributeID == attributeID) {
+                return &q;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+        What's known about the objects of a file before running its instructions, in
+        the order they're created. The vectors are empty if it's not known
+    */
+    struct NodeCounts {
+        std::vector<uint32_t> children; // Number of children of every object
+        std::vector<uint32_t> subtrees; // Number of objects in the subtree of every object
+    };
+
+    /**
+        A parsed version 2 file. Offsets point into the buffer it was read from
+    */
+    struct Container {
+        Header header;
+        std::vector<SectionEntry> sections;
+
+        /**
+            Returns the section of the type specified or nullptr if the file
+            doesn't have it
+        */
+        const SectionEntry* find(uint32_t type) const;
+    };
+
+    /**
+        Appends the numbers to the buffer in little endian
+    */
+    void putU16(std::vector<uint8_t>& buffer, uint16_t value);
+    void putU32(std::vector<uint8_t>& buffer, uint32_t value);
+    void putU64(std::vector<uint8_t>& buffer, uint64_t value);
+    /**
+        Reads little endian numbers. The caller checks the bounds
+    */
+    uint16_t getU16(const uint8_t* data);
+    uint32_t getU32(const uint8_t* data);
+    uint64_t getU64(const uint8_t* data);
+
+    /**
+        How a value of a type is stored with the VARINT flag: the number of
+        integers (`count`, 0 for types stored as they are), the size of each one
+        in memory and whether they're zigzag-encoded (signed)
+    */
+    struct VarintLayout {
+        size_t count;
+        size_t width;
+        bool isSigned;
+    };
+    VarintLayout varintLayout(type::Type type);
+
+    /**
+        Returns the alignment of a value of the type in ALIGNED files: the biggest power
+        of two (up to MAX_VALUE_ALIGNMENT) that divides its size. 1 for strings
+    */
+    size_t valueAlignment(type::Type type);
+    /**
+        Returns the number of padding bytes written before a value of the type that
+        would start at `position` (from the start of the file) in a file with the flags
+        specified. 0 if the file isn't ALIGNED or the value is a string or varints
+    */
+    size_t alignmentPadding(uint64_t position, type::Type type, uint16_t flags);
+    /**
+        Returns true if this machine stores numbers in little endian, the order
+        of the values of ALIGNED files
+    */
+    bool isLittleEndian();
+    /**
+        Returns the number of components of a type that can be quantized (FLOAT and DOUBLE
+        and their vectors), 0 for any other type
+    */
+    size_t quantizedComponents(type::Type type);
+    /**
+        Returns the size of a value of the type quantized as specified
+    */
+    size_t quantizedSize(type::Type type, const QuantizedAttribute& quantized);
+    /**
+        Appends the value (a number or vector of the type specified, as stored in memory)
+        quantized as specified: every component is converted to a half float or mapped from
+        [min, max] (clamped) to the integers of 8 or 16 bits, in little endian
+    */
+    void quantizeValue(std::vector<uint8_t>& buffer, type::Type type, const uint8_t* value, const QuantizedAttribute& quantized);
+    /**
+        Converts a value written by quantizeValue() back to the type (as stored in memory)
+    */
+    void dequantizeValue(const uint8_t* data, type::Type type, const QuantizedAttribute& quantized, uint8_t* value);
+    /**
+        Replaces `previous` (a number or vector of the type specified, as stored in memory) by
+        `value` and writes the difference between them (see the DELTA flag) into `delta`
+    */
+    void subtractDelta(type::Type type, const uint8_t* value, uint8_t* previous, uint8_t* delta);
+    /**
+        Adds a difference written by subtractDelta() to `previous`, which becomes the value
+    */
+    void addDelta(type::Type type, const uint8_t* delta, uint8_t* previous);
+
+    /**
+        Appends an unsigned LEB128 integer to the buffer
+    */
+    void putVarint(std::vector<uint8_t>& buffer, uint64_t value);
+    /**
+        Reads the LEB128 integer at `data` without reading past `end`.
+        Returns the position after it or nullptr if it's truncated or too long
+    */
+    const uint8_t* getVarint(const uint8_t* data, const uint8_t* end, uint64_t& value);
+    /**
+        Appends the value (a number or vector of the type specified, as stored in
+        memory) as varints. The type must have a VarintLayout with count > 0
+    */
+    void putVarintValue(std::vector<uint8_t>& buffer, type::Type type, const void* value);
+    /**
+        Reads a value written by putVarintValue() into `value` (as stored in memory).
+        Returns the position after it or nullptr if it's truncated or a number doesn't
+        fit in the type
+    */
+    const uint8_t* getVarintValue(const uint8_t* data, const uint8_t* end, type::Type type, void* value);
+
+    /**
+        Returns the FNV-1a hash of a path, continuing from the hash of the
+        path before it. The path of a node is hashed as
+        hashPath(name, hashPath("/", hash of the path of its parent))
+    */
+    uint64_t hashPath(std::string_view path, uint64_t hash = PATH_HASH_BASIS);
+    /**
+        Returns the FNV-1a hash of `size` bytes, continuing from the hash of the data
+        before them (see hashPath())
+    */
+    uint64_t hashBytes(const void* data, size_t size, uint64_t hash = PATH_HASH_BASIS);
+
+    /**
+        Returns true if the data at `start` (the position after the identifier
+        bytes and their terminator) is a version 2 (or later) file
+    */
+    bool isVersioned(const uint8_t* data, size_t size, size_t start);
+    /**
+        Reads and checks the header and the section table that start at `start`.
+        Throws a runtime error if the file is truncated, has a version or flags we
+        don't support or a section is out of bounds.
+    */
+    Container readContainer(const uint8_t* data, size_t size, size_t start);
+    /**
+        Reads and checks the header and the section table like readContainer(), but
+        `data` only needs to contain them: the sections are checked against `fileSize`
+        (the size of the whole file or UINT64_MAX if it's read from a stream).
+    */
+    Container readContainer(const uint8_t* data, size_t size, size_t start, uint64_t fileSize);
+    /**
+        Starts a version 2 file in `file`: writes the identifier bytes and leaves room
+        for the header and the section table. The compiled instructions are appended
+        after them and the file is completed with finishContainer().
+        Returns the position of the first instruction.
+    */
+    size_t beginContainer(std::vector<uint8_t>& file, const std::vector<uint8_t>& identifierBytes, const Layout& layout);
+    /**
+        Completes a file started with beginContainer(): appends the tables of the Layout
+        after the instructions (everything from `codeBegin`) and writes the header
+        and the section table.
+    */
+    void finishContainer(std::vector<uint8_t>& file, uint64_t fingerprint, const Layout& layout, size_t codeBegin);
+
+    /**
+        Returns true if the data at `start` is a version 2 file with the COMPRESSED flag
+    */
+    bool isCompressed(const uint8_t* data, size_t size, size_t start);
+    /**
+        Returns the file (a version 2 file whose identifier ends at `start`)
+        with everything after the identifier compressed. Blocks are compressed
+        in parallel. `level` goes from 1 (fastest) to compression::MAX_LEVEL (smallest)
+    */
+    std::vector<uint8_t> compressContainer(const std::vector<uint8_t>& file, size_t start, int level);
+    /**
+        Returns the decompressed version of a COMPRESSED file (the identifier is kept).
+        Blocks are decompressed in parallel.
+        Throws a runtime error if the file is corrupted.
+    */
+    std::vector<uint8_t> decompressContainer(const uint8_t* data, size_t size, size_t start);
+
+    /**
+        Returns the Encoding of a file: its flags, its strings if they're stored in a
+        table, its quantized attributes and its DATA section. Throws a runtime error if
+        the STRINGS or QUANTIZATION sections are corrupted.
+    */
+    Encoding readEncoding(const uint8_t* data, const Container& container);
+    /**
+        Reads `count` strings of a STRINGS section of `size` bytes. The views point
+        into `data`. Throws a runtime error if the section is corrupted.
+    */
+    std::vector<std::string_view> readStrings(const uint8_t* data, uint64_t size, uint32_t count);
+    /**
+        Reads the QUANTIZATION section of a file. Throws a runtime error if it's corrupted
+    */
+    std::vector<QuantizedAttribute> readQuantized(const uint8_t* data, uint64_t size);
+    /**
+        Reads the entry of the table of the class specified in a COLUMNS section and
+        returns true, or false if the class doesn't have a table. The positions of the
+        entry are made relative to the start of the file. Throws a runtime error if
+        the section is corrupted.
+    */
+    bool readTable(const uint8_t* data, const SectionEntry& section, uint32_t classID, TableEntry& table);
+    /**
+        Reads the node table of a file
+    */
+    std::vector<NodeEntry> readNodes(const uint8_t* data, const SectionEntry& section, uint32_t count);
+}
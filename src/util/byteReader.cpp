@@ -0,0 +1,92 @@
+#include "byteReader.hpp"
+
+namespace eclang::format {
+    /**
+        Skips `count` bytes. Skipped chunks are not kept
+    */
+    void StreamReader::skip(uint64_t count) {
+        if (remaining() < count) truncatedInstructions();
+        while (filled - begin < count) {
+            count -= filled - begin;
+            begin = filled;
+            if (!fill(1)) truncatedInstructions();
+        }
+        begin += count;
+    }
+    /**
+        Returns false if there's no terminator before the end
+    */
+    bool StreamReader::cstring(std::string_view& value) {
+        pending.clear();
+        while (!atEnd()) {
+            const size_t available = std::min<uint64_t>(filled - begin, remaining());
+            const uint8_t* start = buffer.data() + begin;
+            const void* terminator = std::memchr(start, 0, available);
+            if (terminator == nullptr) {
+                pending.append(reinterpret_cast<const char*>(start), available);
+                begin += available;
+                continue;
+            }
+            size_t length = static_cast<const uint8_t*>(terminator) - start;
+            begin += length + 1;
+            if (pending.empty()) {
+                value = std::string_view(reinterpret_cast<const char*>(start), length);
+            } else {
+                pending.append(reinterpret_cast<const char*>(start), length);
+                value = pending;
+            }
+            return true;
+        }
+        return false;
+    }
+    /**
+        Appends the next `count` bytes to `output`. The output grows as the
+        data arrives, so a corrupted size doesn't allocate more than the
+        stream has
+    */
+    void StreamReader::read(std::vector<uint8_t>& output, uint64_t count) {
+        if (remaining() < count) truncatedInstructions();
+        while (count > 0) {
+            if (!fill(1)) truncatedInstructions();
+            const size_t length = std::min<uint64_t>(count, filled - begin);
+            output.insert(output.end(), buffer.begin() + begin, buffer.begin() + begin + length);
+            begin += length;
+            count -= length;
+        }
+    }
+    /**
+        Appends everything left in the stream to `output`
+    */
+    void StreamReader::readToEnd(std::vector<uint8_t>& output) {
+        while (!atEnd()) {
+            const size_t length = std::min<uint64_t>(filled - begin, remaining());
+            output.insert(output.end(), buffer.begin() + begin, buffer.begin() + begin + length);
+            begin += length;
+        }
+    }
+
+    /**
+        Makes sure that the next `count` bytes (at most) are in the buffer.
+        Returns false if the stream ends before
+    */
+    bool StreamReader::refill(size_t count) {
+        // Move what's left to the start of the buffer
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, filled - begin);
+            offset += begin;
+            filled -= begin;
+            begin = 0;
+        }
+        if (buffer.size() < std::max(count, STREAM_CHUNK_SIZE)) {
+            buffer.resize(std::max(count, STREAM_CHUNK_SIZE));
+        }
+        while (filled < count && !exhausted) {
+            size_t received = source(buffer.data() + filled, buffer.size() - filled);
+            if (received == 0) {
+                exhausted = true;
+            }
+            filled += std::min(received, buffer.size() - filled);
+        }
+        return filled >= count;
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+    Readers of compiled instructions.
+
+    The decoder of EcLang (see EcLang::decodeInstructions()) works with any of
+    them. They all have the same methods:
+    - position():  Position of the next byte (from the start of the file)
+    - atEnd():     True if there are no more bytes to read
+    - remaining(): Number of bytes left (a huge number if the end is unknown)
+    - peek():      The next byte (the caller checks atEnd() first)
+    - byte():      Reads the next byte
+    - bytes(n):    Returns a pointer to the next `n` bytes and skips them
+    - window(n):   Returns a pointer to the next `n` bytes (less if the data ends
+                   before) without skipping them
+    - skip(n):     Skips `n` bytes
+    - cstring():   Reads the characters up to a 0 and skips the 0
+    Pointers and views returned are only valid until the next call.
+*/
+namespace eclang::format {
+    // Bytes requested from a stream every time a StreamReader runs out of data
+    constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+    // Value of `end` of readers whose data ends wherever the stream ends
+    constexpr uint64_t UNKNOWN_END = UINT64_MAX;
+
+    /**
+        Function that reads up to `size` bytes into `buffer` and returns the
+        number of bytes read. Returns 0 when there's nothing else to read
+    */
+    using ByteSource = std::function<size_t(uint8_t* buffer, size_t size)>;
+
+    [[noreturn]] inline void truncatedInstructions() {
+        throw std::runtime_error("ECLANG_ERROR: Couldn't read compiled file. The instructions are truncated.");
+    }
+
+    /**
+        Reads the instructions between two positions of a buffer. Every read is
+        bounds checked
+    */
+    class BufferReader {
+    public:
+        BufferReader(const uint8_t* data, size_t begin, size_t end) : data(data), current(begin), end(end) {}
+
+        size_t position() const {
+            return current;
+        }
+        bool atEnd() const {
+            return current >= end;
+        }
+        size_t remaining() const {
+            return end - current;
+        }
+        uint8_t peek() const {
+            return data[current];
+        }
+        uint8_t byte() {
+            if (atEnd()) truncatedInstructions();
+            return data[current++];
+        }
+        const uint8_t* bytes(size_t count) {
+            if (end - current < count) truncatedInstructions();
+            const uint8_t* value = data + current;
+            current += count;
+            return value;
+        }
+        const uint8_t* window(size_t count, size_t& available) const {
+            available = std::min(count, end - current);
+            return data + current;
+        }
+        void skip(size_t count) {
+            bytes(count);
+        }
+        // Returns false if there's no terminator before the end
+        bool cstring(std::string_view& value) {
+            const void* terminator = std::memchr(data + current, 0, end - current);
+            if (terminator == nullptr) {
+                return false;
+            }
+            size_t length = static_cast<const uint8_t*>(terminator) - (data + current);
+            value = std::string_view(reinterpret_cast<const char*>(data + current), length);
+            current += length + 1;
+            return true;
+        }
+
+    private:
+        const uint8_t* data;
+        size_t current;
+        size_t end;
+    };
+
+    /**
+        Reads the instructions of a file from a ByteSource, requesting the data in
+        chunks of STREAM_CHUNK_SIZE bytes. Only the chunk being read is kept in memory
+        (and the parts of a value or a string that continue in the next chunk).
+    */
+    class StreamReader {
+    public:
+        StreamReader(ByteSource source) : source(std::move(source)) {}
+
+        /**
+            Sets the position where the data being read ends (UNKNOWN_END if it
+            ends with the stream)
+        */
+        void setEnd(uint64_t position) {
+            end = position;
+        }
+
+        size_t position() const {
+            return offset + begin;
+        }
+        bool atEnd() {
+            return position() >= end || !fill(1);
+        }
+        size_t remaining() const {
+            return end - position();
+        }
+        uint8_t peek() const {
+            return buffer[begin];
+        }
+        uint8_t byte() {
+            if (atEnd()) truncatedInstructions();
+            return buffer[begin++];
+        }
+        const uint8_t* bytes(size_t count) {
+            if (remaining() < count || !fill(count)) truncatedInstructions();
+            const uint8_t* value = buffer.data() + begin;
+            begin += count;
+            return value;
+        }
+        const uint8_t* window(size_t count, size_t& available) {
+            count = std::min<uint64_t>(count, remaining());
+            fill(count);
+            available = std::min(count, filled - begin);
+            return buffer.data() + begin;
+        }
+        /**
+            Skips `count` bytes. Skipped chunks are not kept
+        */
+        void skip(uint64_t count);
+        /**
+            Returns false if there's no terminator before the end
+        */
+        bool cstring(std::string_view& value);
+        /**
+            Appends the next `count` bytes to `output`. The output grows as the
+            data arrives, so a corrupted size doesn't allocate more than the
+            stream has
+        */
+        void read(std::vector<uint8_t>& output, uint64_t count);
+        /**
+            Appends everything left in the stream to `output`
+        */
+        void readToEnd(std::vector<uint8_t>& output);
+
+    private:
+        /**
+            Makes sure that the next `count` bytes (at most) are in the buffer.
+            Returns false if the stream ends before
+        */
+        bool fill(size_t count) {
+            return filled - begin >= count || refill(count);
+        }
+        bool refill(size_t count);
+
+        ByteSource source;
+        // Data received and not read yet: [begin, filled)
+        std::vector<uint8_t> buffer;
+        size_t begin = 0;
+        size_t filled = 0;
+        // Position of `buffer[0]` in the stream
+        uint64_t offset = 0;
+        uint64_t end = UNKNOWN_END;
+        // The source returned 0
+        bool exhausted = false;
+        // Strings that continue in the next chunk
+        std::string pending;
+    };
+}
@@ -0,0 +1,198 @@
+#include "compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace eclang::compression {
+    namespace {
+        constexpr int HASH_BITS = 15;
+        constexpr size_t MAX_OFFSET = 0xFFFF;
+
+        // Hash of the 4 bytes at `p`
+        uint32_t hash4(const uint8_t* p) {
+            uint32_t value;
+            std::memcpy(&value, p, 4);
+            return (value * 2654435761u) >> (32 - HASH_BITS);
+        }
+        // Rest of a length that didn't fit in the token
+        void putLength(std::vector<uint8_t>& output, size_t length) {
+            while (length >= 255) {
+                output.push_back(255);
+                length -= 255;
+            }
+            output.push_back(uint8_t(length));
+        }
+        // Writes the literals and the match (if `matchLength` is not 0)
+        void putSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+            size_t matchCode = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+            output.push_back(uint8_t((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+            if (literalCount >= 15) {
+                putLength(output, literalCount - 15);
+            }
+            output.insert(output.end(), literals, literals + literalCount);
+            if (matchLength == 0) {
+                return;
+            }
+            output.push_back(uint8_t(offset));
+            output.push_back(uint8_t(offset >> 8));
+            if (matchCode >= 15) {
+                putLength(output, matchCode - 15);
+            }
+        }
+        // Reads the rest of a length. Returns false if the block ends before it
+        bool getLength(const uint8_t* data, size_t size, size_t& position, size_t& length) {
+            uint8_t byte;
+            do {
+                if (position >= size) return false;
+                byte = data[position++];
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+    }
+
+    /**
+        Compresses `size` bytes (at most BLOCK_SIZE). Higher levels look further
+        back for matches. The result may be bigger than the input if the data
+        can't be compressed
+    */
+    std::vector<uint8_t> compressBlock(const uint8_t* data, size_t size, int level) {
+        level = std::clamp(level, 1, MAX_LEVEL);
+        // Number of previous positions with the same hash we compare
+        const size_t attempts = size_t(1) << (level - 1);
+
+        std::vector<uint8_t> output;
+        output.reserve(size + size/255 + 16);
+
+        // Last position of every hash and, for every position, the previous one with its hash
+        std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+        std::vector<int32_t> previous(size, -1);
+        auto insert = [&](size_t position) {
+            uint32_t h = hash4(data + position);
+            previous[position] = head[h];
+            head[h] = int32_t(position);
+        };
+
+        size_t anchor = 0; // First literal not written yet
+        size_t i = 0;
+        while (i + MIN_MATCH <= size) {
+            size_t bestLength = 0;
+            size_t bestOffset = 0;
+            int32_t candidate = head[hash4(data + i)];
+            for (size_t a = 0; candidate >= 0 && a < attempts; a++) {
+                size_t offset = i - size_t(candidate);
+                if (offset > MAX_OFFSET) break;
+                size_t length = 0;
+                const size_t maxLength = size - i;
+                while (length < maxLength && data[candidate + length] == data[i + length]) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestOffset = offset;
+                    if (length == maxLength) break;
+                }
+                candidate = previous[candidate];
+            }
+            insert(i);
+
+            if (bestLength < MIN_MATCH) {
+                i++;
+                continue;
+            }
+            putSequence(output, data + anchor, i - anchor, bestOffset, bestLength);
+            // Positions inside the match can be matched later
+            for (size_t j = i + 1; j < i + bestLength && j + MIN_MATCH <= size; j++) {
+                insert(j);
+            }
+            i += bestLength;
+            anchor = i;
+        }
+        putSequence(output, data + anchor, size - anchor, 0, 0);
+        return output;
+    }
+    /**
+        Decompresses a block into `output`, which must have the exact size of the
+        original data. Returns false if the block is corrupted (nothing is read or
+        written out of bounds)
+    */
+    bool decompressBlock(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize) {
+        size_t in = 0;
+        size_t out = 0;
+        while (in < size) {
+            const uint8_t token = data[in++];
+
+            // Literals
+            size_t literalCount = token >> 4;
+            if (literalCount == 15 && !getLength(data, size, in, literalCount)) return false;
+            if (literalCount > size - in || literalCount > outputSize - out) return false;
+            std::memcpy(output + out, data + in, literalCount);
+            in += literalCount;
+            out += literalCount;
+
+            // The last sequence doesn't have a match
+            if (in == size) break;
+
+            // Match
+            if (size - in < 2) return false;
+            const size_t offset = data[in] | (size_t(data[in + 1]) << 8);
+            in += 2;
+            if (offset == 0 || offset > out) return false;
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !getLength(data, size, in, matchLength)) return false;
+            matchLength += MIN_MATCH;
+            if (matchLength > outputSize - out) return false;
+
+            const uint8_t* match = output + out - offset;
+            if (offset >= matchLength) {
+                std::memcpy(output + out, match, matchLength);
+            } else {
+                // The match overlaps the bytes being written (repeated pattern)
+                for (size_t k = 0; k < matchLength; k++) {
+                    output[out + k] = match[k];
+                }
+            }
+            out += matchLength;
+        }
+        return out == outputSize;
+    }
+
+    /**
+        Calls `work(i)` for every i in [0, count), using several threads if
+        there's more than one block. Returns false if any call returned false
+    */
+    bool forEachBlock(size_t count, const std::function<bool(size_t)>& work) {
+        const size_t threadCount = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        if (threadCount <= 1) {
+            for (size_t i = 0; i < count; i++) {
+                if (!work(i)) return false;
+            }
+            return true;
+        }
+
+        std::atomic<size_t> next {0};
+        std::atomic<bool> succeeded {true};
+        auto run = [&]() {
+            size_t i;
+            while (succeeded && (i = next++) < count) {
+                try {
+                    if (!work(i)) succeeded = false;
+                } catch (...) {
+                    succeeded = false;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t t = 1; t < threadCount; t++) {
+            threads.emplace_back(run);
+        }
+        run();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return succeeded;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+    LZ compression of compiled files.
+
+    Data is split in blocks of BLOCK_SIZE bytes (the last one may be shorter)
+    that are compressed and decompressed independently, so they can be
+    processed in parallel.
+
+    A compressed block is a list of sequences. Each sequence is:
+    - A token: the number of literals (high 4 bits) and the length of the match
+      minus MIN_MATCH (low 4 bits). If a length is 15, it continues in the next
+      bytes: every byte is added to it until a byte is not 255.
+    - The literals.
+    - The offset of the match (uint16_t, little endian) and the rest of its length.
+    The last sequence only has literals (it ends with the block).
+*/
+namespace eclang::compression {
+    // Offsets of the matches are 16 bits so blocks can't be bigger
+    constexpr size_t BLOCK_SIZE = 64 * 1024;
+    constexpr size_t MIN_MATCH = 4;
+    // Levels go from 1 (fastest) to MAX_LEVEL (smallest)
+    constexpr int MAX_LEVEL = 9;
+
+    /**
+        Compresses `size` bytes (at most BLOCK_SIZE). Higher levels look further
+        back for matches. The result may be bigger than the input if the data
+        can't be compressed
+    */
+    extern std::vector<uint8_t> compressBlock(const uint8_t* data, size_t size, int level);
+    /**
+        Decompresses a block into `output`, which must have the exact size of the
+        original data. Returns false if the block is corrupted (nothing is read or
+        written out of bounds)
+    */
+    extern bool decompressBlock(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize);
+
+    /**
+        Calls `work(i)` for every i in [0, count), using several threads if
+        there's more than one block. Returns false if any call returned false
+    */
+    extern bool forEachBlock(size_t count, const std::function<bool(size_t)>& work);
+}
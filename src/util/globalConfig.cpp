@@ -2,6 +2,7 @@
 #include "classes/attribute.hpp"
 #include <stdexcept>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace eclang::config {
@@ -91,7 +92,7 @@ namespace eclang::config {
         compilation/decompilation/interpretation
     */
     void registerLanguage(Language lang) {
-        languages.push_back(lang);
+        languages.push_back(std::move(lang));
     }
 
     /**
@@ -99,20 +100,21 @@ namespace eclang::config {
         Whether or not the path is valid is not checked.
     */
     void filepathRegister(std::string alias, std::string path) {
-        aliasToPath[alias] = path;
+        aliasToPath[std::move(alias)] = std::move(path);
     }
     /**
         Is this string an alias?
     */
-    bool filepathIsAlias(std::string alias) {
+    bool filepathIsAlias(const std::string& alias) {
         // Since C++ 20 we could use .contains()
         return aliasToPath.find(alias) != aliasToPath.end();
     }
     /**
         Returns the file path for the given alias
     */
-    std::string filepathGetFor(std::string alias) {
-        if (!filepathIsAlias(alias)) throw std::runtime_error("ECLANG_ERROR: Tried to obtain filepath for invalid alias.");
-        return aliasToPath[alias];
+    std::string filepathGetFor(const std::string& alias) {
+        auto it = aliasToPath.find(alias);
+        if (it == aliasToPath.end()) throw std::runtime_error("ECLANG_ERROR: Tried to obtain filepath for invalid alias.");
+        return it->second;
     }
 }
\ No newline at end of file
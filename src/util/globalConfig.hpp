@@ -1,6 +1,10 @@
 #pragma once
 
 #include "classes/language.hpp"
+// std
+#include <string>
+#include <utility>
+#include <vector>
 namespace eclang::config {
     /**
         Returns all registered languages.
@@ -12,6 +16,15 @@ namespace eclang::config {
         compilation/decompilation/interpretation
     */
     extern void registerLanguage(Language lang);
+    /**
+        Constructs a language in place and registers it.
+        Returns a reference to the registered language, which is
+        valid until another language is registered.
+    */
+    template<class... Args>
+    Language& emplaceLanguage(Args&&... args) {
+        return getLanguages().emplace_back(std::forward<Args>(args)...);
+    }
 
     /**
         Adds an alias to a file path.
@@ -21,9 +34,9 @@ namespace eclang::config {
     /**
         Is this string an alias?
     */
-    extern bool filepathIsAlias(std::string alias);
+    extern bool filepathIsAlias(const std::string& alias);
     /**
         Returns the file path for the given alias
     */
-    extern std::string filepathGetFor(std::string alias);
+    extern std::string filepathGetFor(const std::string& alias);
 }
\ No newline at end of file
@@ -62,8 +62,8 @@ namespace eclang::lexer {
         // check for CLASSes
         // We don't check for ATTRIBUTEs as they're context dependent.
         // The ATTRIBUTE Type is unused
-        std::vector<std::string> classes = language->getClasses();
-        for (std::string className : classes) {
+        const std::vector<std::string>& classes = language->getClasses();
+        for (const std::string& className : classes) {
             if (t.string == className) {
                 // We now know it's a class so we return this
                 t.type = type::CLASS;
@@ -84,8 +84,8 @@ namespace eclang::lexer {
         t.string = source.substr(lexemeStart, charReading - lexemeStart);
 
         // check for KEYWORDs
-        const std::array<std::string, ECLANG_KEYWORD_COUNT> keywords = Language::getKeywords();
-        for (std::string keyword : keywords) {
+        const std::array<std::string, ECLANG_KEYWORD_COUNT>& keywords = Language::getKeywords();
+        for (const std::string& keyword : keywords) {
             if (t.string == keyword) {
                 t.type = type::KEYWORD;
                 return t;
@@ -295,7 +295,7 @@ namespace eclang::lexer {
 
     // FUNCTIONS
     // ---------
-    std::vector<Token> tokenizeSource(std::string sourceCode, Language* lang) {
+    std::vector<Token> tokenizeSource(const std::string& sourceCode, Language* lang) {
         // Create Vector
         std::vector<Token> tokens;
 
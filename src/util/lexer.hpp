@@ -55,5 +55,5 @@ namespace eclang::lexer {
         Reads the source code character by character and returns a list
         of tokens that the parser can understand.
     */
-    extern std::vector<Token> tokenizeSource(std::string sourceCode, Language* lang);
+    extern std::vector<Token> tokenizeSource(const std::string& sourceCode, Language* lang);
 }
\ No newline at end of file
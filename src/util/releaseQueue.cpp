@@ -0,0 +1,93 @@
+#include "releaseQueue.hpp"
+#include "classes/object.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eclang::release {
+    /**
+        A list of object trees waiting to be deleted and the thread that deletes them.
+        The thread is joined (after deleting everything left) when the program exits
+    */
+    class ReleaseQueue {
+    public:
+        ~ReleaseQueue() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeUp.notify_all();
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        void push(std::vector<Object*> objects) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::move(objects));
+            if (!worker.joinable()) {
+                worker = std::thread(&ReleaseQueue::run, this);
+            }
+            wakeUp.notify_one();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return pending.empty() && !deleting; });
+        }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                wakeUp.wait(lock, [this] { return stopping || !pending.empty(); });
+                // Only stop once everything was deleted
+                if (pending.empty()) {
+                    return;
+                }
+                // Take everything that's pending and delete it without holding the lock
+                std::vector<std::vector<Object*>> batch;
+                batch.swap(pending);
+                deleting = true;
+                lock.unlock();
+                for (std::vector<Object*>& objects : batch) {
+                    for (Object* o : objects) {
+                        delete o;
+                    }
+                }
+                lock.lock();
+                deleting = false;
+                done.notify_all();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wakeUp; // Something was pushed or we're stopping
+        std::condition_variable done; // A batch was deleted
+        std::vector<std::vector<Object*>> pending;
+        bool deleting = false;
+        bool stopping = false;
+        std::thread worker;
+    };
+
+    ReleaseQueue queue;
+
+    /**
+        Hands the objects to a background thread that deletes them (and all
+        of their children). Returns immediately.
+    */
+    void deleteInBackground(std::vector<Object*> objects) {
+        if (objects.empty()) {
+            return;
+        }
+        queue.push(std::move(objects));
+    }
+    /**
+        Blocks until every object passed to deleteInBackground() is deleted
+    */
+    void waitForBackgroundDeletes() {
+        queue.wait();
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "classes/object.hpp"
+#include <vector>
+
+namespace eclang::release {
+    /**
+        Hands the objects to a background thread that deletes them (and all
+        of their children). Returns immediately.
+        The thread is created the first time this function is called.
+    */
+    extern void deleteInBackground(std::vector<Object*> objects);
+    /**
+        Blocks until every object passed to deleteInBackground() is deleted
+    */
+    extern void waitForBackgroundDeletes();
+}
@@ -0,0 +1,33 @@
+#include "stringTable.hpp"
+
+namespace eclang {
+    /**
+        Returns the stored copy of the string, adding it if it's not in the table
+    */
+    const std::string* StringTable::intern(std::string_view string) {
+        auto it = index.find(string);
+        if (it != index.end()) {
+            return it->second;
+        }
+        const std::string& stored = strings.emplace_back(string);
+        index.emplace(std::string_view(stored), &stored);
+        return &stored;
+    }
+    /**
+        Returns the stored copy of the string or nullptr if it's not in the table.
+        If the string is not in the table, no object uses it.
+    */
+    const std::string* StringTable::find(std::string_view string) const {
+        auto it = index.find(string);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+    /**
+        Returns the number of different strings stored
+    */
+    size_t StringTable::size() const {
+        return strings.size();
+    }
+}
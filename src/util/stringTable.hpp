@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace eclang {
+    /**
+        Stores a single copy of every class and object name used in a document.
+
+        Objects keep pointers to the strings stored here, so two objects with the
+        same name (or class) point to the same string and can be compared by
+        comparing pointers. The strings never move and are only freed when the
+        table is destroyed.
+    */
+    class StringTable {
+    public:
+        /**
+            Returns the stored copy of the string, adding it if it's not in the table
+        */
+        const std::string* intern(std::string_view string);
+        /**
+            Returns the stored copy of the string or nullptr if it's not in the table.
+            If the string is not in the table, no object uses it.
+        */
+        const std::string* find(std::string_view string) const;
+        /**
+            Returns the number of different strings stored
+        */
+        size_t size() const;
+
+    private:
+        // std::deque doesn't move its elements when it grows
+        std::deque<std::string> strings;
+        // The keys point to the strings in `strings`
+        std::unordered_map<std::string_view, const std::string*> index;
+    };
+}
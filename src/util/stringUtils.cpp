@@ -68,16 +68,16 @@ namespace eclang::string {
         return s;
     }
     // Is the string part of the vector?
-    bool contains(std::vector<std::string>& v,std::string s) {
+    bool contains(std::vector<std::string>& v,std::string_view s) {
         return std::find(v.begin(), v.end(), s) != v.end();
     }
-    bool contains(const std::vector<std::string>& v,std::string s) {
+    bool contains(const std::vector<std::string>& v,std::string_view s) {
         return std::find(v.begin(), v.end(), s) != v.end();
     }
-    uint64_t indexOf(std::vector<std::string>& v,std::string s) {
+    uint64_t indexOf(std::vector<std::string>& v,std::string_view s) {
         return std::distance(v.begin(), std::find(v.begin(), v.end(), s));
     }
-    uint64_t indexOf(const std::vector<std::string>& v,std::string s) {
+    uint64_t indexOf(const std::vector<std::string>& v,std::string_view s) {
         return std::distance(v.begin(), std::find(v.begin(), v.end(), s));
     }
 }
\ No newline at end of file
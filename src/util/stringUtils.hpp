@@ -2,6 +2,7 @@
 
 // STD
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
@@ -24,8 +25,8 @@ namespace eclang::string {
     std::string setIndentationLv(std::string s, uint8_t targetIndentation);
 
     // Is the string part of the vector?
-    bool contains(std::vector<std::string>& v,std::string s);
-    bool contains(const std::vector<std::string>& v,std::string s);
-    uint64_t indexOf(std::vector<std::string>& v,std::string s);
-    uint64_t indexOf(const std::vector<std::string>& v,std::string s);
+    bool contains(std::vector<std::string>& v,std::string_view s);
+    bool contains(const std::vector<std::string>& v,std::string_view s);
+    uint64_t indexOf(std::vector<std::string>& v,std::string_view s);
+    uint64_t indexOf(const std::vector<std::string>& v,std::string_view s);
 }
\ No newline at end of file
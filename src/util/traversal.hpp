@@ -0,0 +1,88 @@
+#pragma once
+
+// eclang
+#include "classes/object.hpp"
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eclang::traversal {
+    namespace action {
+        /**
+            What the traversal should do after calling `onEnter` for an object.
+            STOP_SIBLINGS can be combined with any of the other two (`|`).
+        */
+        enum Action : uint8_t {
+            SKIP_CHILDREN = 0, // Don't visit the children. `onExit` won't be called for this object
+            VISIT_CHILDREN = 1, // Visit the children and call `onExit` once they're done
+            STOP_SIBLINGS = 2 // Don't visit the objects after this one in the same list
+        };
+    }
+
+    /**
+        Information about the object being visited.
+        The same Step is passed to `onEnter` and `onExit` for an object.
+    */
+    struct Step {
+        Object* object;
+        size_t depth; // 0 for the objects in the list passed to walk()
+        size_t index; // Position of the object in `siblings`
+        const std::vector<Object*>* siblings; // List that contains this object
+        // Children that will be visited if `onEnter` returns VISIT_CHILDREN.
+        // Set to the children of the object before calling `onEnter`, which can
+        // point it somewhere else (for example the Template Node of a template)
+        const std::vector<Object*>* children;
+    };
+
+    /**
+        Walks the tree depth first without recursion.
+
+        `onEnter(Step&)` is called for every object before its children (pre-order)
+        and returns an Action. `onExit(Step&)` is called after all the children
+        have been visited (post-order), only if `onEnter` returned VISIT_CHILDREN.
+
+        The only memory used is one Step per level of depth, so deep trees can't
+        overflow the stack and wide trees don't allocate anything per object.
+        Lists being walked must not be modified until the walk leaves them.
+    */
+    template<class Enter, class Exit>
+    void walk(const std::vector<Object*>& roots, Enter onEnter, Exit onExit) {
+        // Each frame is the object whose children are being visited and the
+        // position of the next child. The root list has no object
+        struct Frame {
+            Step step;
+            size_t next;
+            size_t end;
+        };
+        std::vector<Frame> stack;
+        stack.push_back({{nullptr, 0, 0, nullptr, &roots}, 0, roots.size()});
+
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            // All children visited: leave this object
+            if (frame.next >= frame.end) {
+                Step step = frame.step;
+                stack.pop_back();
+                if (step.object != nullptr) {
+                    onExit(step);
+                }
+                continue;
+            }
+
+            const std::vector<Object*>* siblings = frame.step.children;
+            const size_t index = frame.next++;
+            Object* object = siblings->at(index);
+            Step step {object, stack.size()-1, index, siblings, &object->_getChildren()};
+
+            uint8_t result = onEnter(step);
+            if (result & action::STOP_SIBLINGS) {
+                frame.end = frame.next;
+            }
+            if (result & action::VISIT_CHILDREN) {
+                // `frame` may be invalidated by push_back, we don't use it after this
+                stack.push_back({step, 0, step.children->size()});
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#include "eclang.hpp"
+#include "util/globalConfig.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Counts every allocation of the program (the library included)
+static size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Number of times every query is repeated
+constexpr int QUERY_ROUNDS = 100;
+// Copies of the test file in the bigger document loaded (see loadAllocations())
+constexpr int LOAD_COPIES = 4;
+
+/**
+    Runs the queries of the test QUERY_ROUNDS times and returns a checksum of the
+    results, so that they aren't optimized away.
+    With `preChange`, every string passed is a std::string and every name and list
+    returned is copied, like the API did before it took string_views and returned
+    references. The allocations of those queries are the baseline of the test
+*/
+template<bool preChange>
+size_t runQueries(eclang::Language* language, eclang::EcLang& document) {
+    // Arguments and results as the API had them
+    auto argument = [](const char* text) {
+        if constexpr (preChange) {
+            return std::string(text);
+        } else {
+            return std::string_view(text);
+        }
+    };
+    auto result = [](const auto& value) -> decltype(auto) {
+        if constexpr (preChange) {
+            return std::decay_t<decltype(value)>(value);
+        } else {
+            return value;
+        }
+    };
+
+    size_t checksum = 0;
+    for (int round = 0; round < QUERY_ROUNDS; round++) {
+        checksum += language->classExists(argument("VectorTests"));
+        checksum += language->getClassID(argument("NumberTests"));
+        checksum += result(language->getClassName(language->getClassID(argument("StringTests")))).size();
+        checksum += result(language->getAttributes(argument("VectorTests"))).size();
+        checksum += language->getAttributeID(argument("NumberTests"), argument("int32"));
+        checksum += result(language->getAttributeName(argument("NumberTests"), 2)).size();
+        checksum += language->getAttributeType(argument("VectorTests"), argument("vec3f"));
+
+        checksum += document.getObjectsByClass(argument("Container")).size();
+        checksum += document.getObject(argument("scene/characters/player/stats")) != nullptr;
+        eclang::Object* scene = document.getObject(argument("scene"));
+        checksum += result(scene->getName()).size();
+        checksum += result(scene->getObjects()).size();
+        checksum += scene->getObject(argument("lights")) != nullptr;
+        checksum += scene->getObject(argument("characters/enemy/name")) != nullptr;
+    }
+    return checksum;
+}
+/**
+    Returns the allocations made to load a source document with `copies` copies of
+    the objects of the test file, each one inside a Container
+*/
+size_t loadAllocations(const std::string& objects, int copies) {
+    std::string source = "#language test\n";
+    for (int i = 0; i < copies; i++) {
+        source += "Container copy"+std::to_string(i)+" {\n"+objects+"}\n";
+    }
+    const size_t start = allocations;
+    eclang::EcLang document("allocations", source.data(), source.size());
+    return allocations - start;
+}
+
+/**
+    Loads a fixed source file of the `test` language and queries it through the
+    public API, counting the allocations of the load and of the queries.
+    The queries must allocate less than the same queries made the way the API
+    worked before it took string_views and moved the strings it stores, and the
+    allocations of a load must grow linearly with the size of the document.
+    Usage: eclang-allocation-test <path to test/allocations.elt>
+*/
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: eclang-allocation-test <path to test/allocations.elt>\n";
+        return 1;
+    }
+    const std::string path = argv[1];
+    eclang::Language* language = nullptr;
+    for (eclang::Language& l : eclang::config::getLanguages()) {
+        if (l.getName() == "test") {
+            language = &l;
+        }
+    }
+    if (language == nullptr) {
+        std::cerr << "The test language isn't registered\n";
+        return 1;
+    }
+
+    eclang::EcLang document(path);
+    if (document.getObject("scene") == nullptr) {
+        std::cerr << "The object \"scene\" wasn't loaded\n";
+        return 1;
+    }
+
+    size_t start = allocations;
+    size_t checksum = runQueries<true>(language, document);
+    const size_t baselineQueries = allocations - start;
+    start = allocations;
+    checksum += runQueries<false>(language, document);
+    const size_t queries = allocations - start;
+
+    // The objects of the file are everything after the `#language` line
+    std::string objects;
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        objects.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const size_t emptyLoad = loadAllocations(objects, 0);
+    const size_t load = loadAllocations(objects, 1) - emptyLoad;
+    const size_t biggerLoad = loadAllocations(objects, LOAD_COPIES) - emptyLoad;
+
+    std::cout << "Queries: " << queries << " allocations (baseline " << baselineQueries << ")\n";
+    std::cout << "Load: " << load << " allocations, " << biggerLoad << " for " << LOAD_COPIES << " copies\n";
+    std::cout << "Checksum: " << checksum << "\n";
+    bool failed = false;
+    if (queries >= baselineQueries) {
+        std::cerr << "FAILED: the queries allocate as much as before\n";
+        failed = true;
+    }
+    if (biggerLoad > load * LOAD_COPIES) {
+        std::cerr << "FAILED: the allocations of a load grow faster than the document\n";
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
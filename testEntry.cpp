@@ -1,34 +1,652 @@
 #include "eclang.hpp"
+#include "util/globalConfig.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace eclang;
+
+// Name of the files written in the output directory (without extension)
+static const std::string COMPILED_NAME = "roundTrip";
+static const std::string DECOMPILED_NAME = "roundTripDecompiled";
+// Most bytes a ByteSource of the test returns at once, so that values and
+// strings are split between the chunks of the stream reader
+constexpr size_t SOURCE_CHUNK = 7;
+// Byte the export buffers are filled with before exporting, so that the
+// slots of the objects that don't get a value are compared too
+constexpr uint8_t UNTOUCHED = 0xAB;
+
+/**
+    A source file that the round trip compiles and loads again (see roundTrip())
+*/
+struct Document {
+    // Source file in the test directory
+    std::string filename;
+    // Name of its language
+    std::string language;
+    // Classes and attributes loaded by the filtered loads
+    LoadOptions filter;
+    // Nodes loaded with EcLang::loadSubtree()
+    std::vector<std::string> subtrees;
+    // Attributes quantized by half of the combinations of CompileOptions
+    std::unordered_map<std::string, std::unordered_map<std::string, Quantization>> quantize;
+    // Class and attributes exported with EcLang::exportAttributes()
+    std::string exportedClass;
+    std::vector<std::string> exportedAttributes;
+};
+
+/**
+    Prints the first line that is different in the two trees
+*/
+void printDifference(const std::string& expected, const std::string& loaded) {
+    std::istringstream expectedLines(expected);
+    std::istringstream loadedLines(loaded);
+    std::string expectedLine, loadedLine;
+    while (true) {
+        const bool hasExpected = bool(std::getline(expectedLines, expectedLine));
+        const bool hasLoaded = bool(std::getline(loadedLines, loadedLine));
+        if (!hasExpected && !hasLoaded) {
+            return;
+        }
+        if (!hasExpected || !hasLoaded || expectedLine != loadedLine) {
+            std::cerr << "    expected: " << (hasExpected ? expectedLine : "(end)") << "\n";
+            std::cerr << "    loaded:   " << (hasLoaded ? loadedLine : "(end)") << "\n";
+            return;
+        }
+    }
+}
+
+/**
+    Number of checks made and how many of them failed
+*/
+struct Results {
+    size_t checks = 0;
+    size_t failures = 0;
+
+    /**
+        Compares the text returned by `load` with the expected text.
+        Exceptions thrown by `load` are failures too
+    */
+    template<class Load>
+    void compare(const std::string& what, const std::string& expected, Load load) {
+        checks++;
+        std::string loaded;
+        try {
+            loaded = load();
+        } catch (const std::exception& e) {
+            failures++;
+            std::cerr << "FAILED: " << what << ": " << e.what() << "\n";
+            return;
+        }
+        if (loaded != expected) {
+            failures++;
+            std::cerr << "FAILED: " << what << " loaded a different tree\n";
+            printDifference(expected, loaded);
+        }
+    }
+    /**
+        Counts a check that failed if `passed` is false
+    */
+    void expect(bool passed, const std::string& what) {
+        checks++;
+        if (!passed) {
+            failures++;
+            std::cerr << "FAILED: " << what << "\n";
+        }
+    }
+};
+
+/**
+    Returns the `test-defaults` language of test/defaults.eltd. Every attribute
+    of its Shape class but `count` has a default value, `scale` the one passed
+*/
+Language defaultsLanguage(float scale = 1) {
+    return Language("test-defaults", "eltd", "eltdc", {'E', 'C', 'L', 'T', 'D'}, {
+        Class("Group"),
+        Class("Spacer"),
+        Class("Shape", {
+            Attribute("count", type::INT32),
+            Attribute("scale", scale),
+            Attribute("color", vec3f(1, 1, 1)),
+            Attribute("label", std::string("none"), type::STRING),
+            Attribute("weight", 0.5),
+            Attribute("offset", vec2i(0, 0))
+        })
+    });
+}
+/**
+    Returns the registered language with the name specified. It's looked up every
+    time because registering a language can move the ones registered before
+*/
+Language* languageNamed(std::string_view name) {
+    for (Language& language : config::getLanguages()) {
+        if (language.getName() == name) {
+            return &language;
+        }
+    }
+    throw std::runtime_error("The language \""+std::string(name)+"\" isn't registered");
+}
+/**
+    Returns the contents of a file
+*/
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+    Returns bytes as hexadecimal digits
+*/
+std::string hexBytes(const uint8_t* bytes, size_t size) {
+    std::string text;
+    char digits[3];
+    for (size_t i = 0; i < size; i++) {
+        std::snprintf(digits, sizeof(digits), "%02x", bytes[i]);
+        text += digits;
+    }
+    return text;
+}
+/**
+    Returns the bytes of a value as hexadecimal digits, so that
+    values are compared exactly (floats included)
+*/
+template<class T>
+std::string hex(const T& value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    return hexBytes(bytes, sizeof(T));
+}
+/**
+    Returns the value of an attribute of an Object as text
+*/
+std::string valueOf(Object* object, uint8_t id) {
+    switch (object->getTypeOf(id)) {
+    case type::INT8: return hex(object->getInt8Of(id));
+    case type::INT16: return hex(object->getInt16Of(id));
+    case type::INT32: return hex(object->getInt32Of(id));
+    case type::INT64: return hex(object->getInt64Of(id));
+    case type::UINT8: return hex(object->getUint8Of(id));
+    case type::UINT16: return hex(object->getUint16Of(id));
+    case type::UINT32: return hex(object->getUint32Of(id));
+    case type::UINT64: return hex(object->getUint64Of(id));
+    case type::FLOAT: return hex(object->getFloatOf(id));
+    case type::DOUBLE: return hex(object->getDoubleOf(id));
+    case type::VEC2I: return hex(object->getVec2iOf(id));
+    case type::VEC3I: return hex(object->getVec3iOf(id));
+    case type::VEC4I: return hex(object->getVec4iOf(id));
+    case type::VEC2L: return hex(object->getVec2lOf(id));
+    case type::VEC3L: return hex(object->getVec3lOf(id));
+    case type::VEC4L: return hex(object->getVec4lOf(id));
+    case type::VEC2F: return hex(object->getVec2fOf(id));
+    case type::VEC3F: return hex(object->getVec3fOf(id));
+    case type::VEC4F: return hex(object->getVec4fOf(id));
+    case type::VEC2D: return hex(object->getVec2dOf(id));
+    case type::VEC3D: return hex(object->getVec3dOf(id));
+    case type::VEC4D: return hex(object->getVec4dOf(id));
+    default: return "\""+object->getStringOf(id)+"\"";
+    }
+}
+/**
+    Returns a default value of a class as text
+    (the same text as the value of an Object, see valueOf())
+*/
+std::string valueOf(Attribute* attribute) {
+    switch (attribute->getType()) {
+    case type::INT8: return hex(attribute->getInt8());
+    case type::INT16: return hex(attribute->getInt16());
+    case type::INT32: return hex(attribute->getInt32());
+    case type::INT64: return hex(attribute->getInt64());
+    case type::UINT8: return hex(attribute->getUint8());
+    case type::UINT16: return hex(attribute->getUint16());
+    case type::UINT32: return hex(attribute->getUint32());
+    case type::UINT64: return hex(attribute->getUint64());
+    case type::FLOAT: return hex(attribute->getFloat());
+    case type::DOUBLE: return hex(attribute->getDouble());
+    case type::VEC2I: return hex(attribute->getVec2i());
+    case type::VEC3I: return hex(attribute->getVec3i());
+    case type::VEC4I: return hex(attribute->getVec4i());
+    case type::VEC2L: return hex(attribute->getVec2l());
+    case type::VEC3L: return hex(attribute->getVec3l());
+    case type::VEC4L: return hex(attribute->getVec4l());
+    case type::VEC2F: return hex(attribute->getVec2f());
+    case type::VEC3F: return hex(attribute->getVec3f());
+    case type::VEC4F: return hex(attribute->getVec4f());
+    case type::VEC2D: return hex(attribute->getVec2d());
+    case type::VEC3D: return hex(attribute->getVec3d());
+    case type::VEC4D: return hex(attribute->getVec4d());
+    default: return "\""+attribute->getString()+"\"";
+    }
+}
+/**
+    Returns the value of an attribute of a MappedNode as text
+    (the same text as the value of an Object, see valueOf())
+*/
+std::string mappedValueOf(const MappedNode& node, std::string_view attribute) {
+    switch (node.getTypeOf(attribute)) {
+    case type::INT8: return hex(node.getValueOf<int8_t>(attribute));
+    case type::INT16: return hex(node.getValueOf<int16_t>(attribute));
+    case type::INT32: return hex(node.getValueOf<int32_t>(attribute));
+    case type::INT64: return hex(node.getValueOf<int64_t>(attribute));
+    case type::UINT8: return hex(node.getValueOf<uint8_t>(attribute));
+    case type::UINT16: return hex(node.getValueOf<uint16_t>(attribute));
+    case type::UINT32: return hex(node.getValueOf<uint32_t>(attribute));
+    case type::UINT64: return hex(node.getValueOf<uint64_t>(attribute));
+    case type::FLOAT: return hex(node.getValueOf<float>(attribute));
+    case type::DOUBLE: return hex(node.getValueOf<double>(attribute));
+    case type::VEC2I: return hex(node.getValueOf<vec2i>(attribute));
+    case type::VEC3I: return hex(node.getValueOf<vec3i>(attribute));
+    case type::VEC4I: return hex(node.getValueOf<vec4i>(attribute));
+    case type::VEC2L: return hex(node.getValueOf<vec2l>(attribute));
+    case type::VEC3L: return hex(node.getValueOf<vec3l>(attribute));
+    case type::VEC4L: return hex(node.getValueOf<vec4l>(attribute));
+    case type::VEC2F: return hex(node.getValueOf<vec2f>(attribute));
+    case type::VEC3F: return hex(node.getValueOf<vec3f>(attribute));
+    case type::VEC4F: return hex(node.getValueOf<vec4f>(attribute));
+    case type::VEC2D: return hex(node.getValueOf<vec2d>(attribute));
+    case type::VEC3D: return hex(node.getValueOf<vec3d>(attribute));
+    case type::VEC4D: return hex(node.getValueOf<vec4d>(attribute));
+    default: return "\""+std::string(node.getStringOf(attribute))+"\"";
+    }
+}
+
+/**
+    Writes an object, its attributes (sorted by name, since their order depends on how
+    the file was compiled) and its children as text, one line each. Objects and attributes
+    that the LoadOptions don't load are left out, so a tree filtered when it's loaded
+    has the same text as the full tree filtered here.
+
+    The attributes of the class that the object doesn't have (or that are filtered out)
+    are written with their default value, if they have one. The object must read it with
+    the ID UINT8_MAX-1 minus the ID of the attribute in its class (see Object::getIDOf())
+*/
+void dump(Object* object, Language* language, const LoadOptions& options, const std::string& indent, std::string& text) {
+    const std::string& className = object->getClassName();
+    if (!options.classes.empty() && std::find(options.classes.begin(), options.classes.end(), className) == options.classes.end()) {
+        return;
+    }
+    auto allowed = options.attributes.find(className);
+    auto isLoaded = [&](const std::string& attribute) {
+        return allowed == options.attributes.end() || std::find(allowed->second.begin(), allowed->second.end(), attribute) != allowed->second.end();
+    };
+    text += indent+className+" "+object->getName()+"\n";
+    std::vector<std::string> attributes;
+    const std::vector<std::string> set = object->getAttributes();
+    for (const std::string& attribute : set) {
+        if (isLoaded(attribute)) {
+            const uint8_t id = object->getIDOf(attribute);
+            attributes.push_back(attribute+":"+std::to_string(int(object->getTypeOf(id)))+" = "+valueOf(object, id));
+        }
+    }
+    if (language->classExists(className)) {
+        const uint32_t classID = language->getClassID(className);
+        const std::vector<std::string>& classAttributes = language->getAttributes(classID);
+        for (uint32_t classAttributeID = 0; classAttributeID < classAttributes.size(); classAttributeID++) {
+            const std::string& attribute = classAttributes[classAttributeID];
+            Attribute* defaultValue = language->getAttributeDefault(classID, classAttributeID);
+            const bool isSet = std::find(set.begin(), set.end(), attribute) != set.end();
+            if (defaultValue == nullptr || (isSet && isLoaded(attribute))) {
+                continue;
+            }
+            // Filtered out: the object loaded doesn't have it, so it reads the default value
+            if (isSet) {
+                attributes.push_back(attribute+":"+std::to_string(int(defaultValue->getType()))+" = "+valueOf(defaultValue)+" (default)");
+                continue;
+            }
+            const uint8_t id = object->getIDOf(attribute);
+            std::string line = attribute+":"+std::to_string(int(object->getTypeOf(id)))+" = "+valueOf(object, id)+" (default)";
+            if (id != UINT8_MAX - 1 - classAttributeID) {
+                line += " with the ID "+std::to_string(id);
+            }
+            attributes.push_back(line);
+        }
+    }
+    std::sort(attributes.begin(), attributes.end());
+    for (const std::string& attribute : attributes) {
+        text += indent+"    "+attribute+"\n";
+    }
+    for (Object* child : object->getObjects()) {
+        dump(child, language, options, indent+"    ", text);
+    }
+}
+/**
+    Same as dump() but for the nodes of a MappedDocument
+*/
+void dump(const MappedNode& node, Language* language, const std::string& indent, std::string& text) {
+    const std::string_view className = node.getClassName();
+    text += indent+std::string(className)+" "+std::string(node.getName())+"\n";
+    std::vector<std::string> attributes;
+    const std::vector<std::string_view> set = node.getAttributes();
+    for (std::string_view attribute : set) {
+        attributes.push_back(std::string(attribute)+":"+std::to_string(int(node.getTypeOf(attribute)))+" = "+mappedValueOf(node, attribute));
+    }
+    if (language->classExists(className)) {
+        for (const std::string& attribute : language->getAttributes(className)) {
+            if (language->getAttributeDefault(className, attribute) == nullptr || std::find(set.begin(), set.end(), attribute) != set.end()) {
+                continue;
+            }
+            attributes.push_back(attribute+":"+std::to_string(int(node.getTypeOf(attribute)))+" = "+mappedValueOf(node, attribute)+" (default)");
+        }
+    }
+    std::sort(attributes.begin(), attributes.end());
+    for (const std::string& attribute : attributes) {
+        text += indent+"    "+attribute+"\n";
+    }
+    for (const MappedNode& child : node.getObjects()) {
+        dump(child, language, indent+"    ", text);
+    }
+}
+/**
+    Returns all the objects of a file as text (see dump())
+*/
+std::string treeOf(const std::vector<Object*>& objects, Language* language, const LoadOptions& options = {}) {
+    std::string text;
+    for (Object* object : objects) {
+        dump(object, language, options, "", text);
+    }
+    return text;
+}
+std::string treeOf(const MappedDocument& document) {
+    std::string text;
+    for (const MappedNode& node : document.getAllObjects()) {
+        dump(node, document.getLanguage(), "", text);
+    }
+    return text;
+}
+/**
+    Exports the attributes of a document (see Document) from the objects loaded
+    and returns the values and presence bitmaps written as text
+*/
+std::string exportOf(EcLang& loaded, const Document& document) {
+    Language* language = languageNamed(document.language);
+    const size_t count = loaded.countObjectsByClass(document.exportedClass);
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<AttributeExport> exports(document.exportedAttributes.size());
+    for (size_t i = 0; i < exports.size(); i++) {
+        const size_t size = type::sizeOf(language->getAttributeType(document.exportedClass, document.exportedAttributes[i]));
+        buffers.emplace_back(count * size, UNTOUCHED);
+        exports[i].attribute = document.exportedAttributes[i];
+        exports[i].buffer = buffers.back().data();
+    }
+    std::string text = std::to_string(loaded.exportAttributes(document.exportedClass, exports))+" objects\n";
+    for (size_t i = 0; i < exports.size(); i++) {
+        text += exports[i].attribute+": "+hexBytes(buffers[i].data(), buffers[i].size());
+        text += " present "+hexBytes(exports[i].presence.data(), exports[i].presence.size())+"\n";
+    }
+    return text;
+}
+
+/**
+    Returns a description of the compile options (used in the errors)
+*/
+std::string describe(const CompileOptions& options) {
+    std::string text;
+    auto add = [&](bool set, const char* name) {
+        if (set) {
+            text += std::string(text.empty() ? "" : ", ")+name;
+        }
+    };
+    add(options.stringTable, "stringTable");
+    add(options.varint, "varint");
+    add(!options.sizedScopes, "no sizedScopes");
+    add(options.pathIndex, "pathIndex");
+    add(options.alignedValues, "alignedValues");
+    add(options.attributeBitmaps, "attributeBitmaps");
+    add(options.deltaValues, "deltaValues");
+    add(options.columns, "columns");
+    add(options.deduplicate, "deduplicate");
+    add(!options.quantize.empty(), "quantize");
+    add(options.compressionLevel > 0, ("compressionLevel "+std::to_string(options.compressionLevel)).c_str());
+    return text.empty() ? "default" : text;
+}
+
+/**
+    Checks what the round trip of test/defaults.eltd can't see: attributes equal to their
+    default value are left out of objects, compiled files and decompiled files, changing a
+    default value changes the fingerprint of the language (so the files compiled before are
+    rejected) and objects keep the default values they were loaded with, even when the
+    language changes or is moved by registering other languages
+*/
+void checkDefaults(const std::string& sourcePath, const std::string& outputDirectory, Results& results) {
+    EcLang source(sourcePath);
+    Object* same = source.getObject("scene/same");
+    results.expect(same != nullptr && same->getAttributes() == std::vector<std::string>{"count"}, "attributes equal to their default value are kept in objects");
+
+    // The default label ("none") is only set in `same`
+    const std::string compiledPath = outputDirectory+"/defaults.eltdc";
+    source.saveToFileCompiled(outputDirectory+"/defaults");
+    results.expect(readFile(compiledPath).find("none") == std::string::npos, "attributes equal to their default value are compiled");
+    EcLang(compiledPath).saveToFileSource(outputDirectory+"/defaultsDecompiled");
+    results.expect(readFile(outputDirectory+"/defaultsDecompiled.eltd").find("none") == std::string::npos, "attributes equal to their default value are decompiled");
+
+    // Compiled files don't have the values equal to the defaults, so they must be rejected when one changes
+    EcLang before(compiledPath);
+    const Language original = *languageNamed("test-defaults");
+    Language changed = defaultsLanguage(2);
+    results.expect(changed.getFingerprint() != languageNamed("test-defaults")->getFingerprint(), "changing a default value doesn't change the fingerprint");
+    *languageNamed("test-defaults") = changed;
+    bool rejected = false;
+    try {
+        EcLang after(compiledPath);
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    results.expect(rejected, "a file compiled with another default value was loaded");
+
+    // Registers languages until the registered ones are moved (and their classes with them)
+    const Language* registered = config::getLanguages().data();
+    for (uint8_t i = 1; config::getLanguages().data() == registered; i++) {
+        config::registerLanguage(Language("test-filler"+std::to_string(i), "eltf", "eltfc", {'E', 'C', 'L', 'T', 'F', i}));
+    }
+    Object* plain = before.getObject("scene/plain");
+    const uint8_t scale = plain->getIDOf("scale");
+    results.expect(scale != UINT8_MAX && plain->getFloatOf(scale) == 1.0f, "objects don't keep the default values they were loaded with");
+    *languageNamed("test-defaults") = original;
+}
+
+/**
+    Loads a source file, compiles it with every combination of CompileOptions and loads the
+    compiled file again from its path, memory, a stream, a ByteSource, a MappedDocument and
+    EcLang::loadSubtree(), with and without LoadOptions, and from its decompiled source.
+    Every tree loaded must be the same as the source tree, and the attributes exported
+    from the compiled file (see EcLang::exportAttributes()) the same as the ones of the source
+*/
+void roundTrip(const Document& document, const std::string& testDirectory, const std::string& outputDirectory, Results& results) {
+    EcLang source(testDirectory+"/"+document.filename);
+    Language* language = languageNamed(document.language);
+    const std::string compiledPath = outputDirectory+"/"+COMPILED_NAME+"."+language->getExtensionCompiled();
+    const std::string decompiledPath = outputDirectory+"/"+DECOMPILED_NAME+"."+language->getExtensionSource();
+
+    const std::string expected = treeOf(source.getAllObjects(), language);
+    const std::string expectedFiltered = treeOf(source.getAllObjects(), language, document.filter);
+    const std::string expectedExport = exportOf(source, document);
+
+    // 9 options that are on or off, compression and quantization
+    constexpr uint32_t FLAG_COMBINATIONS = 1 << 9;
+    for (uint32_t combination = 0; combination < FLAG_COMBINATIONS * 4; combination++) {
+        const uint32_t flags = combination % FLAG_COMBINATIONS;
+        CompileOptions options;
+        options.stringTable = flags & 1;
+        options.varint = flags & 2;
+        options.sizedScopes = !(flags & 4);
+        options.pathIndex = flags & 8;
+        options.alignedValues = flags & 16;
+        options.attributeBitmaps = flags & 32;
+        options.deltaValues = flags & 64;
+        options.columns = flags & 128;
+        options.deduplicate = flags & 256;
+        options.compressionLevel = (combination / FLAG_COMBINATIONS) % 2 == 0 ? 0 : 6;
+        if (combination / FLAG_COMBINATIONS >= 2) {
+            options.quantize = document.quantize;
+        }
+        const std::string compiledWith = " ("+document.filename+", "+describe(options)+")";
+        source.setCompileOptions(options);
+        source.saveToFileCompiled(outputDirectory+"/"+COMPILED_NAME);
+
+        std::vector<char> data;
+        {
+            std::ifstream file(compiledPath, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        auto byteSource = [&data]() {
+            return [&data, position = size_t(0)](uint8_t* buffer, size_t size) mutable {
+                const size_t count = std::min({size, SOURCE_CHUNK, data.size() - position});
+                std::memcpy(buffer, data.data() + position, count);
+                position += count;
+                return count;
+            };
+        };
+
+        results.compare("path"+compiledWith, expected, [&]() {
+            EcLang loaded(compiledPath);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("memory"+compiledWith, expected, [&]() {
+            EcLang loaded(COMPILED_NAME, data.data(), data.size());
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("istream"+compiledWith, expected, [&]() {
+            std::ifstream file(compiledPath, std::ios::binary);
+            EcLang loaded(COMPILED_NAME, file);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("ByteSource"+compiledWith, expected, [&]() {
+            EcLang loaded(COMPILED_NAME, byteSource());
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("MappedDocument"+compiledWith, expected, [&]() {
+            MappedDocument loaded(compiledPath);
+            return treeOf(loaded);
+        });
+        results.compare("decompiled source"+compiledWith, expected, [&]() {
+            EcLang(compiledPath).saveToFileSource(outputDirectory+"/"+DECOMPILED_NAME);
+            EcLang loaded(decompiledPath);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("exportAttributes"+compiledWith, expectedExport, [&]() {
+            EcLang loaded(compiledPath);
+            return exportOf(loaded, document);
+        });
+        // The Objects are deleted by the background thread once the EcLang is destroyed
+        results.compare("background release"+compiledWith, expected, [&]() {
+            std::string tree;
+            {
+                EcLang loaded(COMPILED_NAME, byteSource());
+                loaded.setBackgroundRelease(true);
+                tree = treeOf(loaded.getAllObjects(), language);
+            }
+            EcLang::waitForBackgroundRelease();
+            return tree;
+        });
+
+        // Filtered loads read the children of CLONE instructions and the prototypes
+        // of INSTANCE instructions again (they're in objects filtered out)
+        results.compare("path with LoadOptions"+compiledWith, expectedFiltered, [&]() {
+            EcLang loaded(compiledPath, document.filter);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("istream with LoadOptions"+compiledWith, expectedFiltered, [&]() {
+            std::ifstream file(compiledPath, std::ios::binary);
+            EcLang loaded(COMPILED_NAME, file, document.filter);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+        results.compare("ByteSource with LoadOptions"+compiledWith, expectedFiltered, [&]() {
+            EcLang loaded(COMPILED_NAME, byteSource(), document.filter);
+            return treeOf(loaded.getAllObjects(), language);
+        });
+
+        // Subtrees need the size of every scope. The nodes that contain them are loaded
+        // without attributes, so only the subtree itself is compared
+        if (!options.sizedScopes) {
+            continue;
+        }
+        for (const std::string& path : document.subtrees) {
+            std::string expectedSubtree;
+            dump(source.getObject(path), language, {}, "", expectedSubtree);
+            results.compare("loadSubtree(\""+path+"\")"+compiledWith, expectedSubtree, [&]() {
+                // EcLang objects are moved with their Objects (and their background release).
+                // Assigning one deletes the Objects it had before
+                EcLang first = EcLang::loadSubtree(compiledPath, path);
+                first.setBackgroundRelease(true);
+                EcLang loaded(std::move(first));
+                if (!first.getAllObjects().empty()) {
+                    return std::string("(the moved EcLang kept its Objects)\n");
+                }
+                loaded = EcLang::loadSubtree(compiledPath, path);
+                Object* node = loaded.getObject(path);
+                if (node == nullptr) {
+                    return std::string("(the node wasn't loaded)\n");
+                }
+                std::string subtree;
+                dump(node, language, {}, "", subtree);
+                return subtree;
+            });
+        }
+        EcLang::waitForBackgroundRelease();
+    }
+}
+
+/**
+    Runs the round trip (see roundTrip()) of test/roundTrip.elt, which has every type of the
+    `test` language, and of test/defaults.eltd, whose language has default values (see
+    checkDefaults()). Usage: eclang-test <test directory> <output directory>
+*/
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: eclang-test <test directory> <output directory>\n";
+        return 1;
+    }
+    const std::string testDirectory = argv[1];
+    const std::string outputDirectory = argv[2];
+    config::registerLanguage(defaultsLanguage());
+
+    // `hidden` (StringTests) is filtered out. Subtrees with plain values, values stored as
+    // differences with previous siblings (DELTA) and children or prototypes outside of them
+    Document types;
+    types.filename = "roundTrip.elt";
+    types.language = "test";
+    types.filter.classes = {"Container", "NumberTests", "VectorTests"};
+    types.filter.attributes["NumberTests"] = {"int16", "int32", "float"};
+    types.subtrees = {"scene/numbers", "scene/grid/cell2", "scene/visible", "scene/instance"};
+    types.quantize["NumberTests"]["float"] = {Quantization::HALF};
+    types.quantize["VectorTests"]["vec3f"] = {Quantization::HALF};
+    types.quantize["VectorTests"]["vec4d"] = {Quantization::HALF};
+    types.exportedClass = "NumberTests";
+    types.exportedAttributes = {"int8", "int16", "int32", "int64", "uint8", "uint16", "uint32", "uint64", "float", "double"};
+
+    // `hidden` (Spacer) is filtered out, and so are the attributes of Shape with a default
+    // value that aren't listed (the objects loaded read their default value instead)
+    Document defaults;
+    defaults.filename = "defaults.eltd";
+    defaults.language = "test-defaults";
+    defaults.filter.classes = {"Group", "Shape"};
+    defaults.filter.attributes["Shape"] = {"count", "scale", "color"};
+    defaults.subtrees = {"scene/plain", "scene/custom", "scene/instance", "scene/row/third"};
+    defaults.quantize["Shape"]["scale"] = {Quantization::HALF};
+    defaults.quantize["Shape"]["color"] = {Quantization::HALF};
+    defaults.exportedClass = "Shape";
+    defaults.exportedAttributes = {"count", "scale", "color", "weight", "offset"};
+
+    Results results;
+    checkDefaults(testDirectory+"/"+defaults.filename, outputDirectory, results);
+    roundTrip(types, testDirectory, outputDirectory, results);
+    roundTrip(defaults, testDirectory, outputDirectory, results);
 
-int main() {
-    std::cout << "Registering files...\n";
-    eclang::EcLang registration("register.elt");
-    std::cout << "Done!\n\n";
-
-    // Read Source File
-    std::cout << "Reading Source File:\n";
-    eclang::EcLang testEcLang1("testFile.elt");
-    std::cout << "Done!\n\n";
-
-    // Compile
-    std::cout << "Compiling Source File:\n";
-    testEcLang1.saveToFileCompiled("compiled");
-    std::cout << "Compiled!!!\n\n";
-
-    // Read Compiled File
-    std::cout << "Reading Compiled File:\n";
-    eclang::EcLang testEcLang2("compiled.eltc");
-    std::cout << "Done!\n\n";
-
-    // Decompile
-    std::cout << "Decompiling Compiled File:\n";
-    testEcLang1.saveToFileSource("decompiled");
-    std::cout << "Decompiled!!!\n\n";
-
-    // // Try to get allTestData/correctData/stringTest1/string
-    // eclang::Object* stringTest1 = testEcLang1.getObject("allTestData/correctData/stringTest1");
-    // if (stringTest1 == nullptr) { return 0; }
-    // uint8_t stringAttribute = stringTest1->getIDOf("string");
-    // std::cout << "Value of allTestData/correctData/stringTest1/string: " << stringTest1->getStringOf(stringAttribute) << "\n";
+    std::cout << results.checks << " checks, " << results.failures << " failed\n";
+    if (results.failures > 0) {
+        std::cerr << "FAILED: some checks failed\n";
+        return 1;
+    }
+    return 0;
 }
\ No newline at end of file